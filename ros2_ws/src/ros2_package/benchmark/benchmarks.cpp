@@ -0,0 +1,594 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Micro-benchmarks (Google Benchmark) of the kernels
+//   that run inside the 500 Hz controller tick, so
+//   performance changes show up before the robot does:
+//   1. compute_ik over a grid of workspace poses (cold
+//      start from home) and along the reference (warm start),
+//      and the conditioning (Jacobian + its singular values)
+//      of one solution
+//   2. get_robot_control for each traj_id
+//   3. linear / cosine interpolation of the noise vector
+//   4. within_limits, the self-collision check of one
+//      configuration (FK of all links + all capsule pairs)
+//      and one command through the safety filter
+//   5. generate_traj_marker for each traj_id
+//   6. the per-tick body of the controller_publisher for
+//      both backends, with mocked I/O (synthetic Falcon input,
+//      ideal joint tracking, messages filled but not sent),
+//      and filling one streamed Gazebo trajectory
+//   7. the nearest-point query of the haptic guidance
+//      (CurveIndex) for each traj_id
+//   8. one Falcon sample through the input predictor, and
+//      the per-tick prediction
+//   9. the CloudPreprocessor kernel on a full NFOV depth
+//      frame, for 1 and 4 threads
+//  10. the per-tick collision check against the occupancy
+//      map (a free target and one stopped at the table)
+//  11. the measured-TCP forward kinematics of one joint
+//      state (fixed-size kernel, and KDL's FK for comparison)
+//
+// - Results are written as JSON (benchmark_results.json by
+//   default) and compared against a baseline file with
+//   scripts/compare_benchmarks.py:
+//     ros2 run ros2_package ros2_package_benchmarks [urdf] [--benchmark_out=<file>]
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/controller_backends.hpp"
+#include "ros2_package/curve_index.hpp"
+#include "ros2_package/input_predictor.hpp"
+#include "ros2_package/markers.hpp"
+#include "ros2_package/occupancy_map.hpp"
+#include "ros2_package/voxel_filter.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tcp_kinematics.hpp"
+
+#include "tutorial_interfaces/msg/pos_info_stamped.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/////////////////// shared fixtures ///////////////////
+
+std::string bench_urdf {urdf_path};
+
+// the Panda chain, loaded once for all benchmarks
+const KDL::Chain & bench_chain()
+{
+  static KDL::Chain chain;
+  static bool loaded = load_panda_chain(bench_urdf, chain);
+  (void) loaded;    // checked through the number of joints (have_chain)
+  return chain;
+}
+
+bool have_chain(benchmark::State& state)
+{
+  if (bench_chain().getNrOfJoints() == n_joints) return true;
+  state.SkipWithError(("could not load the Panda chain from " + bench_urdf).c_str());
+  return false;
+}
+
+// stands in for the robot noise csv: one value per recording tick, same size as generate_noise_vector()
+std::vector<double> synthetic_noise(int max_recording_count)
+{
+  std::vector<double> noise(max_recording_count + 1);
+  for (size_t i=0; i<noise.size(); i++) noise.at(i) = 0.01 * std::sin(i * 0.013) * std::cos(i * 0.0021);
+  return noise;
+}
+
+// raw noise samples as read from a csv (before the interpolation)
+std::vector<double> raw_noise(int n)
+{
+  std::vector<double> raw(n);
+  for (int i=0; i<n; i++) raw.at(i) = 0.01 * std::sin(i * 0.7);
+  return raw;
+}
+
+
+/////////////////// 1. inverse kinematics ///////////////////
+
+// cold start: from home to a 5 x 5 x 3 grid over the trajectory envelope (the first IK of a trial)
+static void BM_ComputeIK_Workspace(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+
+  std::vector< std::vector<double> > poses;
+  for (int i=0; i<5; i++)
+    for (int j=0; j<5; j++)
+      for (int k=0; k<3; k++)
+        poses.push_back({core.origin.at(0) + (k - 1) * traj_depth / 2,
+                         core.origin.at(1) + (i - 2) * traj_width / 4,
+                         core.origin.at(2) + (j - 2) * traj_height / 2});
+
+  std::vector<double> res_vals(n_joints, 0.0);
+  size_t idx = 0;
+  for (auto _ : state) {
+    core.compute_ik(poses.at(idx), home_joint_vals, res_vals);
+    benchmark::DoNotOptimize(res_vals.data());
+    idx = (idx + 1) % poses.size();
+  }
+  state.counters["poses"] = poses.size();
+}
+BENCHMARK(BM_ComputeIK_Workspace);
+
+// warm start: one reference sample per tick, seeded with the previous solution (as in the recording phase)
+static void BM_ComputeIK_Tracking(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+  SineParams sp = get_sine_params(state.range(0));
+
+  const int n_samples = core.max_recording_count;
+  std::vector< std::vector<double> > targets(n_samples, std::vector<double>(3, 0.0));
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  for (int i=0; i<n_samples; i++) {
+    get_reference_offset(2 * M_PI * i / n_samples, sp, 1, ref);
+    for (int j=0; j<3; j++) targets.at(i).at(j) = core.origin.at(j) + ref.at(j);
+  }
+
+  std::vector<double> seed_vals = home_joint_vals;
+  std::vector<double> res_vals(n_joints, 0.0);
+  core.compute_ik(targets.at(0), seed_vals, seed_vals);
+
+  int idx = 0;
+  for (auto _ : state) {
+    core.compute_ik(targets.at(idx), seed_vals, res_vals);
+    seed_vals.swap(res_vals);
+    if (++idx == n_samples) {
+      idx = 0;
+      state.PauseTiming();
+      core.compute_ik(targets.at(0), home_joint_vals, seed_vals);
+      state.ResumeTiming();
+    }
+  }
+  benchmark::DoNotOptimize(seed_vals.data());
+}
+BENCHMARK(BM_ComputeIK_Tracking)->DenseRange(0, 5)->ArgName("traj_id");
+
+// once per tick, on the IK solutions along the reference of traj_id 1
+static void BM_Conditioning(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+  SineParams sp = get_sine_params(1);
+
+  std::vector< std::vector<double> > solutions;
+  std::vector<double> seed_vals = home_joint_vals;
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  std::vector<double> target {0.0, 0.0, 0.0};
+  for (int i=0; i<64; i++) {
+    get_reference_offset(2 * M_PI * i / 64, sp, 1, ref);
+    for (int j=0; j<3; j++) target.at(j) = core.origin.at(j) + ref.at(j);
+    core.compute_ik(target, seed_vals, seed_vals);
+    solutions.push_back(seed_vals);
+  }
+
+  size_t idx = 0;
+  for (auto _ : state) {
+    core.compute_conditioning(solutions.at(idx));
+    benchmark::DoNotOptimize(core.min_singular_value);
+    idx = (idx + 1) % solutions.size();
+  }
+}
+BENCHMARK(BM_Conditioning);
+
+
+/////////////////// 2. reference + noisy robot target ///////////////////
+
+static void BM_GetRobotControl(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+  core.start_trial(0, state.range(0), 1, 3.0);
+  core.robot_noise_vector = synthetic_noise(core.max_recording_count);
+
+  int k = 0;
+  for (auto _ : state) {
+    core.count = core.recording_start + k;
+    core.get_robot_control(2 * M_PI * k / core.max_recording_count);
+    benchmark::DoNotOptimize(core.robot_offset.data());
+    if (++k > core.max_recording_count) k = 0;
+  }
+}
+BENCHMARK(BM_GetRobotControl)->DenseRange(0, 5)->ArgName("traj_id");
+
+
+/////////////////// 3. noise interpolation ///////////////////
+
+// raw csv length -> interpolated to 49 points in between (101 raw samples = one 10 s trajectory)
+static void BM_LinearInterpolateVec(benchmark::State& state)
+{
+  std::vector<double> raw = raw_noise(state.range(0));
+  for (auto _ : state) {
+    std::vector<double> res = linear_interpolate_vec(raw, 49);
+    benchmark::DoNotOptimize(res.data());
+  }
+  state.SetItemsProcessed(state.iterations() * (state.range(0) - 1) * 50);
+}
+BENCHMARK(BM_LinearInterpolateVec)->Arg(101)->Arg(1001)->ArgName("raw_samples");
+
+static void BM_CosineInterpolateVec(benchmark::State& state)
+{
+  std::vector<double> raw = raw_noise(state.range(0));
+  for (auto _ : state) {
+    std::vector<double> res = cosine_interpolate_vec(raw, 49);
+    benchmark::DoNotOptimize(res.data());
+  }
+  state.SetItemsProcessed(state.iterations() * (state.range(0) - 1) * 50);
+}
+BENCHMARK(BM_CosineInterpolateVec)->Arg(101)->Arg(1001)->ArgName("raw_samples");
+
+
+/////////////////// 4. joint limits + self-collision ///////////////////
+
+static void BM_WithinLimits(benchmark::State& state)
+{
+  std::vector<double> q = home_joint_vals;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(q.data());
+    benchmark::DoNotOptimize(within_limits(q));
+    benchmark::ClobberMemory();    // q may have changed, so the check is not hoisted out of the loop
+  }
+}
+BENCHMARK(BM_WithinLimits);
+
+// home with every joint swept over a quarter of its range
+static void BM_SelfDistance(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+
+  std::vector< std::vector<double> > configs;
+  for (int k=0; k<64; k++) {
+    std::vector<double> q = home_joint_vals;
+    for (unsigned int i=0; i<n_joints; i++) {
+      double range = upper_joint_limits.at(i) - lower_joint_limits.at(i);
+      q.at(i) = std::clamp(q.at(i) + 0.125 * range * std::sin(0.7 * k + i), lower_joint_limits.at(i), upper_joint_limits.at(i));
+    }
+    configs.push_back(q);
+  }
+
+  size_t idx = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(core.self_distance(configs.at(idx)));
+    idx = (idx + 1) % configs.size();
+  }
+}
+BENCHMARK(BM_SelfDistance);
+
+// a feasible 0.5 Hz sine on all joints, so every tick runs the whole filter without clamping
+static void BM_SafetyFilter(benchmark::State& state)
+{
+  JointSafetyFilter filter(lower_joint_limits, upper_joint_limits, 0.002);
+  std::vector< std::vector<double> > commands(1000, home_joint_vals);
+  for (size_t k=0; k<commands.size(); k++) {
+    for (unsigned int i=0; i<n_joints; i++) commands.at(k).at(i) += 0.2 * std::sin(2 * M_PI * 0.5 * k * 0.002 + i);
+  }
+
+  std::vector<double> q = home_joint_vals;
+  size_t idx = 0;
+  for (auto _ : state) {
+    q = commands.at(idx);
+    benchmark::DoNotOptimize(filter.apply(q));
+    idx = (idx + 1) % commands.size();
+  }
+}
+BENCHMARK(BM_SafetyFilter);
+
+
+/////////////////// 5. trajectory marker ///////////////////
+
+static void BM_GenerateTrajMarker(benchmark::State& state)
+{
+  SineParams sp = get_sine_params(state.range(0));
+  std::vector<double> origin {0.5059, 0.0, 0.4346};
+  const int max_points = 200;   // as in the MarkerPublisher
+
+  for (auto _ : state) {
+    visualization_msgs::msg::Marker traj_marker;
+    generate_traj_marker(traj_marker, origin, max_points, sp.a, sp.b, sp.c, sp.s, sp.h, traj_height, traj_width, traj_depth, 1);
+    benchmark::DoNotOptimize(traj_marker.points.data());
+  }
+}
+BENCHMARK(BM_GenerateTrajMarker)->DenseRange(0, 5)->ArgName("traj_id");
+
+
+/////////////////// 6. one controller tick, mocked I/O ///////////////////
+
+// what the controller_publisher does around core->tick(), minus the actual publishing
+template<class Backend>
+static void BM_ControllerTick(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+  core.origin = Backend::origin;
+  core.robot_noise_vector = synthetic_noise(core.max_recording_count);
+
+  const rclcpp::Time input_stamp(1, 0);
+  typename Backend::CommandMsg command_msg;
+  tutorial_interfaces::msg::PosInfoStamped tcp_msg;
+
+  auto start_trial = [&]() {
+    core.start_trial(state.range(0), 0, 1, 3.0);
+    core.curr_joint_vals = home_joint_vals;
+    core.skip_prep();
+  };
+  start_trial();
+
+  long tick_count = 0;
+  long n_trials = 1;
+  double ik_time_sum = 0.0;
+  for (auto _ : state) {
+
+    ///////// mocked inputs: a slow circle on the Falcon, joints track the last command /////////
+    double phase = tick_count * 0.002;
+    core.set_falcon_position(0.0, 5.0 * std::sin(phase), 3.0 * std::cos(phase));
+    core.set_joint_state(core.message_joint_vals);
+
+    TickOutput out = core.tick();
+    ik_time_sum += core.ik_time_us;
+
+    ///////// mocked outputs: fill the messages the node would publish /////////
+    if (out.publish_command && tick_count % Backend::command_decimation == 0) {
+      Backend::write_command(core.message_joint_vals, input_stamp, command_msg);
+      benchmark::DoNotOptimize(command_msg);
+    }
+    if (out.publish_tcp) {
+      const std::vector<double> & origin = core.origin;
+      tcp_msg.ref_position = {origin.at(0) + core.ref_offset.at(0), origin.at(1) + core.ref_offset.at(1), origin.at(2) + core.ref_offset.at(2)};
+      tcp_msg.human_position = {origin.at(0) + core.human_offset.at(0), origin.at(1) + core.human_offset.at(1), origin.at(2) + core.human_offset.at(2)};
+      tcp_msg.robot_position = {origin.at(0) + core.robot_offset.at(0), origin.at(1) + core.robot_offset.at(1), origin.at(2) + core.robot_offset.at(2)};
+      tcp_msg.tcp_position = core.tcp_pos;
+      tcp_msg.input_stamp = input_stamp;
+      tcp_msg.time_from_start = out.time_from_start;
+      benchmark::DoNotOptimize(tcp_msg);
+    }
+    tick_count++;
+
+    if (out.finished || out.limits_violated) {
+      state.PauseTiming();
+      start_trial();
+      n_trials++;
+      state.ResumeTiming();
+    }
+  }
+
+  state.counters["trials"] = n_trials;
+  state.counters["ik_mean_us"] = (tick_count > 0) ? ik_time_sum / tick_count : 0.0;
+}
+BENCHMARK_TEMPLATE(BM_ControllerTick, RealBackend)->Arg(0)->Arg(3)->ArgName("alpha_id");
+BENCHMARK_TEMPLATE(BM_ControllerTick, GazeboBackend)->Arg(0)->Arg(3)->ArgName("alpha_id");
+
+// one multi-point trajectory out of a full command history (every command_decimation ticks in streaming mode)
+static void BM_GazeboWriteStream(benchmark::State& state)
+{
+  CommandHistory history(GazeboBackend::stream_points);
+  std::vector<double> q = home_joint_vals;
+  for (int k=0; k<GazeboBackend::stream_points; k++) {
+    q.at(0) += 1e-4;
+    history.push(q, k);
+  }
+
+  const rclcpp::Time now(100, 0);
+  GazeboBackend::CommandMsg command_msg;
+  for (auto _ : state) {
+    GazeboBackend::write_stream(history, now, command_msg);
+    benchmark::DoNotOptimize(command_msg);
+  }
+  state.counters["points"] = history.size();
+}
+BENCHMARK(BM_GazeboWriteStream);
+
+
+/////////////////// 7. haptic guidance lookup ///////////////////
+
+// random handle positions within 2 cm of the curve box, as seen by the PositionTalker (mapping_ratio 3, with depth)
+static void BM_CurveIndexNearest(benchmark::State& state)
+{
+  CurveIndex index(sample_reference_curve(state.range(0), 1, 3.0), 0.0025, 0.03);
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> uniform(-0.04, 0.04);
+  std::vector<double> queries(3 * 4096);
+  for (double& x : queries) x = uniform(gen);
+
+  double closest[3];
+  double tangent[3];
+  size_t k = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.nearest(&queries[3*k], closest, tangent));
+    k = (k + 1) % 4096;
+  }
+  state.counters["candidates_per_cell"] = index.mean_candidates();
+}
+BENCHMARK(BM_CurveIndexNearest)->DenseRange(0, 5)->ArgName("traj_id");
+
+
+
+/////////////////// 8. input prediction ///////////////////
+
+// 500 Hz samples of a 0.4 Hz hand motion
+static void BM_InputPredictorUpdate(benchmark::State& state)
+{
+  InputPredictor predictor;
+  std::vector<double> z {0.0, 0.0, 0.0};
+  int64_t stamp_ns = 0;
+  for (auto _ : state) {
+    stamp_ns += 2000000;
+    double s = 0.08 * sin(2 * M_PI * 0.4 * stamp_ns * 1e-9);
+    z.at(0) = z.at(1) = z.at(2) = s;
+    predictor.update(stamp_ns, z);
+  }
+}
+BENCHMARK(BM_InputPredictorUpdate);
+
+static void BM_InputPredictorPredict(benchmark::State& state)
+{
+  InputPredictor predictor;
+  std::vector<double> z {0.01, 0.02, 0.03};
+  std::vector<double> out {0.0, 0.0, 0.0};
+  for (int k=1; k<=10; k++) predictor.update(k * 2000000, z);
+  int64_t t_ns = 20000000;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(predictor.predict(t_ns + 15000000, out));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_InputPredictorPredict);
+
+
+/////////////////// 9. point-cloud preprocessing ///////////////////
+
+// 640 x 576 points (K4A NFOV unbinned) in 32-byte points, a tenth of them invalid, about another tenth inside the box
+static void BM_VoxelFilter(benchmark::State& state)
+{
+  const std::size_t n_points = 640 * 576;
+  const std::size_t point_step = 32;
+  std::vector<uint8_t> cloud(n_points * point_step);
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  for (std::size_t i=0; i<n_points; i++) {
+    float xyz[3] = {uniform(gen), uniform(gen), 1.5f + uniform(gen)};
+    if (i % 10 == 0) xyz[0] = xyz[1] = xyz[2] = NAN;
+    std::memcpy(&cloud[i * point_step], xyz, sizeof(xyz));
+  }
+
+  // camera looking down the robot's x axis from 1.5 m in front of the box
+  const double lower[3] = {0.06, -0.55, -0.02};
+  const double upper[3] = {0.96, 0.55, 0.88};
+  const double rotation[9] = {0, 0, -1, 1, 0, 0, 0, -1, 0};
+  const double translation[3] = {2.0, 0.0, 0.45};
+  VoxelFilter filter(lower, upper, 0.01, state.range(0));
+  filter.set_transform(rotation, translation);
+
+  std::vector<float> out;
+  std::size_t n_out = 0;
+  for (auto _ : state) {
+    n_out = filter.filter(cloud.data(), n_points, point_step, 0, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.counters["points_in_box"] = filter.n_cropped();
+  state.counters["voxels"] = n_out;
+  state.SetItemsProcessed(state.iterations() * n_points);
+}
+BENCHMARK(BM_VoxelFilter)->Arg(1)->Arg(4)->ArgName("threads")->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+/////////////////// 10. collision check ///////////////////
+
+// table top 5 mm above the bottom of the map, seen from the camera, one point per cm
+static void BM_OccupancyClamp(benchmark::State& state)
+{
+  const double lower[3] = {0.0559, -0.55, -0.0154};
+  const double upper[3] = {0.9559, 0.55, 0.8846};
+  OccupancyMap map(lower, upper, 0.02, 0.03);
+  std::vector<float> table;
+  for (int i=0; i<90; i++) {
+    for (int j=0; j<110; j++) {
+      table.push_back(lower[0] + 0.01 * i);
+      table.push_back(lower[1] + 0.01 * j);
+      table.push_back(-0.01);
+    }
+  }
+  const double sensor[3] = {1.5, 0.0, 1.2};
+  for (int k=0; k<2; k++) {
+    long n = map.n_snapshots() + map.n_skipped();
+    map.submit(table, sensor, {});
+    while (map.n_snapshots() + map.n_skipped() == n) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // 1 cm per tick towards the target
+  const std::vector<double> from {0.5, 0.1, 0.1};
+  const double target_z = state.range(0) ? 0.09 : 0.0;
+  std::vector<double> target {0.5, 0.1, target_z};
+  for (auto _ : state) {
+    target.at(2) = target_z;
+    benchmark::DoNotOptimize(map.clamp(from, target));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_OccupancyClamp)->Arg(1)->Arg(0)->ArgName("free");
+
+
+/////////////////// 11. measured TCP ///////////////////
+
+// home with a small motion on every joint, with the joint velocities (as in franka/joint_states)
+static void BM_TcpKinematics(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  TcpKinematics kinematics(bench_chain());
+
+  double q[n_joints], qdot[n_joints];
+  for (unsigned int i=0; i<n_joints; i++) qdot[i] = 0.1;
+  long k = 0;
+  for (auto _ : state) {
+    for (unsigned int i=0; i<n_joints; i++) q[i] = home_joint_vals.at(i) + 1e-4 * (k % 1000);
+    kinematics.compute(q, qdot);
+    benchmark::DoNotOptimize(kinematics.position);
+    k++;
+  }
+}
+BENCHMARK(BM_TcpKinematics);
+
+// the same position through KDL (what compute_fk does)
+static void BM_KdlTcpFk(benchmark::State& state)
+{
+  if (!have_chain(state)) return;
+  SharedControlCore core(bench_chain());
+
+  std::vector<double> q = home_joint_vals;
+  std::vector<double> position {0.0, 0.0, 0.0};
+  long k = 0;
+  for (auto _ : state) {
+    for (unsigned int i=0; i<n_joints; i++) q.at(i) = home_joint_vals.at(i) + 1e-4 * (k % 1000);
+    core.compute_fk(q, position);
+    benchmark::DoNotOptimize(position.data());
+    k++;
+  }
+}
+BENCHMARK(BM_KdlTcpFk);
+
+
+/////////////////////////// THE MAIN FUNCTION ///////////////////////////
+int main(int argc, char * argv[])
+{
+  // write JSON results unless told otherwise, so every run can be compared against the baseline
+  std::vector<char*> args(argv, argv + argc);
+  bool has_out = false;
+  for (int i=1; i<argc; i++) {
+    if (std::string(argv[i]).rfind("--benchmark_out=", 0) == 0) has_out = true;
+  }
+  std::string default_out = "--benchmark_out=benchmark_results.json";
+  std::string default_format = "--benchmark_out_format=json";
+  if (!has_out) {
+    args.push_back(default_out.data());
+    args.push_back(default_format.data());
+  }
+
+  int n_args = args.size();
+  benchmark::Initialize(&n_args, args.data());
+
+  // whatever is left over is the URDF
+  if (n_args > 1) bench_urdf = args.at(1);
+  std::cout << "Panda chain from " << bench_urdf << std::endl;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
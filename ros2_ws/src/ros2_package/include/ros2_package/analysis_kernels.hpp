@@ -0,0 +1,56 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Batch kernels for the recording and the analysis side
+//   (traj_utils.py, DataLogger, the notebooks), exposed to
+//   Python by the ros2_package._native module
+//
+// - Main functionalities:
+//   1. Reference trajectory: n points of a traj_id's sine
+//      curve from get_reference_offset(), i.e. the same
+//      code as the controller
+//   2. Tracking error of a recorded path against the
+//      reference: per-dimension and Euclidean error of every
+//      point, with their totals and averages (as written by
+//      DataLogger.calc_error())
+//   3. Forward kinematics of a whole joint trajectory with
+//      TcpKinematics (the measured-pose code)
+//
+// - Plain row-major double arrays in and out (n x 3, n x 7,
+//   ...), so the bindings hand over the NumPy buffers as they
+//   are, and nothing is allocated per point
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__ANALYSIS_KERNELS_HPP_
+#define ROS2_PACKAGE__ANALYSIS_KERNELS_HPP_
+
+#include <cstddef>
+
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tcp_kinematics.hpp"
+
+
+// n_points of the reference over t = [0, 2pi] (end point included, like numpy's linspace), around origin, into out (n_points x 3)
+void reference_trajectory(const SineParams& sp, int use_depth, const double origin[3], std::size_t n_points, double* out);
+
+struct ErrorTotals
+{
+  double dim_total[3] = {0.0, 0.0, 0.0};
+  double total = 0.0;
+  double dim_ave[3] = {0.0, 0.0, 0.0};
+  double ave = 0.0;
+};
+
+// |pos - ref| per dimension into dim_err (n_points x 3) and its norm into err (n_points), either may be nullptr.
+// The norm leaves out x (the depth) unless use_depth
+ErrorTotals tracking_error(const double* pos, const double* ref, std::size_t n_points, int use_depth,
+                           double* dim_err, double* err);
+
+// tcp position (n_points x 3) and orientation (n_points x 4, quaternion x, y, z, w) of every row of q (n_points x n_joints)
+void trajectory_fk(TcpKinematics& kinematics, const double* q, std::size_t n_points,
+                   double* position, double* orientation);
+
+#endif  // ROS2_PACKAGE__ANALYSIS_KERNELS_HPP_
@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Process-wide asynchronous logger for the control paths
+//
+// - The control loops only format a message into a fixed-size
+//   slot of a lock-free ring (no allocation, no locking, no
+//   I/O). A background thread drains the ring and forwards
+//   the messages to the sink (RCLCPP_* logging, see
+//   ros_log_sink.hpp) and / or a log file
+//
+// - If the ring is full, messages are dropped (and counted)
+//   instead of ever blocking a control tick
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__ASYNC_LOGGER_HPP_
+#define ROS2_PACKAGE__ASYNC_LOGGER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+enum class LogLevel {DEBUG, INFO, WARN, ERROR};
+
+const char* log_level_name(LogLevel level);
+
+
+/////////////// DEFINITION OF THE LOGGER CLASS //////////////
+
+class AsyncLogger
+{
+public:
+
+  static const size_t ring_size = 1024;   // must be a power of 2
+  static const size_t max_message_length = 192;
+
+  using Sink = std::function<void(LogLevel, const char*)>;
+
+  // one logger per process, shared by all nodes
+  static AsyncLogger& instance();
+
+  // hot path: printf-style formatting straight into the ring, never blocks
+  void log(LogLevel level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+  // rate limiting: true at most once per period for each last_stamp (one per call site, see the macros below)
+  bool throttle(std::atomic<int64_t>& last_stamp, int64_t period_ms);
+
+  // where the messages end up (default: stdout), set before the control loops start
+  void set_sink(Sink sink);
+
+  // additionally write every message to a file (empty path = no file)
+  bool set_file(const std::string& path);
+
+  // write out everything that is still in the ring and stop the background thread
+  void flush_and_stop();
+
+  uint64_t dropped() const {return dropped_.load(std::memory_order_relaxed);}
+
+  AsyncLogger(const AsyncLogger &) = delete;
+  AsyncLogger & operator=(const AsyncLogger &) = delete;
+
+private:
+
+  AsyncLogger();
+  ~AsyncLogger();
+
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    int64_t stamp_ns;
+    LogLevel level;
+    char message[max_message_length];
+  };
+
+  void drain_loop();
+  bool pop_and_write();
+
+  std::array<Slot, ring_size> ring_;
+  std::atomic<size_t> head_ {0};   // next slot to write (producers)
+  size_t tail_ = 0;                // next slot to read (background thread only)
+
+  std::atomic<uint64_t> dropped_ {0};
+  std::atomic<bool> running_ {true};
+
+  std::mutex sink_mutex_;   // only taken by the background thread and the setters
+  Sink sink_;
+  FILE* file_ = nullptr;
+
+  std::thread thread_;
+};
+
+
+/////////////////// logging macros ///////////////////
+#define ASYNC_LOG_DEBUG(...) AsyncLogger::instance().log(LogLevel::DEBUG, __VA_ARGS__)
+#define ASYNC_LOG_INFO(...) AsyncLogger::instance().log(LogLevel::INFO, __VA_ARGS__)
+#define ASYNC_LOG_WARN(...) AsyncLogger::instance().log(LogLevel::WARN, __VA_ARGS__)
+#define ASYNC_LOG_ERROR(...) AsyncLogger::instance().log(LogLevel::ERROR, __VA_ARGS__)
+
+// at most once per period_ms from this call site
+#define ASYNC_LOG_INFO_THROTTLE(period_ms, ...) \
+  do { \
+    static std::atomic<int64_t> async_log_last_stamp_ {0}; \
+    if (AsyncLogger::instance().throttle(async_log_last_stamp_, period_ms)) ASYNC_LOG_INFO(__VA_ARGS__); \
+  } while (0)
+
+#endif  // ROS2_PACKAGE__ASYNC_LOGGER_HPP_
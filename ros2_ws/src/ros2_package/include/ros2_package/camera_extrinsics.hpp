@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Extrinsics of the Kinect in the robot frame, in one
+//   place for the ConstBr (which broadcasts them on /tf)
+//   and the nodes that transform the point cloud themselves
+//
+// - panda_link0 -> camera_base: measured mounting of the camera
+//   camera_base -> depth_camera_link: fixed by the K4A itself
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__CAMERA_EXTRINSICS_HPP_
+#define ROS2_PACKAGE__CAMERA_EXTRINSICS_HPP_
+
+#include <cmath>
+#include <string>
+
+#include "tf2/LinearMath/Quaternion.h"
+#include "tf2/LinearMath/Transform.h"
+#include "tf2/LinearMath/Vector3.h"
+
+
+#define DEPTH_CAMERA_OFFSET_MM_X 0.0f
+#define DEPTH_CAMERA_OFFSET_MM_Y 0.0f
+#define DEPTH_CAMERA_OFFSET_MM_Z 1.8f  // The depth camera is shifted 1.8mm up in the depth window
+
+
+const std::string panda_base_frame = "panda_link0";
+const std::string camera_base_frame = "camera_base";
+const std::string depth_camera_frame = "depth_camera_link";
+
+
+// note: TF does translation before rotation
+inline tf2::Transform camera_base_in_panda()
+{
+  const double dx = 1.22;
+  const double dy = 0.6;
+  const double dz = 1.15;
+  const double rx = 183.0 / 180 * M_PI;
+  const double ry = 30.0 / 180 * M_PI;
+  const double rz = 212.0 / 180 * M_PI;
+
+  tf2::Quaternion q;
+  q.setRPY(rx, ry, rz);
+  return tf2::Transform(q, tf2::Vector3(dx, dy, dz));
+}
+
+inline tf2::Transform depth_camera_in_camera_base()
+{
+  tf2::Quaternion ros_camera_rotation;  // ROS camera co-ordinate system requires rotating the entire camera relative to
+                                        // camera_base
+  tf2::Quaternion depth_rotation;       // K4A has one physical camera that is about 6 degrees downward facing.
+
+  depth_rotation.setEuler(0, -6.0 / 180 * M_PI, 0);
+  ros_camera_rotation.setEuler(M_PI / -2.0f, M_PI, (M_PI / 2.0f));
+
+  return tf2::Transform(ros_camera_rotation * depth_rotation,
+                        tf2::Vector3(DEPTH_CAMERA_OFFSET_MM_X / 1000.0f, DEPTH_CAMERA_OFFSET_MM_Y / 1000.0f,
+                                     DEPTH_CAMERA_OFFSET_MM_Z / 1000.0f));
+}
+
+// what /tf resolves depth_camera_link -> panda_link0 to
+inline tf2::Transform depth_camera_in_panda()
+{
+  return camera_base_in_panda() * depth_camera_in_camera_base();
+}
+
+#endif  // ROS2_PACKAGE__CAMERA_EXTRINSICS_HPP_
@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Binary cache of the Panda kinematic chain, so the
+//   controllers do not have to parse the URDF on every launch
+//
+// - The blob stores each segment's joint (name, type,
+//   origin, axis) and tip frame, together with the size and
+//   modification time of the URDF it was made from. It is
+//   rebuilt automatically whenever the URDF changes
+//
+// - Inertias are not stored, the controllers only do kinematics
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__CHAIN_CACHE_HPP_
+#define ROS2_PACKAGE__CHAIN_CACHE_HPP_
+
+#include <string>
+
+#include <kdl/chain.hpp>
+
+
+// default location of the cached chain, next to the URDF
+std::string default_chain_cache_path(const std::string& urdf);
+
+// write the chain made from urdf to the cache file
+bool save_chain_cache(const KDL::Chain& chain, const std::string& urdf, const std::string& cache_path);
+
+// read the chain back, false if the file is missing, corrupt or older than urdf
+bool load_chain_cache(const std::string& urdf, const std::string& cache_path, KDL::Chain& chain);
+
+// the Panda chain from the cache if it is up to date, otherwise parsed from urdf (and cached for the next launch)
+bool load_panda_chain(const std::string& urdf, KDL::Chain& chain, bool* from_cache = nullptr);
+
+#endif  // ROS2_PACKAGE__CHAIN_CACHE_HPP_
@@ -0,0 +1,57 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - The controllers' collision map (controller_node.hpp,
+//   "collision_map" parameter): an OccupancyMap around the
+//   task-space origin, filled from the workspace cloud
+//
+// - Each cloud goes to the map together with spheres around
+//   the arm at its current joint values, so the robot does
+//   not map itself: one at every link origin and one halfway
+//   to the next, a bigger one around the hand and fingers
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__COLLISION_MAP_HPP_
+#define ROS2_PACKAGE__COLLISION_MAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ros2_package/occupancy_map.hpp"
+#include "ros2_package/shared_control.hpp"
+
+
+class CollisionMap
+{
+public:
+
+  // box of half_size around the origin, voxel_size and clearance in [m]
+  CollisionMap(const std::vector<double>& origin, const std::vector<double>& half_size, double voxel_size, double clearance);
+
+  // n_points packed float32 {x, y, z} in the robot frame, seen from sensor
+  // (never called from the control tick, the core's kinematics are only used for the self spheres)
+  void submit(const uint8_t* data, std::size_t n_points, SharedControlCore & core, const double sensor[3]);
+
+  // for the core's tick
+  const OccupancyMap* occupancy() const {return occupancy_.get();}
+
+  // integration statistics at the end of a trial
+  void report(int n_clamped) const;
+
+  const double link_sphere_radius = 0.1;    // [m], around the Panda links
+  const double tcp_sphere_radius = 0.12;    // [m], around the hand and fingers
+
+private:
+
+  std::unique_ptr<OccupancyMap> occupancy_;
+  std::vector<float> cloud_points;
+  std::vector<double> link_positions;
+  std::vector<double> self_spheres;
+};
+
+#endif  // ROS2_PACKAGE__COLLISION_MAP_HPP_
@@ -0,0 +1,169 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Backend policies of the ControllerNode template
+//   (controller_node.hpp), everything that differs between
+//   the real robot and the Gazebo simulation:
+//
+//   1. node name and topic names
+//   2. joint ordering of the incoming joint states
+//   3. command message type and how it is filled in
+//      (stamp = device-read time of the Falcon input it was computed from)
+//   4. command rate (as a decimation of the 500 Hz tick)
+//   5. task-space origin
+//   6. default URDF, whether a Falcon has to be there (default of the
+//      "require_falcon" parameter)
+//   7. streaming (Gazebo only, "stream_commands" parameter): every
+//      command message carries the last 500 Hz solutions as one
+//      multi-point trajectory on the ROS clock, instead of a single
+//      point, so the simulation runs at the same control resolution
+//      as the real robot without more messages
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__CONTROLLER_BACKENDS_HPP_
+#define ROS2_PACKAGE__CONTROLLER_BACKENDS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/joint_state.hpp"
+#include "trajectory_msgs/msg/joint_trajectory.hpp"
+#include "trajectory_msgs/msg/joint_trajectory_point.hpp"
+
+#include "ros2_package/shared_control.hpp"
+
+
+/////////////// RECENT COMMANDS (for streaming) //////////////
+// fixed-size ring of the joint commands of the last ticks, only consecutive ticks are kept
+class CommandHistory
+{
+public:
+
+  explicit CommandHistory(int capacity)
+  : points(capacity, std::vector<double>(n_joints, 0.0))
+  {
+  }
+
+  void push(const std::vector<double>& q, long tick)
+  {
+    if (tick != last_tick + 1) n = 0;    // a gap, the older ones no longer line up in time
+    last_tick = tick;
+    newest = (newest + 1) % (int) points.size();
+    points.at(newest) = q;
+    n = std::min(n + 1, (int) points.size());
+  }
+
+  int size() const {return n;}
+
+  // k = 0 is the oldest kept command
+  const std::vector<double>& at(int k) const
+  {
+    const int capacity = points.size();
+    return points.at((newest - n + 1 + k + capacity) % capacity);
+  }
+
+private:
+
+  std::vector< std::vector<double> > points;
+  int newest = -1;
+  int n = 0;
+  long last_tick = -2;
+};
+
+
+/////////////// REAL ROBOT (FR3 + custom joint controller) //////////////
+struct RealBackend
+{
+  static constexpr const char* node_name = "real_controller";
+  static constexpr const char* joint_states_topic = "franka/joint_states";
+  static constexpr const char* command_topic = "desired_joint_vals";
+
+  using CommandMsg = sensor_msgs::msg::JointState;
+  static constexpr int command_decimation = 1;    // a command every tick (500 Hz)
+  static constexpr int stream_points = 0;         // nothing to stream, every tick is a command already
+
+  static inline const std::vector<double> origin {0.5059, 0.0, 0.4346};
+  static constexpr double mapping_ratio = 3.0;    // default of the "mapping_ratio" parameter
+  static constexpr bool require_falcon = true;    // a trial with human authority waits for the PositionTalker
+  static constexpr const char* urdf = ROS2_PACKAGE_URDF;   // default of the [urdf] argument
+
+  static void read_joint_state(const sensor_msgs::msg::JointState & msg, std::vector<double>& q)
+  {
+    for (unsigned int i=0; i<n_joints; i++) q.at(i) = msg.position.at(i);
+  }
+
+  static void write_command(const std::vector<double>& q, const rclcpp::Time & input_stamp, CommandMsg & msg)
+  {
+    msg.header.stamp = input_stamp;
+    msg.position = q;
+  }
+};
+
+
+/////////////// GAZEBO (joint trajectory controller) //////////////
+struct GazeboBackend
+{
+  static constexpr const char* node_name = "gazebo_controller";
+  static constexpr const char* joint_states_topic = "joint_states";
+  static constexpr const char* command_topic = "joint_trajectory_controller/joint_trajectory";
+
+  using CommandMsg = trajectory_msgs::msg::JointTrajectory;
+  static constexpr int command_decimation = 25;   // 20 Hz, the joint trajectory controller does not keep up with more
+  static constexpr int command_period_ms = 2 * command_decimation;
+  static constexpr double latency = 2.0;          // artificial latency of the trajectory points, in command periods
+  static constexpr int stream_points = 3 * command_decimation;   // streaming: spans the latency plus one period of overlap
+
+  static inline const std::vector<double> origin {0.4569, 0.0, 0.3853};
+  static constexpr double mapping_ratio = 2.0;    // default of the "mapping_ratio" parameter (as the gazebo_controller always had)
+  static constexpr bool require_falcon = false;   // gazebo.launch.py starts no PositionTalker, runs without one as the reference alone
+  static constexpr const char* urdf = ROS2_PACKAGE_URDF;   // default of the [urdf] argument
+
+  // gazebo publishes the finger joint in between the arm joints
+  static void read_joint_state(const sensor_msgs::msg::JointState & msg, std::vector<double>& q)
+  {
+    static const unsigned int order[n_joints] = {0, 1, 7, 2, 3, 4, 5};
+    for (unsigned int i=0; i<n_joints; i++) q.at(i) = msg.position.at(order[i]);
+  }
+
+  // the trajectory header stamp is the start time of the trajectory for the joint trajectory controller,
+  // so it stays zero (= start on receipt) instead of carrying the input stamp
+  static void write_command(const std::vector<double>& q, const rclcpp::Time &, CommandMsg & msg)
+  {
+    msg.joint_names = {"panda_joint1", "panda_joint2", "panda_joint3", "panda_joint4", "panda_joint5", "panda_joint6", "panda_joint7"};
+
+    trajectory_msgs::msg::JointTrajectoryPoint point;
+    point.positions = q;
+    point.time_from_start.nanosec = command_period_ms * latency * 1000000;     //// => {milliseconds} * 1e6
+    msg.points = {point};
+  }
+
+  // streaming: the newest command is due the same latency from now as a single point would be, the older ones
+  // every 2 ms before it. The trajectory starts in the past (on the ROS clock, so sim time in Gazebo), which lets the
+  // controller pick it up mid-way instead of blending into it, and reaches past the next message
+  static void write_stream(const CommandHistory & history, const rclcpp::Time & now, CommandMsg & msg)
+  {
+    const int64_t tick_ns = 2000000;
+    int64_t start_ns = now.nanoseconds() + (int64_t) (command_period_ms * latency * 1000000) - (history.size() - 1) * tick_ns;
+    int first = 0;
+    while (start_ns < 0 && first < history.size() - 1) {   // right after the clock starts
+      start_ns += tick_ns;
+      first++;
+    }
+
+    msg.header.stamp = rclcpp::Time(std::max<int64_t>(start_ns, 0), now.get_clock_type());
+    msg.joint_names = {"panda_joint1", "panda_joint2", "panda_joint3", "panda_joint4", "panda_joint5", "panda_joint6", "panda_joint7"};
+    msg.points.resize(history.size() - first);
+    for (int k=first; k<history.size(); k++) {
+      trajectory_msgs::msg::JointTrajectoryPoint & point = msg.points.at(k - first);
+      point.positions = history.at(k);
+      point.time_from_start = rclcpp::Duration::from_nanoseconds((k - first) * tick_ns);
+    }
+  }
+};
+
+#endif  // ROS2_PACKAGE__CONTROLLER_BACKENDS_HPP_
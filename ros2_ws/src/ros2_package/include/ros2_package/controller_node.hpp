@@ -0,0 +1,965 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - C++ class template of the controller node, shared by
+//   the RealController and the GazeboController, which
+//   only differ in their backend policy (controller_backends.hpp):
+//   topic names, joint ordering, command message type and rate
+//
+// - Main functionalities:
+//   1. Subscribes to Falcon joystick position
+//   2. Subscribes to robot joint states
+//   3. Publishes the Boolean data logging flag (-> TrajRecorder)
+//   4. Publishes the robot TCP position (-> TrajRecorder, MarkerPublisher)
+//   5. Publishes the joint values to track (-> Joint Trajectory Controller / Custom Controller)
+//
+// - The Falcon samples carry their device-read time, which is
+//   passed on in the command (real robot) and tcp_position
+//   messages, and the input-to-command latency of every tick
+//   is logged at the end of the trial (see scripts/latency_monitor.py)
+//
+// - The control logic itself lives in the SharedControlCore
+//   (shared_control.hpp) and the feature blocks in their own
+//   components (trial_replay.hpp, falcon_shm.hpp, input_predictor.hpp,
+//   collision_map.hpp, trial_stats.hpp), this node only does the
+//   ROS I/O, so several namespaced controllers can share one process:
+//     ros2 run ros2_package real_controller [num_controllers] [num_threads] [urdf]
+//
+// - Replay mode (set the "replay_file" parameter):
+//   feeds a recorded trial csv back through the same controller tick,
+//   driven by a simulated clock and a kinematic plant model, and diffs
+//   the resulting TCP trajectory against the logged one
+//   (no publishers are created, nothing goes out to the robot,
+//   see trial_replay.hpp).
+//   With several controllers, "{ns}" in "replay_file" and
+//   "replay_output" is replaced by each one's namespace
+//   (robot0, robot1, ...), so every controller replays its own trial
+//
+// - Session mode (set the "session" parameter to 1):
+//   the node stays alive between trials and runs each one
+//   through the "run_trial" action, holding the robot at
+//   home in between (see scripts/run_session.py)
+//
+// - Inputs: newest-sample-only QoS on the Falcon and joint
+//   state streams, with deadline / liveliness monitoring
+//   (input_monitor.hpp). While an input is stale the robot
+//   coasts to a smooth hold and the trial clock is paused.
+//   A Falcon that never sent a sample only holds the robot
+//   if the trial gives the human authority and
+//   "require_falcon" is set (default: real robot yes, Gazebo no)
+//
+// - Falcon input through shared memory (set "falcon_shm" to the
+//   segment name the PositionTalker writes, see falcon_shm.hpp):
+//   each tick takes the newest sample straight from the seqlock
+//   slot, the topic is only used while that is not fresh
+//
+// - Input prediction (set "input_prediction" to 1): a Kalman
+//   filter on the human input (input_predictor.hpp) extrapolates
+//   each tick's input by its measured age plus
+//   "prediction_lookahead_ms" (e.g. the robot's tracking lag from
+//   scripts/latency_monitor.py). Only the control uses it, the
+//   tcp_position messages keep the measured human position.
+//   Samples and target are both on the steady clock (the device
+//   stamps are wall-clock times, under sim time the arrival counts)
+//
+// - Streaming (Gazebo, set "stream_commands" to 1): each command
+//   message carries all the 500 Hz solutions since the last one
+//   and a bit before, as a timed multi-point trajectory
+//   (GazeboBackend::write_stream), at the same message rate
+//
+// - Collision map (set "collision_map" to 1): the workspace
+//   cloud of the CloudPreprocessor is integrated into an
+//   occupancy map on a background thread (collision_map.hpp),
+//   and each tick keeps the TCP target "collision_clearance"
+//   away from whatever is mapped, by stopping it short on its
+//   way there. The tick only reads the newest snapshot of the
+//   map, it never waits for the integration
+//
+// - IK conditioning: the manipulability and smallest singular
+//   value of every IK solution are published on "ik_conditioning"
+//   at 50 Hz. With "singularity_scaling" set to 1 the human
+//   authority is scaled down as the arm gets close to a singularity
+//
+// - Startup: the controller is ready as soon as the joint
+//   states have settled and the warm-up is over. It then
+//   publishes a latched "controller_ready" event with the
+//   time spent in each startup stage
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__CONTROLLER_NODE_HPP_
+#define ROS2_PACKAGE__CONTROLLER_NODE_HPP_
+
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+#include "std_msgs/msg/float64.hpp"
+#include "std_msgs/msg/bool.hpp"
+#include "trajectory_msgs/msg/joint_trajectory.hpp"
+#include "trajectory_msgs/msg/joint_trajectory_point.hpp"
+#include "sensor_msgs/msg/joint_state.hpp"
+#include "sensor_msgs/msg/point_cloud2.hpp"
+
+#include "tutorial_interfaces/msg/falconpos_stamped.hpp"
+#include "tutorial_interfaces/msg/ik_conditioning.hpp"
+#include "tutorial_interfaces/msg/pos_info_stamped.hpp"
+#include "tutorial_interfaces/action/run_trial.hpp"
+
+#include "rclcpp_action/rclcpp_action.hpp"
+
+#include "ros2_package/async_logger.hpp"
+#include "ros2_package/camera_extrinsics.hpp"
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/collision_map.hpp"
+#include "ros2_package/falcon_shm.hpp"
+#include "ros2_package/input_monitor.hpp"
+#include "ros2_package/input_predictor.hpp"
+#include "ros2_package/latency_histogram.hpp"
+#include "ros2_package/point_cloud_layout.hpp"
+#include "ros2_package/ros_log_sink.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tracing.hpp"
+#include "ros2_package/trial_replay.hpp"
+#include "ros2_package/trial_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <stdio.h>
+#include <thread>
+
+#include <algorithm>
+
+#include <iostream>
+
+
+/////////////// DEFINITION OF NODE CLASS //////////////
+
+template<class Backend>
+class ControllerNode : public rclcpp::Node
+{
+public:
+
+  using RunTrial = tutorial_interfaces::action::RunTrial;
+  using GoalHandleRunTrial = rclcpp_action::ServerGoalHandle<RunTrial>;
+
+  // parameters name list
+  std::vector<std::string> param_names = {"free_drive", "mapping_ratio", "use_depth", "part_id", "alpha_id", "traj_id"};
+  int free_drive {0};
+  double mapping_ratio {Backend::mapping_ratio};
+  int use_depth {0};
+  int part_id {0};
+  int alpha_id {0};
+  int traj_id {0};
+
+  const int control_freq = 500;   // the rate at which the "controller_publisher" function is called in [Hz]
+  int tick_count = 0;             // for the command decimation of the backend
+  long n_ticks = 0;               // controller_publisher calls so far
+
+  // streaming of the recent commands (only backends with stream_points > 0)
+  int stream_commands {0};
+  CommandHistory command_history {std::max(Backend::stream_points, 1)};
+
+  // empty noise vector
+  std::string noise_file {"noise1.csv"};
+
+  // replay mode: recorded trial csv in, per-sample diff csv out (empty = normal operation), see trial_replay.hpp
+  bool replay_mode = false;
+  bool replay_per_namespace = true;   // each namespaced controller gets its own replay files ("{ns}" in both names)
+  bool trial_finished = false;
+
+  // session mode: trials are started by the "run_trial" action instead of on startup
+  int session {0};
+  bool trial_active = false;
+  bool commanded = false;   // at least one command message has been sent
+  bool holding = false;     // ... and it is safe to keep publishing the last one while idle
+  std::shared_ptr<GoalHandleRunTrial> goal_handle_;
+
+  // error sums over the recorded samples of the current trial, for the action result
+  TrialErrors trial_errors;
+
+  // called once the trial is over (default: shut down, as a single controller per process always did)
+  std::function<void()> on_trial_finished = []() {rclcpp::shutdown();};
+
+  // startup stages (node setup, first joint state, joints settled, warm-up) and their durations in [seconds]
+  std::chrono::steady_clock::time_point startup_start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point stage_start = startup_start;
+  std::vector< std::pair<std::string, double> > startup_stages;
+  bool got_joint_state = false;
+  bool ready = false;
+
+  // stale-input holds of the current trial
+  bool require_falcon = Backend::require_falcon;
+  bool input_hold = false;
+  int n_holds = 0;
+  std::chrono::steady_clock::time_point hold_start;
+
+  // device-read time of the newest Falcon sample, and its age whenever a command goes out
+  rclcpp::Time input_stamp;
+  bool got_input = false;
+  LatencyHistogram input_latency;
+
+  // shared-memory Falcon input (empty name = topic only)
+  std::string falcon_shm_name {""};
+
+  // prediction of the human input (off by default)
+  int input_prediction {0};
+  double prediction_lookahead_ms {0.0};    // on top of the measured input age
+
+  // collision map from the workspace cloud (off by default)
+  int collision_map {0};
+  double collision_clearance {0.03};    // [m]
+  double map_voxel_size {0.02};         // [m]
+  std::string cloud_topic {"points_workspace"};
+  //////// KEEP CONSISTENT WITH CLOUD PREPROCESSOR (crop_half_size) ////////
+  std::vector<double> map_half_size {0.45, 0.55, 0.45};
+  bool cloud_warned = false;
+
+  // conditioning of the IK solutions (in the core), published at 50 Hz
+  int singularity_scaling {0};
+  int conditioning_count = 0;
+
+  // what the safety layers of the core did this trial (collision map, safety filter, self-collision, conditioning)
+  TrialStats trial_stats {control_freq};
+
+
+  ////////////////////////////////////////////////////////////////////////
+  ControllerNode(const KDL::Chain & panda_chain, const std::string & name_space = "")
+  : Node(Backend::node_name, name_space)
+  {
+    // parameter stuff
+    this->declare_parameter(param_names.at(0), 0);
+    this->declare_parameter(param_names.at(1), Backend::mapping_ratio);
+    this->declare_parameter(param_names.at(2), 0);
+    this->declare_parameter(param_names.at(3), 0);
+    this->declare_parameter(param_names.at(4), 0);
+    this->declare_parameter(param_names.at(5), 0);
+
+    std::vector<rclcpp::Parameter> params = this->get_parameters(param_names);
+    free_drive = std::stoi(params.at(0).value_to_string().c_str());
+    mapping_ratio = std::stod(params.at(1).value_to_string().c_str());
+    use_depth = std::stod(params.at(2).value_to_string().c_str());
+    part_id = std::stoi(params.at(3).value_to_string().c_str());
+    alpha_id = std::stoi(params.at(4).value_to_string().c_str());
+    traj_id = std::stoi(params.at(5).value_to_string().c_str());
+
+    // overwrite alpha_id if the free drive mode is activated
+    if (free_drive == 1) alpha_id = 5;
+
+    // replay parameters (kept separate from the experiment parameters above)
+    std::string replay_file = this->declare_parameter("replay_file", std::string(""));
+    std::string replay_output = this->declare_parameter("replay_output", std::string(""));
+    double plant_time_constant = this->declare_parameter("plant_time_constant", 0.0);   // [seconds], 0 = ideal tracking
+    replay_per_namespace = replay_file.find(namespace_placeholder) != std::string::npos &&
+                           (replay_output.empty() || replay_output.find(namespace_placeholder) != std::string::npos);
+    replay_mode = !replay_file.empty();
+    if (replay_mode) {
+      replay_ = std::make_unique<TrialReplay>(replace_namespace(replay_file, name_space), replace_namespace(replay_output, name_space),
+                                              plant_time_constant, control_freq);
+    }
+
+    session = this->declare_parameter("session", 0);
+    if (replay_mode) session = 0;
+
+    falcon_shm_name = this->declare_parameter("falcon_shm", std::string(""));
+    if (!falcon_shm_name.empty() && !replay_mode) falcon_shm_ = std::make_unique<FalconShmPoller>(falcon_shm_name, control_freq / 2);
+
+    // the replayed input is already aligned with the ticks, so there is nothing to predict there
+    input_prediction = this->declare_parameter("input_prediction", 0);
+    prediction_lookahead_ms = this->declare_parameter("prediction_lookahead_ms", 0.0);
+    if (replay_mode) input_prediction = 0;
+    if (input_prediction) prediction_ = std::make_unique<TickPrediction>(prediction_lookahead_ms);
+
+    // the replayed trial has no cloud to go with it
+    collision_map = this->declare_parameter("collision_map", 0);
+    collision_clearance = this->declare_parameter("collision_clearance", collision_clearance);
+    map_voxel_size = this->declare_parameter("map_voxel_size", map_voxel_size);
+    cloud_topic = this->declare_parameter("cloud_topic", cloud_topic);
+    map_half_size = this->declare_parameter("map_half_size", map_half_size);
+    if (replay_mode) collision_map = 0;
+
+    singularity_scaling = this->declare_parameter("singularity_scaling", 0);
+
+    stream_commands = this->declare_parameter("stream_commands", 0);
+    if (stream_commands && Backend::stream_points == 0) {
+      std::cout << Backend::node_name << " commands every tick already, ignoring stream_commands" << std::endl;
+      stream_commands = 0;
+    }
+
+    // control-path messages go through the async logger, optionally also into a file
+    std::string log_file = this->declare_parameter("log_file", std::string(""));
+    if (!AsyncLogger::instance().set_file(log_file)) std::cout << "Unable to open the log file: " << log_file << std::endl;
+
+    print_params();
+
+    // this controller's own copy of the kinematics and control state
+    core_ = std::make_unique<SharedControlCore>(panda_chain, control_freq);
+    core_->origin = Backend::origin;
+    core_->tcp_pos = Backend::origin;
+    core_->singularity_scaling = singularity_scaling;
+    core_->start_trial(alpha_id, traj_id, use_depth, mapping_ratio);
+    trial_active = !session;
+
+    // occupancy map around the task-space origin, filled from the workspace cloud
+    if (collision_map) {
+      collision_map_ = std::make_unique<CollisionMap>(Backend::origin, map_half_size, map_voxel_size, collision_clearance);
+      core_->occupancy = collision_map_->occupancy();
+      cloud_sub_ = this->create_subscription<sensor_msgs::msg::PointCloud2>(
+        cloud_topic, rclcpp::SensorDataQoS(), std::bind(&ControllerNode::cloud_callback, this, std::placeholders::_1));
+      std::cout << "Collision map: " << cloud_topic << " in " << map_voxel_size * 100 << " cm voxels, "
+                << collision_clearance * 100 << " cm clearance" << std::endl;
+    }
+
+    // no publishers at all in replay mode: a replay ticks far faster than real-time and must never reach
+    // the robot's joint controller or a running TrajRecorder (the tick is driven by run_replay() instead)
+    if (!replay_mode) {
+      // joint controller publisher & timer
+      controller_pub_ = this->create_publisher<CommandMsg>(Backend::command_topic, 10);
+      controller_timer_ = this->create_wall_timer(std::chrono::milliseconds(2), std::bind(&ControllerNode::controller_publisher, this));    // controls at 500 Hz
+
+      // tcp position publisher & timer
+      tcp_pos_pub_ = this->create_publisher<tutorial_interfaces::msg::PosInfoStamped>("tcp_position", 10);
+
+      // IK conditioning publisher, at 50 Hz while controlling
+      conditioning_pub_ = this->create_publisher<tutorial_interfaces::msg::IkConditioning>("ik_conditioning", 10);
+
+      // recording flag publisher & timer
+      record_flag_pub_ = this->create_publisher<std_msgs::msg::Bool>("record", 10);
+      record_flag_timer_ = this->create_wall_timer(std::chrono::milliseconds(2), std::bind(&ControllerNode::record_flag_publisher, this));    // publishes at 500 Hz
+
+      // second_last_point publisher
+      last_point_pub_ = this->create_publisher<std_msgs::msg::Bool>("last_point", 10);  // publishes only once
+
+      // countdown publisher, only publishes at whole second points during smoothing
+      countdown_pub_ = this->create_publisher<std_msgs::msg::Float64>("countdown", 10);
+
+      // ready event, latched for whoever subscribes later (launch scripts, run_session.py)
+      ready_pub_ = this->create_publisher<std_msgs::msg::String>("controller_ready", rclcpp::QoS(1).transient_local());
+    }
+
+    // input QoS: only the newest sample counts. The PositionTalker offers a 10 ms deadline and 250 ms lease,
+    // the joint state broadcasters offer neither (requesting one would not connect), so those only get a timeout
+    falcon_monitor_ = std::make_unique<InputMonitor>("falcon_position",
+      declare_stream_qos(*this, "falcon_qos", {1, false, 20, 500, 20}));
+    require_falcon = this->declare_parameter("require_falcon", Backend::require_falcon);
+    joint_states_monitor_ = std::make_unique<InputMonitor>(Backend::joint_states_topic,
+      declare_stream_qos(*this, "joint_states_qos", {1, false, 0, 0, 100}));
+
+    // live inputs are not used in replay mode (Falcon input comes from the log, joint feedback from the plant)
+    if (!replay_mode) {
+      joint_vals_sub_ = this->create_subscription<sensor_msgs::msg::JointState>(
+        Backend::joint_states_topic, make_qos(joint_states_monitor_->qos),
+        std::bind(&ControllerNode::joint_states_callback, this, std::placeholders::_1),
+        joint_states_monitor_->subscription_options());
+
+      falcon_pos_sub_ = this->create_subscription<tutorial_interfaces::msg::FalconposStamped>(
+        "falcon_position", make_qos(falcon_monitor_->qos),
+        std::bind(&ControllerNode::falcon_pos_callback, this, std::placeholders::_1),
+        falcon_monitor_->subscription_options());
+    }
+
+    // trial-execution action (the kinematics, noise and joint states are kept between trials)
+    if (session) {
+      run_trial_server_ = rclcpp_action::create_server<RunTrial>(
+        this, "run_trial",
+        std::bind(&ControllerNode::handle_goal, this, std::placeholders::_1, std::placeholders::_2),
+        std::bind(&ControllerNode::handle_cancel, this, std::placeholders::_1),
+        std::bind(&ControllerNode::handle_accepted, this, std::placeholders::_1));
+      std::cout << "Session mode: waiting for run_trial goals ..." << std::endl;
+    }
+
+    // read the noise data csv file
+    core_->robot_noise_vector = generate_noise_vector(noise_file);
+
+    // read the recorded trial to replay
+    if (replay_mode) replay_->load();
+
+    mark_startup_stage("node setup");
+  }
+
+  ///////////////////////////////////// REPLAY A RECORDED TRIAL /////////////////////////////////////
+  // runs the whole trial (prep -> smoothing -> recording -> shifting -> homing) as fast as possible,
+  // using tick / control_freq as the clock instead of the wall timers
+  void run_replay()
+  {
+    if (replay_->log.times.empty()) {
+      std::cout << "Replay log " << replay_->file << " has no samples, nothing to replay!" << std::endl;
+      return;
+    }
+
+    // the kinematic plant starts at home and is already settled, so there is nothing to wait for
+    core_->curr_joint_vals = home_joint_vals;
+    core_->skip_prep();
+    long ticks = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    while (!trial_finished && rclcpp::ok()) {
+      replay_->inject_input(*core_);   // the logged human input for the current simulated time
+      controller_publisher();          // one controller tick
+      replay_->step_plant(*core_);     // joints follow the command with a first-order lag
+      ticks++;
+    }
+
+    auto finish = std::chrono::high_resolution_clock::now();
+    double wall_time = std::chrono::duration<double>(finish - start).count();
+
+    replay_->write_diff((double) ticks / control_freq, wall_time);
+  }
+
+private:
+
+  ///////////////////////////////////// JOINT CONTROLLER /////////////////////////////////////
+  void controller_publisher()
+  {
+    n_ticks++;
+    poll_falcon_shm();
+    TRACE_CALLBACK_SCOPE("controller_tick", got_input ? input_stamp.nanoseconds() : 0);
+    if (trial_finished) return;
+
+    // between session trials: keep the last command going so the robot holds still
+    if (!trial_active) {
+      hold_command();
+      return;
+    }
+
+    if (goal_handle_ && goal_handle_->is_canceling()) {
+      ASYNC_LOG_INFO("\n    Trial canceled, holding the current position ...    \n");
+      finish_goal(false, "canceled");
+      return;
+    }
+
+    // never command from stale inputs, hold smoothly until they are back
+    // (the predicted input is only used inside the tick, the measured one is put back right after)
+    bool stale = inputs_stale();
+    bool predicted = !stale && predict_human_offset();
+    TickOutput out = stale ? core_->hold_tick() : core_->tick();
+    if (predicted) prediction_->restore(core_->human_offset);
+
+    trial_stats.update(out, *core_);
+    if (out.min_singular_value > 0.0) conditioning_publisher(out);
+
+    // session feedback at 10 Hz
+    if (goal_handle_ && ++feedback_count % (control_freq / 10) == 0) {
+      auto feedback = std::make_shared<RunTrial::Feedback>();
+      feedback->phase = core_->phase();
+      feedback->progress = core_->progress();
+      goal_handle_->publish_feedback(feedback);
+    }
+
+    if (out.prep_count >= 0) {
+      if (out.prep_count % control_freq == 0) ASYNC_LOG_INFO("The prep_count is currently %d\n", out.prep_count);
+    }
+    if (out.warmup_started) mark_startup_stage("joints settled");
+    if (out.control_started) announce_ready();
+
+    if (!replay_mode && out.noise_idx >= 0 && out.noise_idx % 100 == 0) ASYNC_LOG_INFO("noise_value = %f", out.noise);
+
+    ///////////// publish the tcp position message /////////////
+    if (out.publish_tcp) {
+      if (replay_mode) replay_->record_sample(*core_);
+      else tcp_pos_publisher(out);
+    }
+
+    // shutdown down 1 second after homing
+    if (out.finished) {
+      if (session) ASYNC_LOG_INFO("\n    Trial finished cleanly! Waiting for the next trial ...    \n");
+      else ASYNC_LOG_INFO("\n    Trial finished cleanly! Shutting down now ... Bye-bye!    \n");
+      end_trial();
+    }
+
+    ///////// check limits /////////
+    if (out.limits_violated) {
+      ASYNC_LOG_ERROR("--------\nThe commands have been outside the joint limits of the Panda arm (or out of its reach) for %.1f s, shutting down now !!!\n---------",
+                      core_->escalation_time);
+      end_trial(false);
+    }
+
+    ///////// prepare and publish the command message (at the backend's rate) /////////
+    if (out.publish_command && (trial_active || !session)) {
+      publish_command();
+
+      // input-to-command latency, while the commands are actually computed from the Falcon input (never in replay, there is no input)
+      if (got_input && core_->control && !out.holding) input_latency.add((this->now() - input_stamp).nanoseconds() / 1e3);
+    }
+
+    if (out.record_started) {
+      ASYNC_LOG_INFO("\n\n\n\n\n\n======================= RECORD FLAG IS SET TO => TRUE =======================\n\n\n\n\n\n");
+    }
+    if (out.record_stopped) {
+      ASYNC_LOG_INFO("\n\n\n\n\n\n======================= RECORD FLAG IS SET TO => FALSE =======================\n\n\n\n\n\n");
+    }
+
+    ///////////// check if need to publish the countdown message /////////////
+    if (out.countdown >= 0 && !replay_mode) {
+      auto count_msg = std_msgs::msg::Float64();
+      count_msg.data = out.countdown;
+      countdown_pub_->publish(count_msg);
+    }
+  }
+
+  ///////////////////////////////////// TCP POSITION PUBLISHER /////////////////////////////////////
+  void tcp_pos_publisher(const TickOutput & out)
+  {
+    if (out.last_point) {
+      auto lp = std_msgs::msg::Bool();
+      lp.data = true;
+      ASYNC_LOG_INFO("\n\n\n\n\n\n======================= SETTING LAST POINT TO => TRUE =======================\n\n\n\n\n\n");
+      last_point_pub_->publish(lp);
+    }
+
+    const std::vector<double> & origin = core_->origin;
+
+    // note: this is in meters
+    auto message = tutorial_interfaces::msg::PosInfoStamped();
+    message.header.stamp = this->now();
+    if (got_input) message.input_stamp = input_stamp;
+
+    message.ref_position = {
+      origin.at(0) + core_->ref_offset.at(0),
+      origin.at(1) + core_->ref_offset.at(1),
+      origin.at(2) + core_->ref_offset.at(2)
+    };
+
+    message.human_position = {
+      origin.at(0) + core_->human_offset.at(0),
+      origin.at(1) + core_->human_offset.at(1),
+      origin.at(2) + core_->human_offset.at(2)
+    };
+
+    message.robot_position = {
+      origin.at(0) + core_->robot_offset.at(0),
+      origin.at(1) + core_->robot_offset.at(1),
+      origin.at(2) + core_->robot_offset.at(2)
+    };
+
+    message.tcp_position = core_->tcp_pos;
+
+    message.time_from_start = out.time_from_start;    // out of total of 10 seconds
+
+    tcp_pos_pub_->publish(message);
+    TRACE_TCP_PUBLISH(got_input ? input_stamp.nanoseconds() : 0);
+
+    // running error sums for the action result
+    if (session) {
+      trial_errors.add(message.human_position, message.robot_position, message.tcp_position, message.ref_position, use_depth);
+    }
+  }
+
+  ///////////////////////////////////// STALE INPUTS /////////////////////////////////////
+  bool inputs_stale()
+  {
+    if (replay_mode) return false;
+
+    // a missing Falcon only matters if the human has any authority in this trial (alpha_id 0 never uses it)
+    falcon_monitor_->required = require_falcon && core_->iax + core_->iay + core_->iaz > 0.0;
+
+    bool falcon_stale = falcon_monitor_->stale();
+    bool joints_stale = joint_states_monitor_->stale();
+    bool stale = falcon_stale || joints_stale;
+
+    // only a hold once the inputs are actually used for control
+    if (stale && core_->control && !input_hold) {
+      input_hold = true;
+      n_holds++;
+      hold_start = std::chrono::steady_clock::now();
+      const InputMonitor & monitor = falcon_stale ? *falcon_monitor_ : *joint_states_monitor_;
+      ASYNC_LOG_WARN("Input %s is stale (last sample %.1f ms ago), holding the robot ...", monitor.name.c_str(), monitor.age_ms());
+    }
+    if (!stale && input_hold) {
+      input_hold = false;
+      ASYNC_LOG_INFO("Inputs are back after a %.1f ms hold, resuming the trial",
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - hold_start).count());
+    }
+    return stale;
+  }
+
+  ///////////////////////////////////// WORKSPACE CLOUD SUBSCRIBER /////////////////////////////////////
+  // hands the cloud over to the occupancy map, with spheres around the arm so it does not map itself
+  void cloud_callback(const sensor_msgs::msg::PointCloud2 & msg)
+  {
+    // the CloudPreprocessor's layout: packed float32 x, y, z in the robot's base frame, and nothing else
+    if (msg.header.frame_id != panda_base_frame || packed_xyz_offset(msg) != 0 || msg.point_step != 3 * sizeof(float)) {
+      if (!cloud_warned) std::cout << "Ignoring the clouds on " << cloud_topic << ": expected packed little-endian float32 x, y, z in " << panda_base_frame << std::endl;
+      cloud_warned = true;
+      return;
+    }
+
+    tf2::Vector3 camera = depth_camera_in_panda().getOrigin();
+    const double sensor[3] = {camera.x(), camera.y(), camera.z()};
+    collision_map_->submit(msg.data.data(), (std::size_t) msg.width * msg.height, *core_, sensor);
+  }
+
+  ///////////////////////////////////// IK CONDITIONING PUBLISHER /////////////////////////////////////
+  void conditioning_publisher(const TickOutput & out)
+  {
+    if (replay_mode || ++conditioning_count % (control_freq / 50) != 0) return;
+    tutorial_interfaces::msg::IkConditioning message;
+    message.header.stamp = this->now();
+    message.manipulability = out.manipulability;
+    message.min_singular_value = out.min_singular_value;
+    message.ik_time_us = core_->ik_time_us;
+    message.authority_scale = core_->authority_scale;
+    conditioning_pub_->publish(message);
+  }
+
+  ///////////////////////////////////// END OF TRIAL /////////////////////////////////////
+  void end_trial(bool success = true)
+  {
+    if (!replay_mode) {
+      ASYNC_LOG_INFO("Stale-input holds this trial: %d (missed deadlines: falcon_position %ld, %s %ld)",
+                     n_holds, (long) falcon_monitor_->missed_deadlines,
+                     joint_states_monitor_->name.c_str(), (long) joint_states_monitor_->missed_deadlines);
+      if (input_latency.count() > 0) {
+        ASYNC_LOG_INFO("Input-to-command latency [ms]: mean = %.3f, p50 = %.3f, p99 = %.3f, max = %.3f (%ld ticks)",
+                       input_latency.mean() / 1e3, input_latency.percentile(50) / 1e3, input_latency.percentile(99) / 1e3,
+                       input_latency.max() / 1e3, (long) input_latency.count());
+      }
+      if (prediction_ && prediction_->n_predicted() > 0) {
+        ASYNC_LOG_INFO("Input prediction: mean horizon = %.3f ms (%ld ticks)", prediction_->mean_horizon_ms(), prediction_->n_predicted());
+      }
+      trial_stats.report();
+      if (collision_map_) collision_map_->report(trial_stats.n_clamped);
+    }
+
+    // a session keeps running and waits for the next goal
+    if (session) {
+      if (trial_active) finish_goal(success, success ? "finished" : "joint limits violated");
+      return;
+    }
+
+    if (trial_finished) return;
+    trial_finished = true;
+
+    // a replay only stops its own tick loop, the live node stops its timers and reports back
+    if (!replay_mode) {
+      controller_timer_->cancel();
+      record_flag_timer_->cancel();
+      on_trial_finished();
+    }
+  }
+
+  ///////////////////////////////////// STARTUP STAGES /////////////////////////////////////
+  void mark_startup_stage(const std::string & name)
+  {
+    if (ready) return;
+    auto now = std::chrono::steady_clock::now();
+    startup_stages.push_back({name, std::chrono::duration<double>(now - stage_start).count()});
+    stage_start = now;
+  }
+
+  // once per node: report the startup stages and publish the ready event
+  void announce_ready()
+  {
+    if (ready) return;
+    mark_startup_stage("warm-up");
+    ready = true;
+
+    char stage[64];
+    std::string report = this->get_fully_qualified_name();
+    snprintf(stage, sizeof(stage), " ready after %.3f s (", std::chrono::duration<double>(stage_start - startup_start).count());
+    report += stage;
+    for (size_t i=0; i<startup_stages.size(); i++) {
+      snprintf(stage, sizeof(stage), "%s%s %.3f s", (i > 0) ? ", " : "", startup_stages.at(i).first.c_str(), startup_stages.at(i).second);
+      report += stage;
+    }
+    report += ")";
+    ASYNC_LOG_INFO("%s", report.c_str());
+
+    if (replay_mode) return;
+    auto message = std_msgs::msg::String();
+    message.data = report;
+    ready_pub_->publish(message);
+  }
+
+  ///////////////////////////////////// HOLD BETWEEN SESSION TRIALS /////////////////////////////////////
+  void hold_command()
+  {
+    if (holding) publish_command();
+  }
+
+  ///////////////////////////////////// COMMAND PUBLISHER /////////////////////////////////////
+  void publish_command()
+  {
+    if (replay_mode) return;   // there is no command publisher in replay mode
+    if (stream_commands) command_history.push(core_->message_joint_vals, n_ticks);
+    if (tick_count++ % Backend::command_decimation != 0) return;
+    CommandMsg msg;
+    if constexpr (Backend::stream_points > 0) {
+      if (stream_commands) Backend::write_stream(command_history, this->now(), msg);
+      else Backend::write_command(core_->message_joint_vals, input_stamp, msg);
+    } else {
+      Backend::write_command(core_->message_joint_vals, input_stamp, msg);
+    }
+    controller_pub_->publish(msg);
+    TRACE_COMMAND_PUBLISH(got_input ? input_stamp.nanoseconds() : 0);
+    commanded = true;
+  }
+
+  ///////////////////////////////////// RUN_TRIAL ACTION /////////////////////////////////////
+  rclcpp_action::GoalResponse handle_goal(const rclcpp_action::GoalUUID &, std::shared_ptr<const RunTrial::Goal> goal)
+  {
+    if (trial_active) {
+      ASYNC_LOG_WARN("A trial is already running, rejecting the new goal!");
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+    if (!valid_trial_conditions(goal->alpha_id, goal->traj_id, goal->mapping_ratio)) {
+      ASYNC_LOG_WARN("Invalid trial conditions, rejecting the new goal!");
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+    return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+  }
+
+  rclcpp_action::CancelResponse handle_cancel(const std::shared_ptr<GoalHandleRunTrial>)
+  {
+    return rclcpp_action::CancelResponse::ACCEPT;
+  }
+
+  void handle_accepted(const std::shared_ptr<GoalHandleRunTrial> goal_handle)
+  {
+    auto goal = goal_handle->get_goal();
+    part_id = goal->part_id;
+    alpha_id = (free_drive == 1) ? 5 : goal->alpha_id;
+    traj_id = goal->traj_id;
+    use_depth = goal->use_depth;
+    mapping_ratio = goal->mapping_ratio;
+    print_params();
+
+    core_->start_trial(alpha_id, traj_id, use_depth, mapping_ratio);
+
+    // the robot has been held at the last command and the joint states are current, so there is nothing to wait for
+    if (holding) core_->skip_prep();
+
+    trial_errors.reset();
+    feedback_count = 0;
+    n_holds = 0;
+    input_hold = false;
+    input_latency.reset();
+    if (prediction_) prediction_->reset();
+    trial_stats.reset();
+    conditioning_count = 0;
+
+    goal_handle_ = goal_handle;
+    trial_active = true;
+  }
+
+  void finish_goal(bool success, const std::string & message)
+  {
+    auto result = std::make_shared<RunTrial::Result>();
+    result->success = success;
+    result->message = message;
+    result->num_samples = trial_errors.n_samples;
+    if (trial_errors.n_samples > 0) {
+      result->human_ave = trial_errors.human_sum / trial_errors.n_samples;
+      result->robot_ave = trial_errors.robot_sum / trial_errors.n_samples;
+      result->overall_ave = trial_errors.overall_sum / trial_errors.n_samples;
+      result->overall_max = trial_errors.overall_max;
+    }
+
+    if (goal_handle_->is_canceling()) goal_handle_->canceled(result);
+    else if (success) goal_handle_->succeed(result);
+    else goal_handle_->abort(result);
+    goal_handle_.reset();
+
+    // stop recording, and only keep commanding the last position if it was a valid one
+    core_->record_flag = false;
+    holding = commanded && within_limits(core_->message_joint_vals);
+    trial_active = false;
+  }
+
+  ///////////////////////////////////// TRAJ RECORD FLAG PUBLISHER /////////////////////////////////////
+  void record_flag_publisher()
+  {
+    auto message = std_msgs::msg::Bool();
+    message.data = core_->record_flag;
+    record_flag_pub_->publish(message);
+  }
+
+  ///////////////////////////////////// JOINT STATES SUBSCRIBER /////////////////////////////////////
+  void joint_states_callback(const sensor_msgs::msg::JointState & msg)
+  {
+    TRACE_CALLBACK_SCOPE("joint_states_callback", 0);
+    joint_states_monitor_->received();
+    Backend::read_joint_state(msg, joint_state_vals);
+    core_->set_joint_state(joint_state_vals);
+
+    if (!got_joint_state) {
+      got_joint_state = true;
+      mark_startup_stage("first joint state");
+    }
+  }
+
+  ///////////////////////////////////// FALCON SUBSCRIBER /////////////////////////////////////
+  void falcon_pos_callback(const tutorial_interfaces::msg::FalconposStamped & msg)
+  {
+    if (shm_input_fresh()) return;    // the same sample has already come in through shared memory
+
+    input_stamp = rclcpp::Time(msg.header.stamp);
+    got_input = true;
+    TRACE_CALLBACK_SCOPE("falcon_callback", input_stamp.nanoseconds());
+    falcon_monitor_->received();
+    core_->set_falcon_position(msg.x, msg.y, msg.z);
+    if (prediction_) prediction_->update(steady_sample_ns(input_stamp), core_->human_offset);
+  }
+
+  ///////////////////////////////////// FALCON SHARED MEMORY /////////////////////////////////////
+  // takes the newest sample from the seqlock slot, if there is a new one (called at the start of every tick)
+  void poll_falcon_shm()
+  {
+    FalconShmSample sample;
+    if (!falcon_shm_ || !falcon_shm_->poll(sample)) return;
+
+    input_stamp = rclcpp::Time(sample.stamp_ns, RCL_ROS_TIME);
+    got_input = true;
+    TRACE_CALLBACK_SCOPE("falcon_shm", sample.stamp_ns);
+    falcon_monitor_->received();
+    core_->set_falcon_position(sample.x, sample.y, sample.z);
+    if (prediction_) prediction_->update(steady_sample_ns(input_stamp), core_->human_offset);
+  }
+
+  // shared memory is delivering, so the topic samples are not needed (they are a fallback otherwise)
+  bool shm_input_fresh() const
+  {
+    return falcon_shm_ && falcon_shm_->fresh(falcon_monitor_->qos.timeout_ms);
+  }
+
+  ///////////////////////////////////// INPUT PREDICTION /////////////////////////////////////
+  // swaps the predicted human input into the core for this tick, false if there is nothing to predict yet
+  bool predict_human_offset()
+  {
+    if (!prediction_ || !got_input || !core_->control) return false;
+    return prediction_->apply(steady_ns(), core_->human_offset);
+  }
+
+  static int64_t steady_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // device-read time of a sample moved onto the steady clock, by its age on arrival. The PositionTalker stamps on
+  // the wall clock (it never runs on sim time), comparable with now() only without sim time, else the arrival counts
+  int64_t steady_sample_ns(const rclcpp::Time & stamp)
+  {
+    int64_t age_ns = 0;
+    if (!this->get_clock()->ros_time_is_active()) age_ns = std::max<int64_t>((this->now() - stamp).nanoseconds(), 0);
+    return steady_ns() - age_ns;
+  }
+
+  ///////////////////////////////////// FUNCTION TO PRINT PARAMETERS /////////////////////////////////////
+  void print_params() {
+    for (unsigned int i=0; i<10; i++) std::cout << "\n";
+    std::cout << "\n\nThe current parameters [" << this->get_fully_qualified_name() << "] are as follows:\n" << std::endl;
+    std::cout << "Free drive mode = " << free_drive << "\n" << std::endl;
+    std::cout << "Mapping ratio = " << mapping_ratio << "\n" << std::endl;
+    std::cout << "Use depth parameter = " << use_depth << "\n" << std::endl;
+    std::cout << "Participant ID = " << part_id << "\n" << std::endl;
+    std::cout << "Alpha ID = " << alpha_id << "\n" << std::endl;
+    std::cout << "Trajectory ID = " << traj_id << "\n" << std::endl;
+    for (unsigned int i=0; i<10; i++) std::cout << "\n";
+  }
+
+  using CommandMsg = typename Backend::CommandMsg;
+
+  std::unique_ptr<SharedControlCore> core_;
+  std::unique_ptr<TrialReplay> replay_;
+  std::unique_ptr<TickPrediction> prediction_;
+  std::unique_ptr<CollisionMap> collision_map_;
+  std::vector<double> joint_state_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};   // in the core's joint order
+
+  typename rclcpp_action::Server<RunTrial>::SharedPtr run_trial_server_;
+  int feedback_count = 0;
+
+  typename rclcpp::Publisher<CommandMsg>::SharedPtr controller_pub_;
+  rclcpp::TimerBase::SharedPtr controller_timer_;
+
+  rclcpp::Publisher<tutorial_interfaces::msg::PosInfoStamped>::SharedPtr tcp_pos_pub_;
+
+  rclcpp::Publisher<tutorial_interfaces::msg::IkConditioning>::SharedPtr conditioning_pub_;
+
+  rclcpp::Publisher<std_msgs::msg::Bool>::SharedPtr record_flag_pub_;
+  rclcpp::TimerBase::SharedPtr record_flag_timer_;
+
+  rclcpp::Publisher<std_msgs::msg::Bool>::SharedPtr last_point_pub_;
+
+  rclcpp::Publisher<std_msgs::msg::Float64>::SharedPtr countdown_pub_;
+
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr ready_pub_;
+
+  std::unique_ptr<InputMonitor> falcon_monitor_;
+  std::unique_ptr<FalconShmPoller> falcon_shm_;
+  std::unique_ptr<InputMonitor> joint_states_monitor_;
+
+  rclcpp::Subscription<sensor_msgs::msg::JointState>::SharedPtr joint_vals_sub_;
+
+  rclcpp::Subscription<tutorial_interfaces::msg::FalconposStamped>::SharedPtr falcon_pos_sub_;
+
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_sub_;
+
+};
+
+
+//////////////////// MAIN FUNCTION OF BOTH CONTROLLERS ///////////////////
+
+template<class Backend>
+int run_controllers(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  use_ros_log_sink(rclcpp::get_logger(Backend::node_name));
+
+  // optional (non-ROS) arguments: number of controllers in this process, executor threads and the Panda URDF
+  std::vector<std::string> args = rclcpp::remove_ros_arguments(argc, argv);
+  const int num_controllers = (args.size() > 1) ? std::max(1, std::stoi(args.at(1))) : 1;
+  const int num_threads = (args.size() > 2) ? std::max(1, std::stoi(args.at(2))) : 0;   // 0 = one per core
+  const std::string urdf = (args.size() > 3) ? args.at(3) : std::string(Backend::urdf);
+
+  // Panda kinematic chain, from the cache unless the URDF changed (loaded once, copied into every controller)
+  auto chain_start = std::chrono::steady_clock::now();
+  KDL::Chain panda_chain;
+  bool from_cache = false;
+  if (!load_panda_chain(urdf, panda_chain, &from_cache)) {
+    rclcpp::shutdown();
+    return 1;
+  }
+  ASYNC_LOG_INFO("Kinematic chain %s in %.1f ms", from_cache ? "loaded from the cache" : "parsed from the URDF",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - chain_start).count());
+
+  // a single controller keeps the original topic names, several ones get a namespace each
+  std::vector< std::shared_ptr< ControllerNode<Backend> > > controllers;
+  std::atomic<int> running {num_controllers};
+  for (int i=0; i<num_controllers; i++) {
+    std::string name_space = (num_controllers == 1) ? "" : "robot" + std::to_string(i);
+    controllers.push_back(std::make_shared< ControllerNode<Backend> >(panda_chain, name_space));
+    controllers.back()->on_trial_finished = [&running]() {if (--running == 0) rclcpp::shutdown();};
+  }
+
+  if (controllers.front()->replay_mode) {
+    // the parameters are the same for all controllers of the process, only the namespace tells their files apart
+    if (num_controllers > 1 && !controllers.front()->replay_per_namespace) {
+      std::cout << "Several controllers would replay the same file, put " << namespace_placeholder
+                << " into replay_file and replay_output (or replay a single controller)" << std::endl;
+      controllers.clear();
+      AsyncLogger::instance().flush_and_stop();
+      rclcpp::shutdown();
+      return 1;
+    }
+
+    // replay each controller's trial from the simulated clock, in parallel
+    std::vector<std::thread> replays;
+    for (auto & controller : controllers) replays.emplace_back([controller]() {controller->run_replay();});
+    for (auto & replay : replays) replay.join();
+  } else {
+    // run live off the wall timers, all controllers sharing one thread pool
+    rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), num_threads);
+    for (auto & controller : controllers) executor.add_node(controller);
+    executor.spin();
+  }
+
+  AsyncLogger::instance().flush_and_stop();
+  rclcpp::shutdown();
+  return 0;
+}
+
+#endif  // ROS2_PACKAGE__CONTROLLER_NODE_HPP_
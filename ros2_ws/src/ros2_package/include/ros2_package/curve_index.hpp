@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Nearest-point queries on the reference trajectory,
+//   fast enough for the haptic loop of the PositionTalker
+//
+// - The curve is sampled once into a polyline, and a
+//   uniform grid over its bounding box (plus a margin)
+//   keeps, per cell, only the segments that can hold the
+//   nearest point of any query inside that cell. A query
+//   then checks a handful of segments instead of all of them
+//   (queries outside the grid fall back to checking all)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__CURVE_INDEX_HPP_
+#define ROS2_PACKAGE__CURVE_INDEX_HPP_
+
+#include <cstddef>
+#include <vector>
+
+
+/////////////// DEFINITION OF THE CURVE INDEX CLASS //////////////
+
+class CurveIndex
+{
+public:
+
+  // vertices of the polyline as {x0, y0, z0, x1, y1, z1, ...}, cell_size and margin in the same units
+  CurveIndex(const std::vector<double>& a_vertices, double a_cell_size, double margin);
+
+  // closest point on the curve to q (and the unit tangent there), returns the distance
+  double nearest(const double q[3], double closest[3], double tangent[3]) const;
+
+  std::size_t n_segments() const {return vertices.size() / 3 - 1;}
+  std::size_t n_cells() const {return cell_start.size() - 1;}
+  double mean_candidates() const {return (double) cell_segments.size() / n_cells();}
+
+private:
+
+  // squared distance from q to segment s, with the position u = [0, 1] of the closest point along it
+  double segment_distance2(int s, const double q[3], double& u) const;
+
+  // -1 if q is outside the grid
+  int cell_of(const double q[3]) const;
+
+  std::vector<double> vertices;
+  double cell_size;
+  double lower[3];
+  int dims[3];
+
+  // candidate segments of cell c: cell_segments[cell_start[c] .. cell_start[c+1])
+  std::vector<int> cell_start;
+  std::vector<int> cell_segments;
+};
+
+
+// the reference trajectory of traj_id in Falcon coordinates [m] (= task-space offset / mapping_ratio), n_samples + 1 vertices
+// (256 segments stay within ~15 um of the sine curve)
+std::vector<double> sample_reference_curve(int traj_id, int use_depth, double mapping_ratio, int n_samples = 256);
+
+#endif  // ROS2_PACKAGE__CURVE_INDEX_HPP_
@@ -0,0 +1,160 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Shared-memory channel for the Falcon samples, from the
+//   PositionTalker to the controllers on the same host,
+//   next to (not instead of) the falcon_position topic
+//
+// - One POSIX shared-memory segment (shm_open) holding:
+//   1. the newest sample, in a seqlock slot
+//   2. a history ring of the last falcon_shm_history samples
+//
+// - Seqlock: the writer makes the slot's sequence odd, writes
+//   the fields and makes it even again. A reader copies the
+//   fields and retries if the sequence was odd or changed in
+//   between. Neither side ever blocks or serializes anything,
+//   and a reader gives up after a few retries instead of
+//   spinning inside the control tick
+//
+// - The segment outlives the talker, so a restarted talker
+//   keeps writing into the one the controllers have mapped
+//
+// - FalconShmPoller: the reader as the control tick uses it,
+//   mapping the segment whenever the talker comes up and only
+//   handing out samples it has not seen yet
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__FALCON_SHM_HPP_
+#define ROS2_PACKAGE__FALCON_SHM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+const std::string default_falcon_shm_name = "/ros2_package_falcon";
+const int falcon_shm_history = 64;    // samples, ~128 ms at 500 Hz
+
+
+/////////////////// one Falcon sample (same units as the falcon_position message) ///////////////////
+struct FalconShmSample
+{
+  uint64_t index = 0;       // running sample number, 0 = no sample yet
+  int64_t stamp_ns = 0;     // device-read time (ROS time)
+  double x = 0.0;           // [cm]
+  double y = 0.0;
+  double z = 0.0;
+};
+
+
+/////////////////// layout of the shared segment ///////////////////
+struct alignas(64) FalconShmSlot
+{
+  std::atomic<uint64_t> seq;
+  std::atomic<uint64_t> index;
+  std::atomic<int64_t> stamp_ns;
+  std::atomic<double> x;
+  std::atomic<double> y;
+  std::atomic<double> z;
+};
+
+struct FalconShmSegment
+{
+  std::atomic<uint32_t> magic;        // set last, once the segment is initialized
+  uint32_t version;
+  std::atomic<uint64_t> count;        // samples written so far
+  FalconShmSlot newest;
+  FalconShmSlot history[falcon_shm_history];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<double>::is_always_lock_free,
+              "the seqlock needs lock-free atomics to work across processes");
+
+
+/////////////// WRITER (PositionTalker) //////////////
+
+class FalconShmWriter
+{
+public:
+
+  explicit FalconShmWriter(const std::string & a_name = default_falcon_shm_name);
+  ~FalconShmWriter();
+
+  FalconShmWriter(const FalconShmWriter &) = delete;
+  FalconShmWriter & operator=(const FalconShmWriter &) = delete;
+
+  bool is_open() const {return segment != nullptr;}
+
+  // publish a new sample (index is assigned here), wait-free
+  void write(int64_t stamp_ns, double x, double y, double z);
+
+  const std::string name;
+
+private:
+
+  FalconShmSegment* segment = nullptr;
+};
+
+
+/////////////// READER (controllers) //////////////
+
+class FalconShmReader
+{
+public:
+
+  explicit FalconShmReader(const std::string & a_name = default_falcon_shm_name);
+  ~FalconShmReader();
+
+  FalconShmReader(const FalconShmReader &) = delete;
+  FalconShmReader & operator=(const FalconShmReader &) = delete;
+
+  // map the segment, false while no talker has created it yet (try again later)
+  bool open();
+  bool is_open() const {return segment != nullptr;}
+
+  // newest sample, false if there is none or it could not be read consistently
+  bool read_newest(FalconShmSample & sample) const;
+
+  // up to n of the latest samples, oldest first (stops at the first one already overwritten)
+  int read_history(int n, std::vector<FalconShmSample> & samples) const;
+
+  const std::string name;
+
+private:
+
+  const FalconShmSegment* segment = nullptr;
+};
+
+
+/////////////// POLLING READER (controller tick) //////////////
+
+class FalconShmPoller
+{
+public:
+
+  // looks for the segment every retry_polls polls until the talker has created it
+  FalconShmPoller(const std::string & a_name, int a_retry_polls);
+
+  // the newest sample, false if there is none that was not handed out before
+  bool poll(FalconShmSample & sample);
+
+  // the last new sample came in less than max_age_ms ago
+  bool fresh(int max_age_ms) const;
+
+  const std::string & name() const {return reader.name;}
+
+private:
+
+  FalconShmReader reader;
+  const int retry_polls;
+  int open_wait = 0;    // polls until the next attempt to map the segment
+  uint64_t last_index = 0;
+  std::chrono::steady_clock::time_point last_sample;
+};
+
+#endif  // ROS2_PACKAGE__FALCON_SHM_HPP_
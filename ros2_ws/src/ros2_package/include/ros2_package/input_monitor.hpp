@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Per-topic QoS profiles, configurable through parameters
+//   ("<stream>.depth", "<stream>.reliable", "<stream>.deadline_ms",
+//   "<stream>.liveliness_ms", "<stream>.timeout_ms")
+//
+// - InputMonitor: tells whether an input stream has gone
+//   stale, from the DDS deadline / liveliness events and from
+//   the time since its last message (for publishers that do
+//   not offer a deadline, e.g. the franka joint states).
+//   A stream that never sent a sample only counts as stale
+//   while it is required (e.g. no Falcon in Gazebo, or a
+//   trial without human authority)
+//
+// - Both publisher and subscriber have to agree on the policies:
+//   the offered deadline and liveliness lease must not be longer
+//   than the requested ones, otherwise the topic does not connect
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__INPUT_MONITOR_HPP_
+#define ROS2_PACKAGE__INPUT_MONITOR_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+
+
+/////////////////// QoS of one stream ///////////////////
+struct StreamQos
+{
+  int depth = 1;             // keep-last depth (1 = only ever the newest sample)
+  bool reliable = false;     // best-effort by default, a late sample is worth nothing at 500 Hz
+  int deadline_ms = 0;       // max. period between samples, 0 = no deadline policy
+  int liveliness_ms = 0;     // liveliness lease (automatic), 0 = no liveliness policy
+  int timeout_ms = 0;        // time without a sample after which the stream counts as stale, 0 = never
+};
+
+inline StreamQos declare_stream_qos(rclcpp::Node & node, const std::string & stream, const StreamQos & defaults)
+{
+  StreamQos s;
+  s.depth = node.declare_parameter(stream + ".depth", defaults.depth);
+  s.reliable = node.declare_parameter(stream + ".reliable", defaults.reliable);
+  s.deadline_ms = node.declare_parameter(stream + ".deadline_ms", defaults.deadline_ms);
+  s.liveliness_ms = node.declare_parameter(stream + ".liveliness_ms", defaults.liveliness_ms);
+  s.timeout_ms = node.declare_parameter(stream + ".timeout_ms", defaults.timeout_ms);
+  return s;
+}
+
+inline rclcpp::QoS make_qos(const StreamQos & s)
+{
+  rclcpp::QoS qos(rclcpp::KeepLast(std::max(s.depth, 1)));
+  if (s.reliable) qos.reliable();
+  else qos.best_effort();
+
+  if (s.deadline_ms > 0) qos.deadline(rclcpp::Duration(std::chrono::milliseconds(s.deadline_ms)));
+  if (s.liveliness_ms > 0) {
+    qos.liveliness(rclcpp::LivelinessPolicy::Automatic);
+    qos.liveliness_lease_duration(rclcpp::Duration(std::chrono::milliseconds(s.liveliness_ms)));
+  }
+  return qos;
+}
+
+
+/////////////// DEFINITION OF THE INPUT MONITOR CLASS //////////////
+
+// all calls come from the owning node's callbacks (one mutually exclusive group), so nothing is shared across threads
+class InputMonitor
+{
+public:
+
+  InputMonitor(const std::string & a_name, const StreamQos & a_qos)
+  : name(a_name), qos(a_qos) {}
+
+  // event callbacks for the subscription, only for the policies that are actually set
+  rclcpp::SubscriptionOptions subscription_options()
+  {
+    rclcpp::SubscriptionOptions options;
+    if (qos.deadline_ms > 0) {
+      options.event_callbacks.deadline_callback = [this](rclcpp::QOSDeadlineRequestedInfo & info) {
+        missed_deadlines += info.total_count_change;
+        deadline_missed = true;
+      };
+    }
+    if (qos.liveliness_ms > 0) {
+      options.event_callbacks.liveliness_callback = [this](rclcpp::QOSLivelinessChangedInfo & info) {
+        writer_alive = info.alive_count > 0;
+      };
+    }
+    return options;
+  }
+
+  // a sample arrived
+  void received()
+  {
+    last_stamp = std::chrono::steady_clock::now();
+    got_sample = true;
+    deadline_missed = false;
+    writer_alive = true;
+  }
+
+  // no sample yet (if required), deadline missed since the last one, publisher gone or silent for longer than timeout_ms
+  bool stale() const
+  {
+    if (!got_sample) return required;
+    if (deadline_missed || !writer_alive) return true;
+    return qos.timeout_ms > 0 && std::chrono::steady_clock::now() - last_stamp > std::chrono::milliseconds(qos.timeout_ms);
+  }
+
+  // time since the last sample in [milliseconds] (-1 if there was none)
+  double age_ms() const
+  {
+    if (!got_sample) return -1.0;
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - last_stamp).count();
+  }
+
+  const std::string name;
+  const StreamQos qos;
+  bool required = true;           // false: no publisher at all is fine, only one that stops counts
+  int64_t missed_deadlines = 0;   // as counted by the DDS deadline events
+
+private:
+
+  std::chrono::steady_clock::time_point last_stamp;
+  bool got_sample = false;
+  bool deadline_missed = false;
+  bool writer_alive = true;
+};
+
+#endif  // ROS2_PACKAGE__INPUT_MONITOR_HPP_
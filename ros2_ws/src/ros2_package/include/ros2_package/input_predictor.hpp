@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Predicts where the human input (human_offset) will be
+//   a short horizon ahead, to make up for the delay between
+//   the Falcon read and the robot actually getting there
+//
+// - One constant-acceleration Kalman filter per axis
+//   (state: position, velocity, acceleration; white-noise
+//   jerk as process noise), updated with every Falcon sample
+//   at its device-read time
+//
+// - The prediction itself is the closed-form extrapolation
+//   of the filter state, so it costs the same on every tick,
+//   and the horizon is capped (max_horizon) so a late or
+//   lost sample can not fling the prediction away
+//
+// - TickPrediction: the predictor as the control tick uses
+//   it, swapping the prediction in for the tick and the
+//   measured input back afterwards
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__INPUT_PREDICTOR_HPP_
+#define ROS2_PACKAGE__INPUT_PREDICTOR_HPP_
+
+#include <cstdint>
+#include <vector>
+
+
+class InputPredictor
+{
+public:
+
+  // jerk_psd: spectral density of the jerk [m^2/s^5], meas_std: noise of a sample [m]
+  // (the defaults fit the Falcon at mapping_ratio 3 and hand motion up to ~1.5 Hz)
+  explicit InputPredictor(double a_jerk_psd = 10.0, double a_meas_std = 2e-4);
+
+  // forget the motion so far, the next sample starts the filter from rest
+  void reset();
+
+  // one sample (x, y, z) taken at stamp_ns
+  void update(int64_t stamp_ns, const std::vector<double>& z);
+
+  // position expected at t_ns, returns the horizon actually used in [seconds]
+  double predict(int64_t t_ns, std::vector<double>& out) const;
+
+  bool started() const {return n_updates > 0;}
+
+  double max_horizon = 0.1;   // [seconds]
+  double max_gap = 0.1;       // restart from rest if two samples are further apart [seconds]
+
+private:
+
+  struct Axis
+  {
+    double x[3];      // position, velocity, acceleration
+    double P[3][3];   // covariance
+  };
+
+  void start_axis(Axis& axis, double z) const;
+  void update_axis(Axis& axis, double dt, double z) const;
+
+  double jerk_psd;
+  double meas_var;
+
+  Axis axes[3];
+  int64_t last_stamp_ns = 0;
+  long n_updates = 0;
+};
+
+
+/////////////////// prediction of the control tick ///////////////////
+class TickPrediction
+{
+public:
+
+  // lookahead on top of the age of the newest sample in [ms]
+  explicit TickPrediction(double a_lookahead_ms) : lookahead_ms(a_lookahead_ms) {}
+
+  void update(int64_t stamp_ns, const std::vector<double>& offset) {predictor.update(stamp_ns, offset);}
+
+  // offset becomes the prediction for now_ns + lookahead_ms (the measured one is kept), false if there is none yet
+  bool apply(int64_t now_ns, std::vector<double>& offset);
+
+  // the measured offset back after the tick
+  void restore(std::vector<double>& offset) const {offset = measured_offset;}
+
+  // a new trial
+  void reset();
+
+  long n_predicted() const {return n;}
+  double mean_horizon_ms() const {return (n > 0) ? horizon_sum / n * 1e3 : 0.0;}
+
+  const double lookahead_ms;
+
+private:
+
+  InputPredictor predictor;
+  std::vector<double> measured_offset {0.0, 0.0, 0.0};
+  double horizon_sum = 0.0;
+  long n = 0;
+};
+
+#endif  // ROS2_PACKAGE__INPUT_PREDICTOR_HPP_
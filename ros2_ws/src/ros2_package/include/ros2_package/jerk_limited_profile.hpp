@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Time-optimal, jerk-limited ("double S") rest-to-rest
+//   profiles for the phase transitions of the controller
+//   (approach, control shifting, homing)
+//
+// - Multi-joint moves are planned along the straight line
+//   in joint space, as a normalized profile s(t) = [0, 1]
+//   under the tightest of the joints' limits, so all joints
+//   start and arrive together
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__JERK_LIMITED_PROFILE_HPP_
+#define ROS2_PACKAGE__JERK_LIMITED_PROFILE_HPP_
+
+#include <vector>
+
+
+// FR3 limits per joint (from the Franka datasheet)
+const std::vector<double> fr3_velocity_limits {2.62, 2.62, 2.62, 2.62, 5.26, 4.18, 5.26};   // [rad/s]
+const std::vector<double> fr3_acceleration_limits {10.0, 10.0, 10.0, 10.0, 10.0, 10.0, 10.0};   // [rad/s^2]
+const std::vector<double> fr3_jerk_limits {5000.0, 5000.0, 5000.0, 5000.0, 5000.0, 5000.0, 5000.0};   // [rad/s^3]
+
+// FR3 Cartesian translation limits of the end effector
+const double fr3_cartesian_velocity_limit = 3.0;   // [m/s]
+const double fr3_cartesian_acceleration_limit = 9.0;   // [m/s^2]
+const double fr3_cartesian_jerk_limit = 4500.0;   // [m/s^3]
+
+
+// fraction of the FR3 limits used for the transitions (the full limits are far too fast next to a participant)
+struct LimitScales
+{
+  double velocity = 0.2;
+  double acceleration = 0.1;
+  double jerk = 0.01;
+};
+
+
+/////////////// DEFINITION OF THE PROFILE CLASS //////////////
+
+class JerkLimitedProfile
+{
+public:
+
+  // plan the minimum-time move over distance (>= 0) starting and ending at rest
+  void plan(double distance, double v_max, double a_max, double j_max);
+
+  // position at time t after the start, held at the end points outside of [0, duration]
+  double position(double t) const;
+
+  double duration() const {return T;}
+  double distance() const {return h;}
+
+private:
+
+  // position during the acceleration phase (0 <= t <= Ta)
+  double accel_position(double t) const;
+
+  double h = 0.0;     // distance
+  double T = 0.0;     // total duration
+  double Ta = 0.0;    // acceleration (= deceleration) time
+  double Tv = 0.0;    // constant velocity time
+  double Tj = 0.0;    // constant jerk time in each jerk phase
+  double j_lim = 0.0;
+  double a_lim = 0.0;
+  double v_lim = 0.0;
+};
+
+
+// normalized profile s(t) = [0, 1] for the straight joint-space move q0 -> q1
+JerkLimitedProfile plan_joint_profile(const std::vector<double>& q0, const std::vector<double>& q1, const LimitScales& scales);
+
+// normalized profile s(t) = [0, 1] for a Cartesian move over distance [m]
+JerkLimitedProfile plan_cartesian_profile(double distance, const LimitScales& scales);
+
+#endif  // ROS2_PACKAGE__JERK_LIMITED_PROFILE_HPP_
@@ -0,0 +1,62 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Safety filter between the IK and the robot: every
+//   joint command is moved onto what the FR3 can follow
+//   from the previous commands, instead of being sent as-is
+//   (and the trial being thrown away once it is too far off)
+//
+// - Per joint and tick, from the previous command's
+//   velocity and acceleration:
+//   1. the next acceleration is bounded by the acceleration
+//      limit and by the jerk limit (change from the last one)
+//   2. the next velocity by the velocity limit, and by the
+//      speed it can still brake from before the soft position
+//      limits (the joint limits less a margin), so it slows
+//      down on its own instead of running into them (braking
+//      in whole ticks, after the jerk limit lets it turn around)
+//   3. the joint aims at the command along the way it can brake
+//      on, so a jump is caught up with and not overshot, while
+//      a feasible command comes out exactly as it went in
+//
+// - Fixed amount of work for the 7 joints, no allocation
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__JOINT_SAFETY_FILTER_HPP_
+#define ROS2_PACKAGE__JOINT_SAFETY_FILTER_HPP_
+
+#include <vector>
+
+
+class JointSafetyFilter
+{
+public:
+
+  // joint limits [rad] and the command period [seconds], the FR3 limits are scaled by limit_scale
+  JointSafetyFilter(const std::vector<double>& a_lower, const std::vector<double>& a_upper, double a_dt,
+                    double a_limit_scale = 0.9, double a_position_margin = 0.05);
+
+  // the next command starts from rest, as it is
+  void reset() {started = false;}
+
+  // moves q (in place) onto what can follow the previous command, returns the largest change of a joint [rad]
+  double apply(std::vector<double>& q);
+
+  const double dt;
+  const double limit_scale;
+  const double position_margin;   // [rad], inside the joint limits
+
+private:
+
+  std::vector<double> lower, upper;
+  std::vector<double> v_max, a_max, j_max;
+
+  bool started = false;
+  std::vector<double> q_prev, v_prev, a_prev;   // last filtered command and its velocity / acceleration
+  std::vector<double> target_prev;              // last command before the filter
+};
+
+#endif  // ROS2_PACKAGE__JOINT_SAFETY_FILTER_HPP_
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Fixed-bin latency histogram, cheap enough to fill on
+//   every controller tick (no allocation after construction)
+//
+// - 50 us bins up to 50 ms, anything above lands in the
+//   last bin (the max is kept exactly)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__LATENCY_HISTOGRAM_HPP_
+#define ROS2_PACKAGE__LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+
+class LatencyHistogram
+{
+public:
+
+  static const int n_bins = 1000;
+  static constexpr double bin_width_us = 50.0;
+
+  void add(double latency_us)
+  {
+    latency_us = std::max(latency_us, 0.0);
+    int bin = std::min((int) (latency_us / bin_width_us), n_bins - 1);
+    bins.at(bin)++;
+    n++;
+    sum_us += latency_us;
+    max_us = std::max(max_us, latency_us);
+  }
+
+  void reset()
+  {
+    bins.fill(0);
+    n = 0;
+    sum_us = 0.0;
+    max_us = 0.0;
+  }
+
+  // upper edge of the bin holding the p-th percentile (p = [0, 100]) in [microseconds]
+  double percentile(double p) const
+  {
+    if (n == 0) return 0.0;
+    int64_t target = (int64_t) (p / 100.0 * n);
+    int64_t seen = 0;
+    for (int i=0; i<n_bins; i++) {
+      seen += bins.at(i);
+      if (seen > target) return std::min((i + 1) * bin_width_us, max_us);
+    }
+    return max_us;
+  }
+
+  int64_t count() const {return n;}
+  double mean() const {return (n > 0) ? sum_us / n : 0.0;}
+  double max() const {return max_us;}
+
+private:
+
+  std::array<int64_t, n_bins> bins {};
+  int64_t n = 0;
+  double sum_us = 0.0;
+  double max_us = 0.0;
+};
+
+#endif  // ROS2_PACKAGE__LATENCY_HISTOGRAM_HPP_
@@ -0,0 +1,32 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Builders of the RViz markers shown by the
+//   MarkerPublisher (reference ball, tcp, countdown text
+//   and the reference trajectory line strip)
+//
+// - Kept out of the node so the offline tools and the
+//   benchmarks can build the same markers
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__MARKERS_HPP_
+#define ROS2_PACKAGE__MARKERS_HPP_
+
+#include <vector>
+
+#include "visualization_msgs/msg/marker.hpp"
+
+
+void generate_ref_ball(visualization_msgs::msg::Marker &ref_marker, double x, double y, double z, double d,
+                       visualization_msgs::msg::Marker &traj_marker);
+
+void generate_tcp_marker(visualization_msgs::msg::Marker &tcp_marker);
+visualization_msgs::msg::Marker generate_countdown(int count, std::vector<double> &center);
+
+void generate_traj_marker(visualization_msgs::msg::Marker &traj_marker, std::vector<double> &origin, int max_points,
+                          double pa, double pb, double pc, double ps, double ph, double height, double width, double depth, int use_depth);
+
+#endif  // ROS2_PACKAGE__MARKERS_HPP_
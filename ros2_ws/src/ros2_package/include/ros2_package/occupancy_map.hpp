@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Occupancy map of the workspace from the camera cloud,
+//   so the controller can keep its TCP targets out of the
+//   table and whatever else is in the way
+//
+// - Voxel grid over the crop box of the CloudPreprocessor,
+//   with a clamped log-odds value per voxel. Each cloud is
+//   integrated on a background thread: the voxels between
+//   the camera and a point are seen free, the one holding
+//   the point occupied, and whatever the camera does not see
+//   keeps its last state. Points on the robot itself (given
+//   as spheres around its links) are left out
+//
+// - After every cloud the worker inflates the occupied voxels
+//   by the clearance and publishes the result as a read-only
+//   snapshot. Snapshots live in a pool of three buffers: a
+//   reader takes the published one and only pins it with a
+//   counter, the worker only writes a buffer nobody is pinning
+//   (and skips publishing otherwise), so the control tick never
+//   waits for the worker and the worker never waits for it
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__OCCUPANCY_MAP_HPP_
+#define ROS2_PACKAGE__OCCUPANCY_MAP_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class OccupancyMap
+{
+public:
+
+  // box [lower, upper) in the robot frame, voxel_size and clearance in [m]
+  OccupancyMap(const double a_lower[3], const double a_upper[3], double a_voxel_size, double a_clearance);
+  ~OccupancyMap();
+
+  OccupancyMap(const OccupancyMap &) = delete;
+  OccupancyMap & operator=(const OccupancyMap &) = delete;
+
+  // hand over the newest cloud {x0, y0, z0, x1, ...} in the robot frame, seen from sensor, without the points
+  // inside the self spheres {x, y, z, radius, ...} (never called from the control tick, replaces a pending cloud)
+  void submit(const std::vector<float>& points, const double sensor[3], const std::vector<double>& self_spheres);
+
+  ///////// control tick (lock-free, fixed cost) /////////
+
+  // p is occupied or closer than the clearance to something that is (false while there is no snapshot yet)
+  bool blocked(const double p[3]) const;
+
+  // keeps target out of the blocked space: if the way from "from" (which should be free) runs into it, target is
+  // moved back to the last free point on that way, or to "from" itself if that is blocked too. true if it moved
+  bool clamp(const std::vector<double>& from, std::vector<double>& target) const;
+
+  ///////// statistics /////////
+  long n_snapshots() const {return snapshots.load(std::memory_order_relaxed);}
+  long n_skipped() const {return skipped.load(std::memory_order_relaxed);}
+  double mean_integration_ms() const;
+  int n_occupied() const;
+
+  const double voxel_size;
+  const double clearance;
+
+private:
+
+  static const int n_buffers = 3;
+
+  struct Snapshot
+  {
+    std::vector<uint8_t> blocked;    // inflated occupancy, one byte per voxel
+    int n_occupied = 0;
+  };
+
+  void worker_loop();
+  void integrate(const std::vector<float>& points, const double sensor[3], const std::vector<double>& self_spheres);
+  void publish();
+
+  // -1 outside the grid
+  long voxel_of(const double p[3]) const;
+  bool blocked_in(const Snapshot & snapshot, const double p[3]) const;
+
+  // pin / unpin the published snapshot, -1 if there is none
+  int acquire() const;
+  void release(int b) const;
+
+  double lower[3];
+  int dims[3];
+  long n_voxels;
+  int inflation;    // clearance in voxels
+
+  // the map itself, only touched by the worker
+  std::vector<int8_t> log_odds;
+  std::vector<uint8_t> dilate_tmp;
+
+  // snapshot pool
+  Snapshot buffers[n_buffers];
+  std::atomic<int> published {-1};
+  mutable std::atomic<int> readers[n_buffers];
+
+  // hand-over of the newest cloud to the worker
+  std::mutex pending_mutex;
+  std::condition_variable pending_cv;
+  bool has_pending = false;
+  bool stop = false;
+  std::vector<float> pending_points;
+  double pending_sensor[3];
+  std::vector<double> pending_spheres;
+  std::thread worker;
+
+  std::atomic<long> snapshots {0};
+  std::atomic<long> skipped {0};
+  std::atomic<double> integration_ms_sum {0.0};
+};
+
+#endif  // ROS2_PACKAGE__OCCUPANCY_MAP_HPP_
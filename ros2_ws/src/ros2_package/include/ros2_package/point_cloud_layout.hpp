@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Layout checks of incoming PointCloud2 messages, before
+//   their data is read as raw float32 x, y, z (the
+//   CloudPreprocessor and the controllers' collision map)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__POINT_CLOUD_LAYOUT_HPP_
+#define ROS2_PACKAGE__POINT_CLOUD_LAYOUT_HPP_
+
+#include <cstddef>
+
+#include "sensor_msgs/msg/point_cloud2.hpp"
+#include "sensor_msgs/msg/point_field.hpp"
+
+
+// offset of x if x, y, z are consecutive float32 fields, -1 otherwise
+inline int xyz_offset(const sensor_msgs::msg::PointCloud2 & msg)
+{
+  const char* names[3] = {"x", "y", "z"};
+  int offsets[3] = {-1, -1, -1};
+  for (const auto & field : msg.fields) {
+    for (int j=0; j<3; j++) {
+      if (field.name == names[j] && field.datatype == sensor_msgs::msg::PointField::FLOAT32) offsets[j] = field.offset;
+    }
+  }
+  if (offsets[0] < 0 || offsets[1] != offsets[0] + 4 || offsets[2] != offsets[0] + 8) return -1;
+  if (offsets[2] + 4 > (int) msg.point_step) return -1;
+  return offsets[0];
+}
+
+// offset of x if all width x height points can be read as little-endian float32 x, y, z at every point_step
+// (rows without padding, and as much data as that says), -1 otherwise
+inline int packed_xyz_offset(const sensor_msgs::msg::PointCloud2 & msg)
+{
+  int x_offset = xyz_offset(msg);
+  if (x_offset < 0 || msg.is_bigendian) return -1;
+  if (msg.row_step != msg.width * msg.point_step) return -1;
+  if (msg.data.size() < (std::size_t) msg.row_step * msg.height) return -1;
+  return x_offset;
+}
+
+#endif  // ROS2_PACKAGE__POINT_CLOUD_LAYOUT_HPP_
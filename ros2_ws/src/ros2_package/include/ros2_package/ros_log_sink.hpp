@@ -0,0 +1,31 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Forwards the AsyncLogger messages to the ROS logging
+//   (console + ~/.ros/log), called once from a node's main
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__ROS_LOG_SINK_HPP_
+#define ROS2_PACKAGE__ROS_LOG_SINK_HPP_
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "ros2_package/async_logger.hpp"
+
+
+inline void use_ros_log_sink(const rclcpp::Logger & logger)
+{
+  AsyncLogger::instance().set_sink([logger](LogLevel level, const char* message) {
+    switch (level) {
+      case LogLevel::DEBUG: RCLCPP_DEBUG(logger, "%s", message); break;
+      case LogLevel::INFO: RCLCPP_INFO(logger, "%s", message); break;
+      case LogLevel::WARN: RCLCPP_WARN(logger, "%s", message); break;
+      case LogLevel::ERROR: RCLCPP_ERROR(logger, "%s", message); break;
+    }
+  });
+}
+
+#endif  // ROS2_PACKAGE__ROS_LOG_SINK_HPP_
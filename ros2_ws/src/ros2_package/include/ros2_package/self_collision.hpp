@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Self-collision check of the Panda for the controller
+//   tick, on capsules instead of the link meshes (the
+//   cylinder + two spheres of each link in franka_description,
+//   i.e. a segment and a radius per capsule)
+//
+// - Only the link pairs at least three joints apart are
+//   checked, the closer ones touch at their joints anyway
+//
+// - One check = the capsules moved into the base frame with
+//   the segment frames of the FK, then one plain loop over
+//   all the capsule pairs (closest points of two segments,
+//   clamped, no branches, the compiler vectorizes it), so it
+//   costs a couple of microseconds and never allocates
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__SELF_COLLISION_HPP_
+#define ROS2_PACKAGE__SELF_COLLISION_HPP_
+
+#include <string>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/frames.hpp>
+
+
+class SelfCollision
+{
+public:
+
+  // attaches the capsules to the segments of chain by link name (the root link is the base frame)
+  explicit SelfCollision(const KDL::Chain & chain);
+
+  // smallest distance between the surfaces of the checked capsules [m], negative if two of them overlap.
+  // frames: one per segment of the chain, as from ChainFkSolverPos_recursive::JntToCart(q, frames)
+  double min_distance(const std::vector<KDL::Frame>& frames);
+
+  // the two links behind the last min_distance()
+  std::string closest_pair() const;
+
+  int n_pairs() const {return (int) pair_a.size();}
+
+private:
+
+  struct Capsule
+  {
+    const char* name;   // of its link
+    int segment;        // -1 for the root link
+    int link;           // 0 = panda_link0 ... 8 = panda_hand
+    KDL::Vector a, b;   // segment ends in the link frame
+    double radius;
+  };
+
+  std::vector<Capsule> capsules;
+  std::vector<int> pair_a, pair_b;    // capsule indices
+
+  static const int max_pairs = 64;
+
+  // capsule ends in the base frame, and the pairs laid out for the distance loop (one array per coordinate)
+  std::vector<KDL::Vector> world_a, world_b;
+  double p1x[max_pairs], p1y[max_pairs], p1z[max_pairs], d1x[max_pairs], d1y[max_pairs], d1z[max_pairs];
+  double p2x[max_pairs], p2y[max_pairs], p2z[max_pairs], d2x[max_pairs], d2y[max_pairs], d2z[max_pairs];
+  double radius_sum[max_pairs], distance[max_pairs];
+  int closest = -1;
+};
+
+#endif  // ROS2_PACKAGE__SELF_COLLISION_HPP_
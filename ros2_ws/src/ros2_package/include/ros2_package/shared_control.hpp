@@ -0,0 +1,396 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Declaration of the SharedControlCore class, the
+//   ROS-free control logic of the RealController
+//
+// - Main functionalities:
+//   1. Reference trajectory + noisy robot target
+//   2. Convex combination of human and robot input
+//   3. Inverse kinematics on a per-instance KDL chain,
+//      with every solution checked for self-collision
+//      (self_collision.hpp) and its distance to a singularity
+//      (manipulability, smallest singular value), optionally
+//      taking human authority away close to one
+//   4. A safety filter on every command (velocity, acceleration
+//      and jerk limits, soft joint limits), which only gives
+//      up on the trial if the commands stay infeasible
+//   5. The trial phase machine (prep -> smoothing ->
+//      recording -> shifting -> homing)
+//
+// - Everything lives inside the instance, so any number
+//   of cores can run side by side (e.g. sweep workers)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__SHARED_CONTROL_HPP_
+#define ROS2_PACKAGE__SHARED_CONTROL_HPP_
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainiksolverpos_nr.hpp>
+#include <kdl/chainiksolvervel_pinv.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/tree.hpp>
+
+#include "ros2_package/jerk_limited_profile.hpp"
+#include "ros2_package/joint_safety_filter.hpp"
+#include "ros2_package/self_collision.hpp"
+
+class OccupancyMap;
+
+
+/////////////////// constants shared by all controllers ///////////////////
+// the URDF installed with the package (set by CMake), the nodes and tools take another one as an argument
+#ifndef ROS2_PACKAGE_URDF
+#define ROS2_PACKAGE_URDF "urdf/panda.urdf"
+#endif
+const std::string urdf_path = ROS2_PACKAGE_URDF;
+const std::string noise_csv_dir = "/home/michael/HRI/ros2_ws/src/cpp_pubsub/robot_noise/noise_csv_files/";
+const unsigned int n_joints = 7;
+
+const std::vector<double> lower_joint_limits {-2.8973, -1.7628, -2.8973, -3.0718, -2.8973, -0.0175, -2.8973};
+const std::vector<double> upper_joint_limits {2.8973, 1.7628, 2.8973, -0.0698, 2.8973, 3.7525, 2.8973};
+
+// home joint values
+const std::vector<double> home_joint_vals {0, -M_PI_4/2, 0, -5 * M_PI_4/2, 0, M_PI_2, M_PI_4};
+
+// alpha values = amount of HUMAN INPUT, indexed by alpha_id
+const std::vector< std::vector<double> > alphas_dict {
+  {0.0, 0.0, 0.0},  // 0
+  {0.2, 0.2, 0.2},  // 1
+  {0.4, 0.4, 0.4},  // 2
+  {0.6, 0.6, 0.6},  // 3
+  {0.8, 0.8, 0.8},  // 4
+  {1.0, 1.0, 1.0}   // 5
+};
+
+// size of the sine curve envelope in [meters]
+const double traj_depth = 0.1;
+const double traj_width = 0.3;
+const double traj_height = 0.1;
+
+
+/////////////////// sine curve parameters of each traj_id ///////////////////
+struct SineParams
+{
+  int a;
+  int b;
+  int c;
+  double s;
+  double h;
+};
+
+const int n_traj_ids = 6;   // traj_id is in [0, n_traj_ids), KEEP CONSISTENT WITH get_sine_params()
+
+SineParams get_sine_params(int traj_id);
+
+// reference offset from the task-space origin at t = [0, 2pi]
+void get_reference_offset(double t, const SineParams& sp, int use_depth, std::vector<double>& ref);
+
+
+/////////////////// what happened during one controller tick ///////////////////
+struct TickOutput
+{
+  bool publish_command = false;   // message_joint_vals should be sent to the robot
+  bool publish_tcp = false;       // a tcp_position sample is due (recording phase only)
+  bool last_point = false;        // ... and it is one of the last ones of the trajectory
+  double time_from_start = 0.0;   // time stamp of that sample, out of 10 seconds
+
+  bool record_started = false;
+  bool record_stopped = false;
+
+  int prep_count = -1;            // prep counter while waiting to take control, -1 once controlling
+  bool warmup_started = false;    // the joints have settled (or the prep ran out), holding initial_joint_vals from now on
+  bool control_started = false;   // the warm-up is over, this is the first controlled tick
+  int countdown = -1;             // whole seconds, smoothing_time at the start of recording, -1 if not a whole second
+
+  int noise_idx = -1;             // index into the noise vector used this tick, -1 outside recording
+  double noise = 0.0;
+
+  bool holding = false;           // an input is stale: the command coasts to a stop and the trial clock is paused
+  bool finished = false;          // the trial is over (robot homed and settled)
+  bool limits_violated = false;   // the commands have been outside the joint limits (or far from feasible) for escalation_time
+
+  double safety_deviation = 0.0;  // largest change of a joint by the safety filter this tick [rad]
+  bool safety_intervened = false; // ... it changed the command at all
+  bool tcp_clamped = false;       // tcp_pos was moved back out of an obstacle of the occupancy map
+
+  double manipulability = 0.0;       // of this tick's IK solution (0 before control)
+  double min_singular_value = 0.0;
+
+  double self_distance = 1e9;     // smallest distance between the link capsules at this tick's IK solution [m]
+  bool self_collision = false;    // ... was below self_collision_margin, so the last clear solution was kept
+};
+
+
+/////////////// DEFINITION OF THE CONTROL CORE CLASS //////////////
+
+// the pinv velocity solver, counting its calls (one per iteration of the Newton-Raphson position solver)
+class CountingIkSolverVel : public KDL::ChainIkSolverVel_pinv
+{
+public:
+  using KDL::ChainIkSolverVel_pinv::ChainIkSolverVel_pinv;
+  using KDL::ChainIkSolverVel_pinv::CartToJnt;
+
+  int CartToJnt(const KDL::JntArray& q_in, const KDL::Twist& v_in, KDL::JntArray& qdot_out) override
+  {
+    calls++;
+    return KDL::ChainIkSolverVel_pinv::CartToJnt(q_in, v_in, qdot_out);
+  }
+
+  long calls = 0;
+};
+
+class SharedControlCore
+{
+public:
+
+  // experimental conditions
+  int alpha_id {0};
+  int traj_id {0};
+  int use_depth {0};
+  double mapping_ratio {3.0};
+  double noise_scale {1.0};   // multiplies the robot noise (1.0 = as in the experiment)
+
+  std::vector<double> origin {0.5059, 0.0, 0.4346}; //////// can change the task-space origin point! ////////
+
+  std::vector<double> human_offset {0.0, 0.0, 0.0};
+  std::vector<double> ref_offset {0.0, 0.0, 0.0};
+  std::vector<double> robot_offset {0.0, 0.0, 0.0};
+
+  std::vector<double> tcp_pos {0.5059, 0.0, 0.4346};   // initialized the same as the "home" position
+
+  // obstacles to keep tcp_pos out of (owned by the node, none = no check), and the last tcp_pos it was checked from
+  const OccupancyMap* occupancy = nullptr;
+  std::vector<double> previous_tcp {0.5059, 0.0, 0.4346};
+
+  std::vector<double> curr_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  std::vector<double> ik_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  std::vector<double> message_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  bool control = false;
+
+  const int control_freq;   // the rate at which tick() is called in [Hz]
+  const int tcp_pub_frequency = 40;   // in [Hz]
+
+  // step 1: prep-time
+  const int prep_time = 5;    // seconds
+  const int max_prep_count;
+  int prep_count = 0;
+
+  std::vector<double> initial_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  const int required_initial_vals;   // get initial joint values for 3 seconds
+  int initial_joint_vals_count = 0;
+
+  // the prep ends early once the joints have settled (followed by the wait-set warm-up)
+  const double settle_tolerance = 0.005;   // [rad]
+  const int required_settled_count;
+  int settled_count = 0;
+  std::vector<double> settle_anchor {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+  const int warmup_time = 2;    // seconds
+  const int warmup_ticks;
+  int warmup_start = -1;
+
+  // step 2: smoothing -> used to initially smoothly incorporate the Falcon offset
+  const int smoothing_time = 5;   /// minimum smoothing time in [seconds], recording never starts earlier
+                                  /// (the jerk-limited approach takes as long as it needs, a long one can go past it)
+  const int max_smoothing_count;
+  const int float_time = 2;     // time to float at starting position [seconds]
+  int approach_ticks;
+  int recording_start;          // count at which recording starts (approach + float, at least max_smoothing_count), known after the first control tick
+
+  // IMPORTANT: BIG BOSS COUNTER HERE
+  int count = 0;
+
+  // alpha values = amount of HUMAN INPUT, in the range [0, 1]
+  double ax = 0.0;
+  double ay = 0.0;
+  double az = 0.0;
+
+  // initial alpha values (from experimental setting)
+  double iax = 0.0;
+  double iay = 0.0;
+  double iaz = 0.0;
+
+  // trajectory recording
+  const int traj_duration = 10;   // in [seconds]
+  const int max_recording_count;
+  bool record_flag = false;
+
+  // for robot trajectory following
+  double t_param = 0.0;
+  SineParams sine {1, 1, 4, M_PI, 0.25};
+
+  // for gradually shifting control to robot after 10 second trajectory
+  const int shifting_time = 3;   // seconds, until the shifting is planned
+  const int max_shifting_count;
+  int shifting_ticks;
+
+  // for moving to home after trajectory finishes
+  std::vector<double> final_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+  // for gradually homing the robot after the 3-second shifting
+  const int homing_time = 2;    // seconds, until the homing is planned
+  const int max_homing_count;
+  int homing_ticks;
+
+  // wait at most 1 second for the robot to settle at home before finishing the trial
+  const int shutdown_time = 1;    // second
+  const int max_shutdown_count;
+  bool trial_done = false;
+
+  // jerk-limited transitions (approach, control shifting, homing) under the scaled FR3 limits
+  LimitScales transition_scales;
+  JerkLimitedProfile approach_profile;
+  JerkLimitedProfile shift_profile;
+  JerkLimitedProfile homing_profile;
+
+  // smooth hold while an input is stale (see hold_tick), then a blend back into the controlled command
+  const double hold_time_constant = 0.05;   // decay of the command velocity while holding [seconds]
+  const double resume_time = 0.25;          // [seconds]
+  const int resume_ticks;
+  int resume_count = 0;
+  std::vector<double> command_velocity {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};   // change of message_joint_vals per tick
+  std::vector<double> previous_command {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  std::vector<double> hold_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+  // every command goes through the safety filter (FR3 limits, soft joint limits), and the trial is only
+  // given up once the commands are outside the joint limits or max_safety_deviation off for escalation_time
+  const double safety_tolerance = 1e-6;       // [rad], smaller changes do not count as an intervention
+  const double max_safety_deviation = 0.1;    // [rad]
+  const double escalation_time = 0.5;         // [seconds]
+  const int escalation_ticks;
+  int safety_violation_count = 0;
+  JointSafetyFilter safety_filter;
+
+  // robot noise, interpolated to one value per recording tick
+  std::vector<double> robot_noise_vector;
+
+  // duration of the last compute_ik() call in [microseconds], its KDL error code (negative if it did not converge)
+  // and its Newton-Raphson iterations
+  double ik_time_us = 0.0;
+  int ik_error = 0;
+  int ik_iterations = 0;
+
+  // conditioning of the last IK solution (6 x 7 Jacobian, Yoshikawa manipulability and smallest singular value)
+  double manipulability = 0.0;
+  double min_singular_value = 0.0;
+
+  // near a singularity the human authority (ax, ay, az) is scaled down, from all of it at sigma_high to none at sigma_low
+  int singularity_scaling {0};
+  const double sigma_low = 0.02;
+  const double sigma_high = 0.06;
+  double authority_scale = 1.0;
+
+  // IK solutions closer than this to a self-collision are not used [m]
+  const double self_collision_margin = 0.01;
+  std::vector<double> clear_ik_joint_vals {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};   // the last one that was clear
+
+
+  SharedControlCore(const KDL::Chain & chain, int a_control_freq = 500);
+
+  // the solvers keep references to this instance's chain, so the core stays where it was built
+  SharedControlCore(const SharedControlCore &) = delete;
+  SharedControlCore & operator=(const SharedControlCore &) = delete;
+
+  // reset all counters and apply new experimental conditions
+  void start_trial(int a_alpha_id, int a_traj_id, int a_use_depth, double a_mapping_ratio);
+
+  // skip the prep phase (e.g. for a simulated plant that is already settled at initial_joint_vals)
+  void skip_prep();
+
+  // inputs
+  void set_falcon_position(double x, double y, double z);   // in [cm], as published by the PositionTalker
+  void set_joint_state(const std::vector<double>& q);
+
+  // one control step, called at control_freq
+  TickOutput tick();
+
+  // instead of tick() while an input is stale: keeps commanding, but decays the last command velocity
+  // to zero and does not advance the trial (before control starts it is the same as tick())
+  TickOutput hold_tick();
+
+  // kinematics on this instance's chain
+  void compute_ik(const std::vector<double>& desired_tcp_pos, const std::vector<double>& curr_vals, std::vector<double>& res_vals);
+  void compute_fk(const std::vector<double>& joint_vals, std::vector<double>& res_tcp_pos);
+
+  // origins of all segment frames of the chain (base to tcp) as {x0, y0, z0, x1, ...}
+  void compute_link_positions(const std::vector<double>& joint_vals, std::vector<double>& res_positions);
+
+  // smallest distance between the link capsules at joint_vals [m] (negative = in self-collision), and the two closest links
+  double self_distance(const std::vector<double>& joint_vals);
+
+  // manipulability and min_singular_value at joint_vals
+  void compute_conditioning(const std::vector<double>& joint_vals);
+  std::string closest_links() const {return self_collision_->closest_pair();}
+
+  // total number of ticks of a trial once control has started (an upper bound until homing is planned)
+  int trial_length() const;
+
+  // phase boundaries in ticks since control started
+  int recording_end() const {return recording_start + max_recording_count;}
+  int shifting_end() const {return recording_end() + shifting_ticks;}
+  int homing_end() const {return shifting_end() + homing_ticks;}
+
+  // name of the current phase (prep, smoothing, recording, shifting, homing, settling) and progress through the trial in [0, 1]
+  std::string phase() const;
+  double progress() const;
+
+  // reference and noisy robot target (ref_offset, robot_offset) at t = [0, 2pi] of the current count
+  void get_robot_control(double t);
+
+  // message_joint_vals through the safety filter, and the escalation to limits_violated
+  void filter_command(TickOutput& out);
+
+private:
+
+  KDL::Chain panda_chain;
+  std::unique_ptr<KDL::ChainFkSolverPos_recursive> fk_solver_;
+  std::unique_ptr<CountingIkSolverVel> vel_ik_solver_;
+  std::unique_ptr<KDL::ChainIkSolverPos_NR> ik_solver_;
+  KDL::JntArray jnt_pos_start_;
+  KDL::JntArray jnt_pos_goal_;
+
+  // all segment frames of one configuration, for the link positions and the self-collision check
+  std::unique_ptr<SelfCollision> self_collision_;
+  KDL::JntArray jnt_pos_links_;
+  std::vector<KDL::Frame> link_frames_;
+
+  // Jacobian of the IK solution, for its conditioning
+  std::unique_ptr<KDL::ChainJntToJacSolver> jac_solver_;
+  KDL::Jacobian jacobian_;
+
+  KDL::Rotation orientation;
+  bool got_orientation = false;
+
+};
+
+
+/////////////////// helper functions ///////////////////
+bool create_tree(const std::string& path, KDL::Tree& tree);
+void get_chain(const KDL::Tree& tree, KDL::Chain& chain);
+
+bool within_limits(const std::vector<double>& vals);
+double joint_limit_margin(const std::vector<double>& vals);
+
+void readCSV(const std::string& filename, std::vector<double>& dataArray);
+double linearInterpolate(double y1, double y2, double mu);
+double cosineInterpolate(double y1, double y2, double mu);
+std::vector<double> linear_interpolate_vec(std::vector<double> old_vec, int num_interp);
+std::vector<double> cosine_interpolate_vec(std::vector<double> old_vec, int num_interp);
+
+// reads a noise csv (in noise_csv_dir) and interpolates it to one value per recording tick
+std::vector<double> generate_noise_vector(const std::string& filename);
+
+#endif  // ROS2_PACKAGE__SHARED_CONTROL_HPP_
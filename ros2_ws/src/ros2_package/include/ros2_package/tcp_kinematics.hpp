@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Forward kinematics of the TCP for the measured-pose
+//   stream (TcpStatePublisher), fast enough to run on every
+//   1 kHz joint state message
+//
+// - Made once from the KDL chain: the fixed segments are
+//   folded into the joint frames around them, so what is
+//   left is one constant frame and one axis per joint and
+//   the tool frame after the last one, in plain arrays
+//
+// - One call = 7 rotations about the joint axes chained
+//   together, plus the TCP velocity from the same pass
+//   (the Jacobian columns z_i x (p_tcp - p_i) and z_i times
+//   the joint velocities, without building the Jacobian).
+//   No allocation, no virtual calls, no KDL types
+//
+// - Revolute and fixed joints only (all the Panda has)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TCP_KINEMATICS_HPP_
+#define ROS2_PACKAGE__TCP_KINEMATICS_HPP_
+
+#include <string>
+#include <vector>
+
+#include <kdl/chain.hpp>
+
+
+class TcpKinematics
+{
+public:
+
+  static const int max_joints = 7;
+
+  // from the root of chain to its tip (the TCP), false from ok() if the chain has other joints or too many of them
+  explicit TcpKinematics(const KDL::Chain & chain);
+
+  bool ok() const {return valid;}
+  int n_joints() const {return n;}
+  const std::vector<std::string>& joint_names() const {return names;}
+
+  // q: joint positions, qdot: joint velocities (nullptr = zero velocity), both in the chain's joint order
+  void compute(const double* q, const double* qdot);
+
+  // result of the last compute(), in the root frame of the chain
+  double position[3];
+  double orientation[4];         // quaternion x, y, z, w
+  double velocity[3];            // [m/s]
+  double angular_velocity[3];    // [rad/s]
+
+private:
+
+  int n = 0;
+  bool valid = true;
+  std::vector<std::string> names;
+
+  // per joint: frame of the joint at q = 0 relative to the previous joint (rotation row-major) and its axis in there
+  double joint_rotation[max_joints][9];
+  double joint_position[max_joints][3];
+  double joint_axis[max_joints][3];
+
+  // TCP relative to the last joint
+  double tool_rotation[9];
+  double tool_position[3];
+};
+
+#endif  // ROS2_PACKAGE__TCP_KINEMATICS_HPP_
@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Command line parsing of the offline tools
+//   (sweep_simulator, ik_stress, reachability_map):
+//   "--key value" pairs, lists as comma-separated values
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TOOL_ARGS_HPP_
+#define ROS2_PACKAGE__TOOL_ARGS_HPP_
+
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// "1,2,3" -> {1, 2, 3}
+template <typename T>
+std::vector<T> parse_list(const std::string& arg)
+{
+  std::vector<T> vals;
+  std::stringstream ss(arg);
+  std::string value;
+  while (getline(ss, value, ',')) {
+    std::stringstream vs(value);
+    T v;
+    vs >> v;
+    vals.push_back(v);
+  }
+  return vals;
+}
+
+// hands every "--key value" pair of argv to set_arg, which returns false for a key it does not know.
+// false (after printing why) on an unknown key or a key without a value
+bool parse_key_values(int argc, char * argv[], const std::function<bool(const std::string&, const std::string&)>& set_arg);
+
+// false (after printing why) if one of the ids of the "--key" list is not in [0, n_ids)
+bool check_ids(const std::string& key, const std::vector<int>& ids, int n_ids);
+
+#endif  // ROS2_PACKAGE__TOOL_ARGS_HPP_
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - LTTng-UST tracepoint provider "ros2_package", only
+//   compiled with -DROS2_PACKAGE_TRACING=ON (use the macros
+//   of tracing.hpp instead of including this directly)
+//
+// - stamp_ns is the device-read time of the Falcon sample
+//   an event belongs to (0 if none), which is what the
+//   analysis (scripts/trace_analysis.py) joins the events on
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER ros2_package
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "ros2_package/tp_provider.h"
+
+#if !defined(ROS2_PACKAGE__TP_PROVIDER_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define ROS2_PACKAGE__TP_PROVIDER_H_
+
+#include <stdint.h>
+#include <lttng/tracepoint.h>
+
+
+// PositionTalker: position read from the Falcon / published
+TRACEPOINT_EVENT(ros2_package, device_read,
+  TP_ARGS(int64_t, stamp_ns),
+  TP_FIELDS(ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+TRACEPOINT_EVENT(ros2_package, falcon_publish,
+  TP_ARGS(int64_t, stamp_ns),
+  TP_FIELDS(ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+// entry / exit of a subscription or timer callback
+TRACEPOINT_EVENT(ros2_package, callback_start,
+  TP_ARGS(const char *, callback, int64_t, stamp_ns),
+  TP_FIELDS(ctf_string(callback, callback) ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+TRACEPOINT_EVENT(ros2_package, callback_end,
+  TP_ARGS(const char *, callback),
+  TP_FIELDS(ctf_string(callback, callback)))
+
+// SharedControlCore::compute_ik()
+TRACEPOINT_EVENT(ros2_package, ik_start,
+  TP_ARGS(int, dummy),
+  TP_FIELDS(ctf_integer(int, dummy, dummy)))
+
+TRACEPOINT_EVENT(ros2_package, ik_end,
+  TP_ARGS(int, error),
+  TP_FIELDS(ctf_integer(int, error, error)))
+
+// controller outputs / MarkerPublisher output
+TRACEPOINT_EVENT(ros2_package, command_publish,
+  TP_ARGS(int64_t, stamp_ns),
+  TP_FIELDS(ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+TRACEPOINT_EVENT(ros2_package, tcp_publish,
+  TP_ARGS(int64_t, stamp_ns),
+  TP_FIELDS(ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+TRACEPOINT_EVENT(ros2_package, marker_publish,
+  TP_ARGS(int64_t, stamp_ns),
+  TP_FIELDS(ctf_integer(int64_t, stamp_ns, stamp_ns)))
+
+#endif  // ROS2_PACKAGE__TP_PROVIDER_H_
+
+#include <lttng/tracepoint-event.h>
@@ -0,0 +1,62 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Static tracepoints of the nodes, recorded with LTTng
+//   next to the rclcpp instrumentation of ros2_tracing:
+//     ros2 trace -u 'ros2_package:*' 'ros2:*'
+//   and analysed offline by scripts/trace_analysis.py
+//
+// - Built with -DROS2_PACKAGE_TRACING=ON, the macros are
+//   LTTng-UST tracepoints (a predicted branch while no session
+//   records them). Otherwise they compile to nothing at all
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TRACING_HPP_
+#define ROS2_PACKAGE__TRACING_HPP_
+
+#include <cstdint>
+
+#ifdef ROS2_PACKAGE_TRACING
+
+#include "ros2_package/tp_provider.h"
+
+#define TRACE_DEVICE_READ(stamp_ns) tracepoint(ros2_package, device_read, (int64_t) (stamp_ns))
+#define TRACE_FALCON_PUBLISH(stamp_ns) tracepoint(ros2_package, falcon_publish, (int64_t) (stamp_ns))
+#define TRACE_IK_START() tracepoint(ros2_package, ik_start, 0)
+#define TRACE_IK_END(error) tracepoint(ros2_package, ik_end, (int) (error))
+#define TRACE_COMMAND_PUBLISH(stamp_ns) tracepoint(ros2_package, command_publish, (int64_t) (stamp_ns))
+#define TRACE_TCP_PUBLISH(stamp_ns) tracepoint(ros2_package, tcp_publish, (int64_t) (stamp_ns))
+#define TRACE_MARKER_PUBLISH(stamp_ns) tracepoint(ros2_package, marker_publish, (int64_t) (stamp_ns))
+
+// callback_start now, callback_end when the enclosing scope is left (whichever return it takes)
+struct TraceCallbackScope
+{
+  const char* callback;
+  TraceCallbackScope(const char* a_callback, int64_t stamp_ns) : callback(a_callback)
+  {
+    tracepoint(ros2_package, callback_start, callback, stamp_ns);
+  }
+  ~TraceCallbackScope()
+  {
+    tracepoint(ros2_package, callback_end, callback);
+  }
+};
+#define TRACE_CALLBACK_SCOPE(callback, stamp_ns) TraceCallbackScope trace_callback_scope_(callback, (int64_t) (stamp_ns))
+
+#else
+
+#define TRACE_DEVICE_READ(stamp_ns) ((void) 0)
+#define TRACE_FALCON_PUBLISH(stamp_ns) ((void) 0)
+#define TRACE_IK_START() ((void) 0)
+#define TRACE_IK_END(error) ((void) (error))   // the IK error code is only kept for the tracepoint
+#define TRACE_COMMAND_PUBLISH(stamp_ns) ((void) 0)
+#define TRACE_TCP_PUBLISH(stamp_ns) ((void) 0)
+#define TRACE_MARKER_PUBLISH(stamp_ns) ((void) 0)
+#define TRACE_CALLBACK_SCOPE(callback, stamp_ns) ((void) 0)
+
+#endif  // ROS2_PACKAGE_TRACING
+
+#endif  // ROS2_PACKAGE__TRACING_HPP_
@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Reading of the recorded trials in csv_logs, used by
+//   the offline tools (replay, sweeps) to drive the
+//   controller with real human input
+//
+// - Human model of the offline tools (sweep_simulator,
+//   ik_stress): the hand-space error of a recorded trial,
+//   (human - ref) / recorded_ratio, put on top of the
+//   reference and scaled by the mapping_ratio of a run
+//
+// - Two trial layouts exist (see DataLogger.log_data()):
+//   20 columns (older trials): human[0:3], ref[3:6], tcp[6:9], ..., time_from_start[17], time, datetime
+//   27 columns (noisy robot):  ref[0:3], human[3:6], robot[6:9], tcp[9:12], ..., time_from_start[24], time, datetime
+//   30 columns (measured tcp): the 27 ones, then the measured tcp[27:30]
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TRIAL_LOG_HPP_
+#define ROS2_PACKAGE__TRIAL_LOG_HPP_
+
+#include <string>
+#include <vector>
+
+
+// one recorded trial (one sample per tcp_position message, i.e. at 40 Hz)
+struct TrialLog
+{
+  std::vector<double> times;   // time_from_start in [seconds]
+  std::vector< std::vector<double> > ref_pos;
+  std::vector< std::vector<double> > human_pos;
+  std::vector< std::vector<double> > tcp_pos;
+  std::vector< std::vector<double> > measured_pos;   // empty for the older layouts
+};
+
+// a trial file together with its experimental conditions from the participant's header file
+struct TrialInfo
+{
+  std::string file;
+  int part_id;
+  int trial_number;
+  int alpha_id;
+  int traj_id;
+};
+
+bool load_trial_log(const std::string& filename, TrialLog& log);
+
+// all partX/trialY.csv files below csv_dir that have a row in partX_header.csv
+std::vector<TrialInfo> find_trial_logs(const std::string& csv_dir);
+
+// linear interpolation of a logged position at time t (held constant outside of the log)
+void interpolate_log(const std::vector<double>& times, const std::vector< std::vector<double> >& pos,
+                     double t, std::vector<double>& res);
+
+// hand-space error of one recorded trial, sampled at the log times
+struct HumanModel
+{
+  std::vector<double> times;
+  std::vector< std::vector<double> > hand_err;
+};
+
+// the first max_humans recorded trials of traj_id below csv_dir (none if csv_dir is empty),
+// recorded with a mapping_ratio of recorded_ratio
+std::vector<HumanModel> load_human_models(const std::string& csv_dir, int traj_id, int max_humans, double recorded_ratio);
+
+#endif  // ROS2_PACKAGE__TRIAL_LOG_HPP_
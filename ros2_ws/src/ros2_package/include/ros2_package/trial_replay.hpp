@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Replay of a recorded trial through a controller core
+//   (the controllers' replay mode, see controller_node.hpp)
+//
+// - Main functionalities:
+//   1. Loads the recorded trial csv (trial_log.hpp)
+//   2. Injects the logged human input at the core's
+//      simulated time, one tick after the other
+//   3. Kinematic plant: the joints follow the commands
+//      with a first-order lag (plant_time_constant)
+//   4. Keeps the commanded and the plant's tcp at the
+//      instants of the tcp_position messages, and diffs
+//      them against the log at the end (summary on stdout,
+//      per-sample csv optionally)
+//
+// - With several controllers in one process, "{ns}" in the
+//   file names is replaced by each one's namespace
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TRIAL_REPLAY_HPP_
+#define ROS2_PACKAGE__TRIAL_REPLAY_HPP_
+
+#include <string>
+#include <vector>
+
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/trial_log.hpp"
+
+
+/////////////////// replay files of a namespace ///////////////////
+const std::string namespace_placeholder = "{ns}";
+
+std::string replace_namespace(std::string path, const std::string & name_space);
+
+
+class TrialReplay
+{
+public:
+
+  // recorded trial csv in, per-sample diff csv out (empty = summary only),
+  // first-order joint lag of the plant in [seconds] (0 = ideal tracking)
+  TrialReplay(const std::string & a_file, const std::string & a_output, double a_plant_time_constant, int a_control_freq);
+
+  // false if the file has no samples (nothing to replay)
+  bool load();
+
+  // before a tick: the logged human input at the core's simulated time
+  // (the log only covers the recording phase, so the first / last sample is held outside of it)
+  void inject_input(SharedControlCore & core);
+
+  // after a tick: the plant's joints move towards the command
+  void step_plant(SharedControlCore & core) const;
+
+  // instead of a tcp_position message: the commanded tcp, together with where the plant actually is
+  void record_sample(SharedControlCore & core);
+
+  // diff of the replayed samples against the logged ones
+  void write_diff(double sim_time, double wall_time) const;
+
+  const std::string file;
+  const std::string output;
+  const double plant_time_constant;
+
+  TrialLog log;   // logged trial samples (one per recorded tcp_position message, i.e. at 40 Hz)
+
+private:
+
+  const int control_freq;
+  const double plant_gain;
+
+  std::vector<double> human_pos {0.0, 0.0, 0.0};
+
+  // replayed samples, taken at the same instants as the tcp_position messages
+  std::vector< std::vector<double> > tcp_pos;
+  std::vector< std::vector<double> > measured_pos;
+};
+
+#endif  // ROS2_PACKAGE__TRIAL_REPLAY_HPP_
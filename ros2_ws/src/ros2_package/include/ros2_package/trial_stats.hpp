@@ -0,0 +1,87 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Per-trial bookkeeping of the controllers
+//   (controller_node.hpp), apart from the ROS I/O:
+//
+//   1. TrialStats: what the safety layers of the core did
+//      during the trial (collision-map clamps, safety filter,
+//      self-collision, IK conditioning), with rate-limited
+//      warnings from the control tick and a summary at the end
+//   2. TrialErrors: error sums over the recorded samples,
+//      for the result of the "run_trial" action (same norms
+//      as the DataLogger)
+//   3. the conditions a "run_trial" goal may ask for
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__TRIAL_STATS_HPP_
+#define ROS2_PACKAGE__TRIAL_STATS_HPP_
+
+#include <vector>
+
+#include "ros2_package/shared_control.hpp"
+
+
+/////////////////// safety layers of the core ///////////////////
+class TrialStats
+{
+public:
+
+  explicit TrialStats(int a_control_freq) : control_freq(a_control_freq) {}
+
+  // one tick of the core (warnings at most once a second, or once per stretch of filtered commands)
+  void update(const TickOutput & out, const SharedControlCore & core);
+
+  // end-of-trial summary, of whatever was active
+  void report() const;
+
+  // a new trial
+  void reset();
+
+  int n_clamped = 0;                // ticks with the tcp target stopped short of an obstacle
+
+  int n_filtered = 0;               // commands limited by the safety filter
+  double max_filter_deviation = 0.0;
+
+  double min_self_distance = 1e9;
+  int n_self_collisions = 0;        // IK solutions rejected
+
+  double min_sigma = 1e9;
+  double min_manipulability = 1e9;
+  int n_scaled = 0;                 // ticks with less than full human authority
+  double slowest_ik_us = 0.0;
+  double slowest_ik_sigma = 0.0;    // where that was
+
+private:
+
+  const int control_freq;
+  bool filtering = false;
+};
+
+
+/////////////////// tracking errors for the action result ///////////////////
+// Euclidean distance to the reference (x is only used with depth, as in the DataLogger)
+double position_error(const std::vector<double>& pos, const std::vector<double>& ref, int use_depth);
+
+struct TrialErrors
+{
+  // one recorded sample
+  void add(const std::vector<double>& human, const std::vector<double>& robot, const std::vector<double>& tcp,
+           const std::vector<double>& ref, int use_depth);
+  void reset();
+
+  int n_samples = 0;
+  double human_sum = 0.0;
+  double robot_sum = 0.0;
+  double overall_sum = 0.0;
+  double overall_max = 0.0;
+};
+
+
+/////////////////// conditions of a trial ///////////////////
+bool valid_trial_conditions(int alpha_id, int traj_id, double mapping_ratio);
+
+#endif  // ROS2_PACKAGE__TRIAL_STATS_HPP_
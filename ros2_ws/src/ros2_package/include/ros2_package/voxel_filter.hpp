@@ -0,0 +1,79 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Transform + crop + voxel downsampling of a raw depth
+//   camera cloud in one pass, for the CloudPreprocessor
+//
+// - The camera-to-robot transform is set once and applied
+//   to blocks of points at a time (plain float loops the
+//   compiler vectorizes), points outside the crop box are
+//   dropped right there, so only the workspace is hashed
+//
+// - Multi-threaded in two rounds:
+//   1. each thread transforms and crops its share of the
+//      points and hands every kept point to the thread that
+//      owns its voxel (voxel index % n_threads)
+//   2. each thread averages the points of its own voxels, so
+//      nothing is shared or locked, and clears them again
+//   (all buffers are kept between clouds, no allocation once warm)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#ifndef ROS2_PACKAGE__VOXEL_FILTER_HPP_
+#define ROS2_PACKAGE__VOXEL_FILTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class VoxelFilter
+{
+public:
+
+  // crop box [lower, upper) in the robot frame [m], n_threads = 0 for one per core
+  VoxelFilter(const double a_lower[3], const double a_upper[3], double a_voxel_size, int a_n_threads = 0);
+
+  // camera frame -> robot frame, rotation row-major
+  void set_transform(const double rotation[9], const double translation[3]);
+
+  // xyz as float32 at xyz_offset of each point_step-byte point (NaNs are dropped),
+  // writes the voxel centroids as {x0, y0, z0, x1, ...} in the robot frame and returns how many there are
+  std::size_t filter(const uint8_t* data, std::size_t n_points, std::size_t point_step, std::size_t xyz_offset, std::vector<float>& out);
+
+  int n_threads() const {return threads;}
+  std::size_t n_cropped() const {return cropped;}    // points inside the crop box in the last cloud
+
+  const double voxel_size;
+
+private:
+
+  struct Entry
+  {
+    uint32_t key;
+    float x, y, z;
+  };
+
+  // round 1 on points [begin, end) by thread t
+  void transform_and_crop(int t, const uint8_t* data, std::size_t begin, std::size_t end, std::size_t point_step, std::size_t xyz_offset);
+
+  // round 2 by thread t: centroids of its voxels into its own output
+  void average(int t);
+
+  float lower[3];
+  float inv_voxel;
+  uint32_t dims[3];
+  float R[9];
+  float T[3];
+  int threads;
+
+  std::vector<float> cell_sums;                  // {sum x, sum y, sum z, count} per voxel of the box
+  std::vector< std::vector<Entry> > buckets;     // [source * threads + owner]
+  std::vector< std::vector<uint32_t> > touched;  // voxels hit this cloud, per owner
+  std::vector< std::vector<float> > outputs;     // centroids, per owner
+  std::size_t cropped = 0;
+};
+
+#endif  // ROS2_PACKAGE__VOXEL_FILTER_HPP_
@@ -15,6 +15,12 @@ def generate_launch_description():
     participant_parameter_name = 'part_id'
     alpha_parameter_name = 'alpha_id'
     trajectory_parameter_name = 'traj_id'
+    falcon_shm_parameter_name = 'falcon_shm'
+    input_prediction_parameter_name = 'input_prediction'
+    prediction_lookahead_parameter_name = 'prediction_lookahead_ms'
+    collision_map_parameter_name = 'collision_map'
+    collision_clearance_parameter_name = 'collision_clearance'
+    singularity_scaling_parameter_name = 'singularity_scaling'
 
     free_drive = LaunchConfiguration(free_drive_parameter_name)
     mapping_ratio = LaunchConfiguration(mapping_ratio_parameter_name)
@@ -22,6 +28,12 @@ def generate_launch_description():
     participant = LaunchConfiguration(participant_parameter_name)
     alpha = LaunchConfiguration(alpha_parameter_name)
     trajectory = LaunchConfiguration(trajectory_parameter_name)
+    falcon_shm = LaunchConfiguration(falcon_shm_parameter_name)
+    input_prediction = LaunchConfiguration(input_prediction_parameter_name)
+    prediction_lookahead = LaunchConfiguration(prediction_lookahead_parameter_name)
+    collision_map = LaunchConfiguration(collision_map_parameter_name)
+    collision_clearance = LaunchConfiguration(collision_clearance_parameter_name)
+    singularity_scaling = LaunchConfiguration(singularity_scaling_parameter_name)
 
 
     return LaunchDescription([
@@ -50,6 +62,30 @@ def generate_launch_description():
             trajectory_parameter_name,
             default_value=my_traj_id,
             description='Trajectory ID parameter'),
+        DeclareLaunchArgument(
+            falcon_shm_parameter_name,
+            default_value='',
+            description='Shared-memory segment for the Falcon samples (e.g. /ros2_package_falcon), empty = topic only'),
+        DeclareLaunchArgument(
+            input_prediction_parameter_name,
+            default_value='0',
+            description='Predict the human input with a Kalman filter (1) or use the newest sample as-is (0)'),
+        DeclareLaunchArgument(
+            prediction_lookahead_parameter_name,
+            default_value='0.0',
+            description='Prediction horizon on top of the measured input age [ms]'),
+        DeclareLaunchArgument(
+            collision_map_parameter_name,
+            default_value='0',
+            description='Keep the TCP out of an occupancy map built from points_workspace (1) or not (0)'),
+        DeclareLaunchArgument(
+            collision_clearance_parameter_name,
+            default_value='0.03',
+            description='Distance the TCP keeps from the mapped obstacles [m]'),
+        DeclareLaunchArgument(
+            singularity_scaling_parameter_name,
+            default_value='0',
+            description='Scale the human authority down close to a singularity (1) or not (0)'),
 
 
         # real robot controller node [need position_talker to be running]
@@ -62,7 +98,13 @@ def generate_launch_description():
                 {use_depth_parameter_name: use_depth},
                 {participant_parameter_name: participant},
                 {alpha_parameter_name: alpha},
-                {trajectory_parameter_name: trajectory}
+                {trajectory_parameter_name: trajectory},
+                {falcon_shm_parameter_name: falcon_shm},
+                {input_prediction_parameter_name: input_prediction},
+                {prediction_lookahead_parameter_name: prediction_lookahead},
+                {collision_map_parameter_name: collision_map},
+                {collision_clearance_parameter_name: collision_clearance},
+                {singularity_scaling_parameter_name: singularity_scaling}
             ],
             output='screen',
             emulate_tty=True,
@@ -31,6 +31,8 @@ def generate_launch_description():
     participant_parameter_name = 'part_id'
     alpha_parameter_name = 'alpha_id'
     trajectory_parameter_name = 'traj_id'
+    falcon_shm_parameter_name = 'falcon_shm'
+    guidance_gain_parameter_name = 'guidance_gain'
 
     free_drive = LaunchConfiguration(free_drive_parameter_name)
     mapping_ratio = LaunchConfiguration(mapping_ratio_parameter_name)
@@ -38,6 +40,8 @@ def generate_launch_description():
     participant = LaunchConfiguration(participant_parameter_name)
     alpha = LaunchConfiguration(alpha_parameter_name)
     trajectory = LaunchConfiguration(trajectory_parameter_name)
+    falcon_shm = LaunchConfiguration(falcon_shm_parameter_name)
+    guidance_gain = LaunchConfiguration(guidance_gain_parameter_name)
 
 
     return LaunchDescription([
@@ -91,6 +95,14 @@ def generate_launch_description():
             trajectory_parameter_name,
             default_value=my_traj_id,
             description='Trajectory ID parameter'),
+        DeclareLaunchArgument(
+            falcon_shm_parameter_name,
+            default_value='',
+            description='Shared-memory segment for the Falcon samples (e.g. /ros2_package_falcon), empty = topic only'),
+        DeclareLaunchArgument(
+            guidance_gain_parameter_name,
+            default_value='0.0',
+            description='Stiffness of the haptic guidance toward the reference [N/m], 0 = off'),
 
 
         ### franka_bringup launch ###
@@ -125,7 +137,9 @@ def generate_launch_description():
                 {use_depth_parameter_name: use_depth},
                 {participant_parameter_name: participant},
                 {alpha_parameter_name: alpha},
-                {trajectory_parameter_name: trajectory}
+                {trajectory_parameter_name: trajectory},
+                {guidance_gain_parameter_name: guidance_gain},
+                {falcon_shm_parameter_name: falcon_shm}
             ],
             output='screen',
             emulate_tty=True,
@@ -147,6 +161,15 @@ def generate_launch_description():
             name='marker_publisher'
         ),
 
+        # measured TCP pose from the joint states, recorded next to the commanded one
+        Node(
+            package='ros2_package',
+            executable='tcp_state_publisher',
+            output='screen',
+            emulate_tty=True,
+            name='tcp_state_publisher'
+        ),
+
         # trajectory recorder node
         Node(
             package='ros2_package',
@@ -170,6 +193,15 @@ def generate_launch_description():
             name='const_br'
         ),
 
+        # workspace part of the camera cloud in the robot frame, for RViz
+        Node(
+            package='ros2_package',
+            executable='cloud_preprocessor',
+            output='screen',
+            emulate_tty=True,
+            name='cloud_preprocessor'
+        ),
+
         # publish recorded point cloud
         ExecuteProcess(
                 cmd=[
@@ -9,7 +9,8 @@
 ##   waypoints, and write them to two files:
 ##   
 ##   1. A new .csv file containing the raw trajectory waypoints
-##      of that particular trial
+##      of that particular trial (plus the measured tcp position
+##      when every sample has one)
 ##
 ##   2. Append a row of calculated error information to
 ##      the header file of the corresponding participant
@@ -22,13 +23,21 @@ from csv import writer, DictReader, DictWriter
 from os.path import isfile
 from math import sqrt
 
+from numpy import column_stack
+
+# C++ error kernel (src/python_bindings.cpp), only there if the package was built with pybind11
+try:
+    from ros2_package import _native
+except ImportError:
+    _native = None
+
 
 #####################################################################################################
 class DataLogger:
 
     def __init__(self, csv_dir, part_id, alpha_id, traj_id, 
                  refxs, refys, refzs, hxs, hys, hzs, rxs, rys, rzs, txs, tys, tzs, 
-                 times_from_start, times, datetimes):
+                 times_from_start, times, datetimes, mxs=None, mys=None, mzs=None):
         
         # trial info
         self.csv_dir = csv_dir
@@ -57,6 +66,12 @@ class DataLogger:
         self.tys = tys
         self.tzs = tzs
 
+        # measured tcp (from the joint states), only logged if there is one for every sample
+        self.has_measured = mxs is not None and len(mxs) == self.num_points and self.num_points > 0
+        self.mxs = mxs
+        self.mys = mys
+        self.mzs = mzs
+
         # other info
         self.times_from_start = times_from_start
         self.times = times
@@ -72,30 +87,12 @@ class DataLogger:
     def calc_error(self, use_depth):
         
         ########################################### THESE GO INTO THE 400-LINE FILE ###########################################
-        # human error lists in each dim
-        self.hx_err_list = [abs(self.hxs[i] - self.refxs[i]) for i in range(self.num_points)]
-        self.hy_err_list = [abs(self.hys[i] - self.refys[i]) for i in range(self.num_points)]
-        self.hz_err_list = [abs(self.hzs[i] - self.refzs[i]) for i in range(self.num_points)]
-
-        # robot error lists in each dim
-        self.rx_err_list = [abs(self.rxs[i] - self.refxs[i]) for i in range(self.num_points)]
-        self.ry_err_list = [abs(self.rys[i] - self.refys[i]) for i in range(self.num_points)]
-        self.rz_err_list = [abs(self.rzs[i] - self.refzs[i]) for i in range(self.num_points)]
-
-        # overall error lists in each dim
-        self.tx_err_list = [abs(self.txs[i] - self.refxs[i]) for i in range(self.num_points)]
-        self.ty_err_list = [abs(self.tys[i] - self.refys[i]) for i in range(self.num_points)]
-        self.tz_err_list = [abs(self.tzs[i] - self.refzs[i]) for i in range(self.num_points)]
-
-        # human, robot & overall Euclidean norm error list
-        if use_depth:
-            self.h_err_list = [sqrt((self.hx_err_list[i])**2 + (self.hy_err_list[i])**2 + (self.hz_err_list[i])**2) for i in range(self.num_points)]
-            self.r_err_list = [sqrt((self.rx_err_list[i])**2 + (self.ry_err_list[i])**2 + (self.rz_err_list[i])**2) for i in range(self.num_points)]
-            self.t_err_list = [sqrt((self.tx_err_list[i])**2 + (self.ty_err_list[i])**2 + (self.tz_err_list[i])**2) for i in range(self.num_points)]
-        else:
-            self.h_err_list = [sqrt((self.hy_err_list[i])**2 + (self.hz_err_list[i])**2) for i in range(self.num_points)]
-            self.r_err_list = [sqrt((self.ry_err_list[i])**2 + (self.rz_err_list[i])**2) for i in range(self.num_points)]
-            self.t_err_list = [sqrt((self.ty_err_list[i])**2 + (self.tz_err_list[i])**2) for i in range(self.num_points)]
+        # per-dimension and Euclidean norm error lists of the human, robot & overall (and measured) positions
+        self.hx_err_list, self.hy_err_list, self.hz_err_list, self.h_err_list = self.error_lists(self.hxs, self.hys, self.hzs, use_depth)
+        self.rx_err_list, self.ry_err_list, self.rz_err_list, self.r_err_list = self.error_lists(self.rxs, self.rys, self.rzs, use_depth)
+        self.tx_err_list, self.ty_err_list, self.tz_err_list, self.t_err_list = self.error_lists(self.txs, self.tys, self.tzs, use_depth)
+        if self.has_measured:
+            self.mx_err_list, self.my_err_list, self.mz_err_list, m_err_list = self.error_lists(self.mxs, self.mys, self.mzs, use_depth)
 
         ########################################### THESE GO INTO THE HEADER FILE ###########################################
 
@@ -120,6 +117,10 @@ class DataLogger:
         self.t_dim_err_total = [self.tx_err_total, self.ty_err_total, self.tz_err_total]    # log this
         self.t_err_total = sum(self.t_err_list)                                             # log this
 
+        # measured error, printed only (the header file keeps its columns)
+        if self.has_measured:
+            print("\nMeasured tcp error: average = %.4f m (commanded %.4f m)\n" % (sum(m_err_list) / self.num_points, sum(self.t_err_list) / self.num_points))
+
         # average human errors
         self.hx_err_ave = self.hx_err_total / self.num_points
         self.hy_err_ave = self.hy_err_total / self.num_points
@@ -142,6 +143,26 @@ class DataLogger:
         self.t_err_ave = self.t_err_total / self.num_points                                 # log this
 
 
+    ##############################################################################
+    def error_lists(self, xs, ys, zs, use_depth):
+
+        # |position - reference| in each dim, and its norm (x left out unless use_depth)
+        if _native is not None:
+            n = self.num_points
+            res = _native.tracking_error(column_stack((xs[:n], ys[:n], zs[:n])), column_stack((self.refxs[:n], self.refys[:n], self.refzs[:n])), use_depth)
+            x_err, y_err, z_err = res['dim_err'].T.tolist()
+            return x_err, y_err, z_err, res['err'].tolist()
+
+        x_err = [abs(xs[i] - self.refxs[i]) for i in range(self.num_points)]
+        y_err = [abs(ys[i] - self.refys[i]) for i in range(self.num_points)]
+        z_err = [abs(zs[i] - self.refzs[i]) for i in range(self.num_points)]
+        if use_depth:
+            err = [sqrt(x_err[i]**2 + y_err[i]**2 + z_err[i]**2) for i in range(self.num_points)]
+        else:
+            err = [sqrt(y_err[i]**2 + z_err[i]**2) for i in range(self.num_points)]
+        return x_err, y_err, z_err, err
+
+
     ##############################################################################
     def write_header(self):
 
@@ -201,13 +222,17 @@ class DataLogger:
             wr = writer(file)
             # write datapoints [recorded trajectory points]
             for i in range(self.num_points):
-                wr.writerow([self.refxs[i], self.refys[i], self.refzs[i],       # this was added (for noisy robot), and a few below also
-                             self.hxs[i], self.hys[i], self.hzs[i], self.rxs[i], self.rys[i], self.rzs[i],
-                             self.txs[i], self.tys[i], self.tzs[i], self.h_err_list[i], self.h_err_list, self.t_err_list[i],
-                             self.hx_err_list[i], self.hy_err_list[i], self.hz_err_list[i],
-                             self.rx_err_list[i], self.ry_err_list[i], self.rz_err_list[i],
-                             self.tx_err_list[i], self.ty_err_list[i], self.tz_err_list[i],
-                             self.times_from_start[i], self.times[i], self.datetimes[i]])
+                row = [self.refxs[i], self.refys[i], self.refzs[i],       # this was added (for noisy robot), and a few below also
+                       self.hxs[i], self.hys[i], self.hzs[i], self.rxs[i], self.rys[i], self.rzs[i],
+                       self.txs[i], self.tys[i], self.tzs[i], self.h_err_list[i], self.h_err_list, self.t_err_list[i],
+                       self.hx_err_list[i], self.hy_err_list[i], self.hz_err_list[i],
+                       self.rx_err_list[i], self.ry_err_list[i], self.rz_err_list[i],
+                       self.tx_err_list[i], self.ty_err_list[i], self.tz_err_list[i],
+                       self.times_from_start[i], self.times[i], self.datetimes[i]]
+                # measured tcp after the original 27 columns
+                if self.has_measured:
+                    row += [self.mxs[i], self.mys[i], self.mzs[i]]
+                wr.writerow(row)
 
             print("\nSuccesfully opened file %s and finished logging data !!!\n" % self.data_file_name)
 
@@ -2,10 +2,21 @@ from numpy import matrix, pi, ndarray, linspace, sin, cos, stack, asarray, absol
 # from math import sin, cos
 import matplotlib.pyplot as plt
 
+# C++ kernels of the controller (src/python_bindings.cpp), only there if the package was built with pybind11
+try:
+    from ros2_package import _native
+except ImportError:
+    _native = None
+
 
 ####################################################################################
 def get_sine_ref_points(n_points: int, a, b, c, s, h, height, width, depth, origin: list[float], use_depth: int):
 
+    # the controller's own curve, when the envelope is the one it was built with
+    if _native is not None and (height, width, depth) == (_native.TRAJ_HEIGHT, _native.TRAJ_WIDTH, _native.TRAJ_DEPTH):
+        points = _native.reference_trajectory(n_points, a, b, c, s, h, list(origin), use_depth)
+        return points[:, 0].tolist(), points[:, 1].tolist(), points[:, 2].tolist()
+
     ampz = h * height
 
     theta = linspace(0, 2*pi, n_points)
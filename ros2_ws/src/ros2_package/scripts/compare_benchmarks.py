@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+######################################################
+######################################################
+## FILE SUMMARY:
+##
+## - Compares a JSON run of the ros2_package_benchmarks
+##   against a baseline file (also a Google Benchmark
+##   JSON output) and flags every benchmark that got
+##   slower than the threshold
+##
+## - Exits with 1 if anything regressed, so it can gate
+##   a build. With --update the run becomes the new baseline
+##
+## - Usage:
+##     python3 compare_benchmarks.py benchmark_results.json benchmark/baseline.json [--threshold 0.1] [--update]
+##
+######################################################
+######################################################
+
+import argparse
+import json
+import shutil
+import sys
+
+
+def load_times(path, metric):
+
+    with open(path) as f:
+        data = json.load(f)
+
+    # only the plain runs (no mean/median/stddev aggregates), in [ns]
+    to_ns = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+    times = {}
+    for bm in data.get('benchmarks', []):
+        if bm.get('run_type', 'iteration') != 'iteration' or bm.get('error_occurred', False):
+            continue
+        times[bm['name']] = bm[metric] * to_ns[bm.get('time_unit', 'ns')]
+    return times, data.get('context', {})
+
+
+##############################################################################
+def main():
+
+    parser = argparse.ArgumentParser(description="Compare a benchmark run against the baseline")
+    parser.add_argument("results", help="JSON output of ros2_package_benchmarks")
+    parser.add_argument("baseline", help="baseline JSON file")
+    parser.add_argument("--threshold", type=float, default=0.10, help="relative slowdown that counts as a regression (default 0.10)")
+    parser.add_argument("--metric", default="cpu_time", choices=["cpu_time", "real_time"])
+    parser.add_argument("--update", action="store_true", help="copy the results over the baseline afterwards")
+    args = parser.parse_args()
+
+    results, context = load_times(args.results, args.metric)
+    try:
+        baseline, baseline_context = load_times(args.baseline, args.metric)
+    except FileNotFoundError:
+        baseline, baseline_context = {}, {}
+        print("No baseline at %s yet" % args.baseline)
+
+    if baseline_context.get('host_name') and baseline_context.get('host_name') != context.get('host_name'):
+        print("Note: the baseline was recorded on %s, this run on %s" % (baseline_context['host_name'], context.get('host_name')))
+
+    regressions = []
+    print("\n%-55s %12s %12s %9s" % ("benchmark", "baseline", "current", "change"))
+    print("-" * 92)
+    for name, current in results.items():
+        if name not in baseline:
+            print("%-55s %12s %12.0f %9s" % (name, "-", current, "new"))
+            continue
+        change = current / baseline[name] - 1.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  <-- slower"
+            regressions.append(name)
+        print("%-55s %12.0f %12.0f %+8.1f%%%s" % (name, baseline[name], current, 100 * change, flag))
+
+    for name in baseline:
+        if name not in results:
+            print("%-55s %12.0f %12s %9s" % (name, baseline[name], "-", "missing"))
+    print("(%s in [ns])\n" % args.metric)
+
+    if args.update:
+        shutil.copyfile(args.results, args.baseline)
+        print("Baseline updated: %s" % args.baseline)
+
+    if regressions:
+        print("%d benchmark(s) regressed by more than %.0f%%" % (len(regressions), 100 * args.threshold))
+        sys.exit(1)
+    print("No regressions")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+######################################################
+######################################################
+## FILE SUMMARY:
+##
+## - Measures the latency along the whole
+##   PositionTalker -> controller -> robot chain, from
+##   the stamps the nodes put into their messages:
+##
+##   1. talker -> monitor:  arrival of falcon_position
+##      vs. its device-read stamp (transport)
+##   2. controller:         tcp_position publish stamp
+##      vs. its input_stamp (input age inside the controller)
+##   3. input -> command:   arrival of the joint command
+##      vs. its stamp (= device-read time of its input)
+##   4. command -> robot:   lag between the commanded and
+##      the measured joint motion (cross-correlation of the
+##      joint velocities over sliding 2 s windows)
+##
+## - Usage (while a trial is running):
+##     ros2 run ros2_package latency_monitor.py --duration 30
+##
+######################################################
+######################################################
+
+import argparse
+import csv
+
+import numpy as np
+
+import rclpy
+from rclpy.node import Node
+from rclpy.qos import QoSProfile, ReliabilityPolicy, HistoryPolicy
+
+from sensor_msgs.msg import JointState
+from tutorial_interfaces.msg import FalconposStamped
+from tutorial_interfaces.msg import PosInfoStamped
+
+
+# cross-correlation of the command and measured joint motion
+RESAMPLE_FREQ = 1000    # in [Hz]
+WINDOW_TIME = 2.0       # in [seconds]
+MAX_ROBOT_LAG = 0.2     # in [seconds]
+
+
+def stamp_to_sec(stamp):
+    return stamp.sec + stamp.nanosec * 1e-9
+
+
+class LatencyMonitor(Node):
+
+    ##############################################################################
+    def __init__(self, command_topic, joint_states_topic):
+
+        super().__init__('latency_monitor')
+
+        # keep every sample, best-effort so it also matches the talker's best-effort publisher
+        qos = QoSProfile(reliability=ReliabilityPolicy.BEST_EFFORT, history=HistoryPolicy.KEEP_LAST, depth=100)
+
+        self.create_subscription(FalconposStamped, 'falcon_position', self.falcon_callback, qos)
+        self.create_subscription(PosInfoStamped, 'tcp_position', self.tcp_callback, qos)
+        self.create_subscription(JointState, command_topic, self.command_callback, qos)
+        self.create_subscription(JointState, joint_states_topic, self.joint_states_callback, qos)
+
+        self.talker_latency = []
+        self.controller_latency = []
+        self.command_latency = []
+
+        # (arrival time, joint positions) for the robot lag
+        self.command_times = []
+        self.command_positions = []
+        self.measured_times = []
+        self.measured_positions = []
+
+
+    ##############################################################################
+    def now_sec(self):
+        return self.get_clock().now().nanoseconds * 1e-9
+
+    def falcon_callback(self, msg):
+        self.talker_latency.append(self.now_sec() - stamp_to_sec(msg.header.stamp))
+
+    def tcp_callback(self, msg):
+        if stamp_to_sec(msg.input_stamp) > 0.0:
+            self.controller_latency.append(stamp_to_sec(msg.header.stamp) - stamp_to_sec(msg.input_stamp))
+
+    def command_callback(self, msg):
+        now = self.now_sec()
+        if stamp_to_sec(msg.header.stamp) > 0.0:
+            self.command_latency.append(now - stamp_to_sec(msg.header.stamp))
+        self.command_times.append(now)
+        self.command_positions.append(list(msg.position[:7]))
+
+    def joint_states_callback(self, msg):
+        self.measured_times.append(self.now_sec())
+        self.measured_positions.append(list(msg.position[:7]))
+
+
+    ##############################################################################
+    def robot_lag(self):
+
+        # the robot lags behind its commands, find the shift that best aligns the joint velocities
+        if len(self.command_times) < 2 or len(self.measured_times) < 2:
+            return []
+
+        t0 = max(self.command_times[0], self.measured_times[0])
+        t1 = min(self.command_times[-1], self.measured_times[-1])
+        if t1 - t0 < WINDOW_TIME:
+            return []
+
+        t = np.arange(t0, t1, 1.0 / RESAMPLE_FREQ)
+        cmd = np.array(self.command_positions)
+        meas = np.array(self.measured_positions)
+        cmd_v = np.diff(np.stack([np.interp(t, self.command_times, cmd[:, j]) for j in range(cmd.shape[1])]), axis=1)
+        meas_v = np.diff(np.stack([np.interp(t, self.measured_times, meas[:, j]) for j in range(meas.shape[1])]), axis=1)
+
+        window = int(WINDOW_TIME * RESAMPLE_FREQ)
+        max_lag = int(MAX_ROBOT_LAG * RESAMPLE_FREQ)
+        lags = []
+
+        for start in range(0, cmd_v.shape[1] - window - max_lag, window // 2):
+            c = cmd_v[:, start:start + window]
+            if np.abs(c).sum() < 1e-6:
+                continue    # the robot is standing still, nothing to align
+            scores = []
+            for k in range(max_lag):
+                m = meas_v[:, start + k:start + k + window]
+                scores.append(np.sum(c * m) / max(np.sqrt(np.sum(m * m)), 1e-12))
+            lags.append(np.argmax(scores) / RESAMPLE_FREQ)
+
+        return lags
+
+
+##############################################################################
+def print_stats(name, values):
+
+    if len(values) == 0:
+        print("%-24s %8s" % (name, "no data"))
+        return
+
+    ms = np.array(values) * 1000
+    print("%-24s %8d %8.3f %8.3f %8.3f %8.3f %8.3f" %
+          (name, len(ms), ms.mean(), np.percentile(ms, 50), np.percentile(ms, 90), np.percentile(ms, 99), ms.max()))
+
+
+##############################################################################
+def main():
+
+    parser = argparse.ArgumentParser(description="Latency distributions of the talker -> controller -> robot chain")
+    parser.add_argument("--duration", type=float, default=30.0, help="how long to listen in [seconds]")
+    parser.add_argument("--command_topic", default="desired_joint_vals")
+    parser.add_argument("--joint_states_topic", default="franka/joint_states")
+    parser.add_argument("--csv", default="", help="also write the per-sample latencies to this file")
+    args = parser.parse_args()
+
+    rclpy.init()
+    monitor = LatencyMonitor(args.command_topic, args.joint_states_topic)
+
+    print("Listening for %.1f seconds ..." % args.duration)
+    end = monitor.now_sec() + args.duration
+    while rclpy.ok() and monitor.now_sec() < end:
+        rclpy.spin_once(monitor, timeout_sec=0.1)
+
+    robot_lag = monitor.robot_lag()
+
+    print("\n%-24s %8s %8s %8s %8s %8s %8s" % ("stage [ms]", "n", "mean", "p50", "p90", "p99", "max"))
+    print("-" * 80)
+    print_stats("talker -> monitor", monitor.talker_latency)
+    print_stats("controller", monitor.controller_latency)
+    print_stats("input -> command", monitor.command_latency)
+    print_stats("command -> robot", robot_lag)
+    print()
+
+    if args.csv:
+        stages = [("talker", monitor.talker_latency), ("controller", monitor.controller_latency),
+                  ("command", monitor.command_latency), ("robot", robot_lag)]
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(["stage", "latency"])
+            for stage, values in stages:
+                for value in values:
+                    writer.writerow([stage, value])
+        print("Wrote the samples to %s" % args.csv)
+
+    monitor.destroy_node()
+    rclpy.shutdown()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+######################################################
+######################################################
+## FILE SUMMARY:
+##
+## - Batch replay of the recorded trials in csv_logs
+##   through the RealController (replay mode)
+##
+## - For every partX/trialY.csv, the experimental
+##   conditions are read from the participant's header
+##   file, and a real_controller process is started with
+##   "replay_file" set, running faster than real-time
+##
+## - Each replay writes a per-sample diff csv into the
+##   output directory, which are summarized at the end
+##
+######################################################
+######################################################
+
+import argparse
+import subprocess
+
+from concurrent.futures import ThreadPoolExecutor
+from csv import DictReader, reader
+from os import cpu_count, environ, listdir, makedirs
+from os.path import isdir, isfile, join
+from time import time
+
+
+ALL_CSV_DIR = "{CSV_DIRECTORY}"
+
+# the replays run on a ROS domain of their own, kept on this machine, so they can never reach
+# a robot stack or a TrajRecorder on the default domain (the replay mode publishes nothing anyway)
+REPLAY_DOMAIN_ID = "101"
+
+
+##############################################################################
+def get_trial_conditions(part_dir, part_name):
+
+    # trial_number -> (alpha_id, traj_id), taken from the participant's header file
+    conditions = {}
+    header_file = join(part_dir, part_name + "_header.csv")
+    if not isfile(header_file):
+        return conditions
+
+    with open(header_file, 'r', newline='') as f:
+        for row in DictReader(f):
+            conditions[int(row['trial_number'])] = (int(row['alpha_id']), int(row['traj_id']))
+
+    return conditions
+
+
+##############################################################################
+def get_use_depth(trial_file):
+
+    # the reference only moves in x when depth is used (see DataLogger.log_data() for the two layouts)
+    with open(trial_file, 'r', newline='') as f:
+        rows = list(reader(f))
+    ref_col = 3 if len(rows[0]) == 20 else 0
+    ref_xs = [float(row[ref_col]) for row in rows]
+
+    return int(max(ref_xs) - min(ref_xs) > 1e-6)
+
+
+##############################################################################
+def replay_trial(trial_file, output_file, alpha_id, traj_id, use_depth, plant_time_constant):
+
+    cmd = ["ros2", "run", "ros2_package", "real_controller", "--ros-args",
+           "-p", "replay_file:=%s" % trial_file,
+           "-p", "replay_output:=%s" % output_file,
+           "-p", "plant_time_constant:=%f" % plant_time_constant,
+           "-p", "alpha_id:=%d" % alpha_id,
+           "-p", "traj_id:=%d" % traj_id,
+           "-p", "use_depth:=%d" % use_depth]
+
+    env = dict(environ, ROS_DOMAIN_ID=REPLAY_DOMAIN_ID, ROS_LOCALHOST_ONLY="1", ROS_AUTOMATIC_DISCOVERY_RANGE="LOCALHOST")
+    result = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True, env=env)
+    return result.returncode
+
+
+##############################################################################
+def summarize(output_file):
+
+    diffs = []
+    with open(output_file, 'r', newline='') as f:
+        for row in DictReader(f):
+            diffs.append(float(row['diff']))
+
+    if len(diffs) == 0:
+        return None
+    return sum(diffs) / len(diffs), max(diffs)
+
+
+##############################################################################
+def main():
+
+    parser = argparse.ArgumentParser(description="Replay recorded trials through the RealController")
+    parser.add_argument("--csv_dir", default=ALL_CSV_DIR, help="directory containing the partX folders")
+    parser.add_argument("--out_dir", default="replay_output", help="directory for the per-trial diff csv files")
+    parser.add_argument("--jobs", type=int, default=cpu_count(), help="number of replays to run in parallel")
+    parser.add_argument("--plant_time_constant", type=float, default=0.0, help="joint lag of the plant model [s]")
+    args = parser.parse_args()
+
+    makedirs(args.out_dir, exist_ok=True)
+
+    # collect all the trials to replay
+    jobs = []
+    for part_name in sorted(listdir(args.csv_dir)):
+        part_dir = join(args.csv_dir, part_name)
+        if not isdir(part_dir):
+            continue
+        conditions = get_trial_conditions(part_dir, part_name)
+        for trial_number, (alpha_id, traj_id) in sorted(conditions.items()):
+            trial_file = join(part_dir, "trial" + str(trial_number) + ".csv")
+            if not isfile(trial_file):
+                continue
+            output_file = join(args.out_dir, part_name + "_trial" + str(trial_number) + ".csv")
+            jobs.append((trial_file, output_file, alpha_id, traj_id, get_use_depth(trial_file), args.plant_time_constant))
+
+    print("\nReplaying %d trials with %d parallel jobs ...\n" % (len(jobs), args.jobs))
+
+    start = time()
+    with ThreadPoolExecutor(max_workers=args.jobs) as executor:
+        return_codes = list(executor.map(lambda job: replay_trial(*job), jobs))
+    duration = time() - start
+
+    # summarize the diffs of all replays
+    worst = (0.0, "")
+    failed = 0
+    mean_diffs = []
+    for job, return_code in zip(jobs, return_codes):
+        output_file = job[1]
+        summary = summarize(output_file) if (return_code == 0 and isfile(output_file)) else None
+        if summary is None:
+            failed += 1
+            continue
+        mean_diffs.append(summary[0])
+        if summary[1] > worst[0]:
+            worst = (summary[1], output_file)
+
+    print("=" * 100)
+    print("Replayed %d trials in %.1f seconds (%d failed)" % (len(jobs), duration, failed))
+    if len(mean_diffs) > 0:
+        print("Mean TCP diff over all trials = %.6f [m]" % (sum(mean_diffs) / len(mean_diffs)))
+        print("Largest TCP diff = %.6f [m] in %s" % worst)
+    print("=" * 100)
+
+
+if __name__ == '__main__':
+    main()
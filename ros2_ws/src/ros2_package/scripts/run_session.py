@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+
+######################################################
+######################################################
+## FILE SUMMARY:
+##
+## - Runs a whole session of trials back-to-back on a
+##   RealController started in session mode:
+##     ros2 run ros2_package real_controller --ros-args -p session:=1
+##
+## - For every trial, a fresh TrajRecorder is created
+##   with that trial's conditions, and a "run_trial"
+##   goal is sent to the controller. The next trial is
+##   started as soon as the previous result comes back
+##
+## - The trial order follows the experiment: blocks of
+##   alpha_id, with the traj_ids shuffled in each block
+##
+######################################################
+######################################################
+
+import argparse
+import sys
+
+from os.path import dirname, realpath
+from random import shuffle
+from time import time
+
+import rclpy
+from rclpy.action import ActionClient
+from rclpy.executors import MultiThreadedExecutor
+from rclpy.node import Node
+from rclpy.parameter import Parameter
+
+from tutorial_interfaces.action import RunTrial
+
+# the TrajRecorder lives next to this script
+sys.path.append(dirname(realpath(__file__)))
+from traj_recorder import TrajRecorder
+
+
+class SessionClient(Node):
+
+    ##############################################################################
+    def __init__(self):
+
+        super().__init__('session_client')
+        self.run_trial_client = ActionClient(self, RunTrial, 'run_trial')
+        self.last_phase = ""
+
+
+    ##############################################################################
+    def feedback_callback(self, feedback_msg):
+
+        feedback = feedback_msg.feedback
+        if feedback.phase != self.last_phase:
+            print("    [%5.1f %%] %s" % (feedback.progress * 100, feedback.phase))
+            self.last_phase = feedback.phase
+
+
+    ##############################################################################
+    def run_trial(self, executor, part_id, alpha_id, traj_id, use_depth, mapping_ratio):
+
+        goal = RunTrial.Goal()
+        goal.part_id = part_id
+        goal.alpha_id = alpha_id
+        goal.traj_id = traj_id
+        goal.use_depth = use_depth
+        goal.mapping_ratio = mapping_ratio
+
+        self.last_phase = ""
+        goal_future = self.run_trial_client.send_goal_async(goal, feedback_callback=self.feedback_callback)
+        executor.spin_until_future_complete(goal_future)
+
+        goal_handle = goal_future.result()
+        if not goal_handle.accepted:
+            return None
+
+        result_future = goal_handle.get_result_async()
+        executor.spin_until_future_complete(result_future)
+
+        return result_future.result().result
+
+
+##############################################################################
+def get_trial_list(alpha_ids, traj_ids):
+
+    # blocks of alpha_id, traj_ids shuffled within each block
+    trials = []
+    for alpha_id in alpha_ids:
+        block = list(traj_ids)
+        shuffle(block)
+        trials += [(alpha_id, traj_id) for traj_id in block]
+
+    return trials
+
+
+##############################################################################
+def main():
+
+    parser = argparse.ArgumentParser(description="Run a session of trials on a RealController in session mode")
+    parser.add_argument("--part_id", type=int, required=True, help="participant ID")
+    parser.add_argument("--alpha_ids", type=int, nargs='+', default=[5, 3, 4, 2, 1], help="alpha_id blocks, in order")
+    parser.add_argument("--traj_ids", type=int, nargs='+', default=[1, 2, 3, 4, 5], help="traj_ids of each block")
+    parser.add_argument("--use_depth", type=int, default=0)
+    parser.add_argument("--mapping_ratio", type=float, default=3.0)
+    args = parser.parse_args()
+
+    rclpy.init()
+
+    client = SessionClient()
+    executor = MultiThreadedExecutor()
+    executor.add_node(client)
+
+    if not client.run_trial_client.wait_for_server(timeout_sec=10.0):
+        print("No run_trial action server, is the real_controller running with session:=1 ?")
+        rclpy.shutdown()
+        return
+
+    trials = get_trial_list(args.alpha_ids, args.traj_ids)
+    start = time()
+    i = -1
+
+    for i, (alpha_id, traj_id) in enumerate(trials):
+
+        print("\n" + "=" * 100)
+        print("Trial %d / %d: alpha_id = %d, traj_id = %d" % (i + 1, len(trials), alpha_id, traj_id))
+        print("=" * 100)
+
+        # a fresh recorder per trial, so it logs with this trial's conditions
+        recorder = TrajRecorder(parameter_overrides=[
+            Parameter('mapping_ratio', value=args.mapping_ratio),
+            Parameter('use_depth', value=args.use_depth),
+            Parameter('part_id', value=args.part_id),
+            Parameter('alpha_id', value=alpha_id),
+            Parameter('traj_id', value=traj_id)
+        ])
+        executor.add_node(recorder)
+
+        result = client.run_trial(executor, args.part_id, alpha_id, traj_id, args.use_depth, args.mapping_ratio)
+
+        executor.remove_node(recorder)
+        recorder.destroy_node()
+
+        if result is None:
+            print("The trial was rejected, stopping the session!")
+            break
+
+        print("\n    %s: human_ave = %.4f, robot_ave = %.4f, overall_ave = %.4f, overall_max = %.4f [m] (%d samples)" %
+              (result.message, result.human_ave, result.robot_ave, result.overall_ave, result.overall_max, result.num_samples))
+
+        if not result.success:
+            print("The trial did not finish cleanly, stopping the session!")
+            break
+
+    duration = time() - start
+    print("\nSession took %.1f minutes (%.1f trials per hour)\n" % (duration / 60, (i + 1) / duration * 3600))
+
+    client.destroy_node()
+    rclpy.shutdown()
+
+
+if __name__ == '__main__':
+    main()
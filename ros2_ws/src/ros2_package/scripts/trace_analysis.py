@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+
+######################################################
+######################################################
+## FILE SUMMARY:
+##
+## - Offline analysis of an LTTng trace of the nodes,
+##   built with -DROS2_PACKAGE_TRACING=ON and recorded with
+##     ros2 trace -s <session> -u 'ros2_package:*' 'ros2:*'
+##
+## - Rebuilds the critical path of every Falcon sample
+##   (joined on the device-read stamp the nodes pass along):
+##     device read -> falcon publish -> controller callback (or
+##     shared-memory read) -> first controller tick using it -> IK
+##     -> command publish
+##   and of the markers:
+##     tcp publish -> MarkerPublisher callback -> marker publish
+##
+## - Also reports the callback durations, and the executor
+##   wait times per thread if the rclcpp executor events of
+##   ros2_tracing are in the trace
+##
+## - Usage:
+##     python3 trace_analysis.py ~/.ros/tracing/<session> [--csv paths.csv]
+##
+######################################################
+######################################################
+
+import argparse
+import csv
+from collections import defaultdict
+
+import bt2
+import numpy as np
+
+
+##############################################################################
+def read_events(trace_path):
+
+    # (timestamp [ns], event name, vtid, payload dict) in trace order
+    events = []
+    for msg in bt2.TraceCollectionMessageIterator(trace_path):
+        if type(msg) is not bt2._EventMessageConst:
+            continue
+
+        event = msg.event
+        if not (event.name.startswith('ros2_package:') or event.name.startswith('ros2:')):
+            continue
+
+        context = event.common_context_field
+        vtid = int(context['vtid']) if context is not None and 'vtid' in context else 0
+
+        # only the plain fields are needed (the ros2 events also carry arrays, e.g. gids)
+        payload = {}
+        for key, value in event.payload_field.items():
+            if isinstance(value, bt2._StringFieldConst):
+                payload[str(key)] = str(value)
+            elif isinstance(value, bt2._IntegerFieldConst):
+                payload[str(key)] = int(value)
+
+        events.append((msg.default_clock_snapshot.ns_from_origin, event.name, vtid, payload))
+
+    return events
+
+
+##############################################################################
+class TraceAnalysis:
+
+    def __init__(self, events):
+
+        # per Falcon sample (device-read stamp)
+        self.read = {}
+        self.publish = {}
+        self.falcon_callback = {}
+        self.first_tick = {}    # the first controller tick that used the sample
+
+        # per tcp sample (same stamp), for the marker path
+        self.tcp_publish = {}
+        self.marker_callback = {}
+        self.marker_publish = {}
+
+        self.callback_durations = defaultdict(list)    # name -> [ns]
+        self.executor_waits = defaultdict(list)        # vtid -> [ns]
+
+        open_scopes = defaultdict(list)     # vtid -> stack of open callbacks
+        wait_start = {}                     # vtid -> ros2 executor wait start
+
+        for ts, name, vtid, payload in events:
+            stamp = payload.get('stamp_ns', 0)
+
+            if name == 'ros2_package:device_read':
+                self.read.setdefault(stamp, ts)
+            elif name == 'ros2_package:falcon_publish':
+                self.publish.setdefault(stamp, ts)
+
+            elif name == 'ros2_package:callback_start':
+                scope = {'callback': payload['callback'], 'stamp': stamp, 'start': ts}
+                open_scopes[vtid].append(scope)
+                if scope['callback'] in ('falcon_callback', 'falcon_shm'):
+                    self.falcon_callback.setdefault(stamp, ts)
+                elif scope['callback'] == 'ref_callback':
+                    self.marker_callback.setdefault(stamp, ts)
+                elif scope['callback'] == 'controller_tick' and stamp != 0 and stamp not in self.first_tick:
+                    self.first_tick[stamp] = scope
+
+            elif name == 'ros2_package:callback_end':
+                if open_scopes[vtid]:
+                    scope = open_scopes[vtid].pop()
+                    self.callback_durations[scope['callback']].append(ts - scope['start'])
+
+            elif name in ('ros2_package:ik_start', 'ros2_package:ik_end', 'ros2_package:command_publish'):
+                # belongs to the tick that is running on this thread
+                if open_scopes[vtid] and open_scopes[vtid][-1]['callback'] == 'controller_tick':
+                    open_scopes[vtid][-1].setdefault(name.split(':')[1], ts)
+
+            elif name == 'ros2_package:tcp_publish':
+                self.tcp_publish.setdefault(stamp, ts)
+            elif name == 'ros2_package:marker_publish':
+                self.marker_publish.setdefault(stamp, ts)
+
+            # executor: waiting for work until it executes the next callback
+            elif name == 'ros2:rclcpp_executor_wait_for_work':
+                wait_start[vtid] = ts
+            elif name == 'ros2:rclcpp_executor_execute' and vtid in wait_start:
+                self.executor_waits[vtid].append(ts - wait_start.pop(vtid))
+
+
+    ##############################################################################
+    def controller_paths(self):
+
+        paths = []
+        for stamp, tick in self.first_tick.items():
+            if stamp not in self.read or stamp not in self.publish or stamp not in self.falcon_callback:
+                continue
+            if 'ik_start' not in tick or 'ik_end' not in tick or 'command_publish' not in tick:
+                continue
+            paths.append({
+                'stamp': stamp,
+                'device read -> publish': self.publish[stamp] - self.read[stamp],
+                'publish -> callback': self.falcon_callback[stamp] - self.publish[stamp],
+                'callback -> tick': tick['start'] - self.falcon_callback[stamp],
+                'tick -> IK': tick['ik_start'] - tick['start'],
+                'IK': tick['ik_end'] - tick['ik_start'],
+                'IK -> command': tick['command_publish'] - tick['ik_end'],
+                'total': tick['command_publish'] - self.read[stamp],
+            })
+        return paths
+
+    def marker_paths(self):
+
+        paths = []
+        for stamp, ts in self.tcp_publish.items():
+            if stamp not in self.marker_callback or stamp not in self.marker_publish:
+                continue
+            paths.append({
+                'stamp': stamp,
+                'tcp publish -> callback': self.marker_callback[stamp] - ts,
+                'callback -> marker publish': self.marker_publish[stamp] - self.marker_callback[stamp],
+                'total': self.marker_publish[stamp] - ts,
+            })
+        return paths
+
+
+##############################################################################
+def print_stats(name, values_ns):
+
+    if len(values_ns) == 0:
+        print("%-30s %8s" % (name, "no data"))
+        return
+
+    ms = np.array(values_ns) / 1e6
+    print("%-30s %8d %9.3f %9.3f %9.3f %9.3f %9.3f" %
+          (name, len(ms), ms.mean(), np.percentile(ms, 50), np.percentile(ms, 90), np.percentile(ms, 99), ms.max()))
+
+
+def print_header(title):
+    print("\n%-30s %8s %9s %9s %9s %9s %9s" % (title, "n", "mean", "p50", "p90", "p99", "max"))
+    print("-" * 90)
+
+
+def print_paths(title, paths):
+    print_header(title)
+    if not paths:
+        print("no complete paths in the trace")
+        return
+    for stage in paths[0]:
+        if stage != 'stamp':
+            print_stats(stage, [path[stage] for path in paths])
+
+
+##############################################################################
+def main():
+
+    parser = argparse.ArgumentParser(description="Critical paths and executor wait times from an LTTng trace")
+    parser.add_argument("trace", help="trace directory (e.g. ~/.ros/tracing/<session>)")
+    parser.add_argument("--csv", default="", help="also write the per-sample controller paths to this file")
+    args = parser.parse_args()
+
+    events = read_events(args.trace)
+    print("Read %d events from %s" % (len(events), args.trace))
+
+    analysis = TraceAnalysis(events)
+    controller_paths = analysis.controller_paths()
+
+    print_paths("controller path [ms]", controller_paths)
+    print_paths("marker path [ms]", analysis.marker_paths())
+
+    print_header("callback durations [ms]")
+    for name, durations in sorted(analysis.callback_durations.items()):
+        print_stats(name, durations)
+
+    if analysis.executor_waits:
+        print_header("executor wait per thread [ms]")
+        for vtid, waits in sorted(analysis.executor_waits.items()):
+            print_stats("vtid %d" % vtid, waits)
+    print()
+
+    if args.csv and controller_paths:
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=list(controller_paths[0].keys()))
+            writer.writeheader()
+            writer.writerows(controller_paths)
+        print("Wrote %d paths to %s" % (len(controller_paths), args.csv))
+
+
+if __name__ == '__main__':
+    main()
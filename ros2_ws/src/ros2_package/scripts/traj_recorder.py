@@ -8,6 +8,10 @@
 ##
 ## - The TrajRecorder subscribes to the positions of
 ##   human input, robot input, and the tcp pose
+##
+## - If the TcpStatePublisher is running, each sample also
+##   gets the newest measured tcp position (tcp_measured),
+##   i.e. where the robot actually was at that point
 ##   
 ## - Once the trial finishes, this node then creates
 ##   a DataLogger instance and passes all the recorded
@@ -21,8 +25,8 @@ from rclpy.node import Node
 
 from math import pi, sin
 
-from tutorial_interfaces.msg import Falconpos
-from tutorial_interfaces.msg import PosInfo
+from tutorial_interfaces.msg import PosInfoStamped, TcpStateStamped
+from rclpy.qos import qos_profile_sensor_data
 from std_msgs.msg import Bool
 
 from ros2_package.data_logger import DataLogger
@@ -57,9 +61,10 @@ TRAJ_DEPTH = 0.1
 class TrajRecorder(Node):
 
     ##############################################################################
-    def __init__(self):
+    def __init__(self, **kwargs):
 
-        super().__init__('traj_recorder')
+        # kwargs are passed on to the Node (e.g. parameter_overrides when driven by run_session.py)
+        super().__init__('traj_recorder', **kwargs)
 
         # parameter stuff
         self.param_names = ['free_drive', 'mapping_ratio', 'use_depth', 'part_id', 'alpha_id', 'traj_id']
@@ -91,9 +96,14 @@ class TrajRecorder(Node):
                                                               ORIGIN, self.use_depth)
 
         # tcp position subscriber
-        self.tcp_pos_sub = self.create_subscription(PosInfo, 'tcp_position', self.tcp_pos_callback, 10)
+        self.tcp_pos_sub = self.create_subscription(PosInfoStamped, 'tcp_position', self.tcp_pos_callback, 10)
         self.tcp_pos_sub  # prevent unused variable warning
 
+        # measured tcp subscriber (1 kHz, only the newest one is kept)
+        self.measured_sub = self.create_subscription(TcpStateStamped, 'tcp_measured', self.measured_callback, qos_profile_sensor_data)
+        self.measured_sub  # prevent unused variable warning
+        self.measured = None
+
         # record flag subscriber
         self.record_flag_sub = self.create_subscription(Bool, 'record', self.record_flag_callback, 10)
         self.record_flag_sub  # prevent unused variable warning
@@ -134,6 +144,10 @@ class TrajRecorder(Node):
         self.tys = []
         self.tzs = []
 
+        self.mxs = []
+        self.mys = []
+        self.mzs = []
+
         self.times_from_start = []
         self.times = []
         self.datetimes = []
@@ -163,6 +177,11 @@ class TrajRecorder(Node):
             self.tys.append(msg.tcp_position[1])
             self.tzs.append(msg.tcp_position[2])
 
+            if self.measured is not None:
+                self.mxs.append(self.measured[0])
+                self.mys.append(self.measured[1])
+                self.mzs.append(self.measured[2])
+
             self.times_from_start.append(msg.time_from_start)
             self.times.append(time())
             self.datetimes.append(datetime.now().strftime("%Y-%m-%d_%H-%M-%S"))
@@ -173,6 +192,11 @@ class TrajRecorder(Node):
                     self.data_written = True
 
 
+    ##############################################################################
+    def measured_callback(self, msg):
+        self.measured = msg.tcp_position
+
+
     ##############################################################################
     def record_flag_callback(self, msg):
         self.record = msg.data
@@ -187,7 +211,8 @@ class TrajRecorder(Node):
     def write_to_csv(self):
 
         dl = DataLogger(self.csv_dir, self.part_id, self.alpha_id, self.traj_id, self.refxs, self.refys, self.refzs, self.hxs, self.hys, self.hzs,
-                        self.rxs, self.rys, self.rzs, self.txs, self.tys, self.tzs, self.times_from_start, self.times, self.datetimes)
+                        self.rxs, self.rys, self.rzs, self.txs, self.tys, self.tzs, self.times_from_start, self.times, self.datetimes,
+                        self.mxs, self.mys, self.mzs)
 
         dl.calc_error(self.use_depth)
 
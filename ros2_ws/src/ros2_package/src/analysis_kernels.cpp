@@ -0,0 +1,62 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the batch kernels for the analysis
+//   (reference trajectory, tracking error, trajectory FK)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/analysis_kernels.hpp"
+
+#include <cmath>
+#include <vector>
+
+
+void reference_trajectory(const SineParams& sp, int use_depth, const double origin[3], std::size_t n_points, double* out)
+{
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  for (std::size_t k=0; k<n_points; k++) {
+    double t = (n_points > 1) ? 2 * M_PI * k / (n_points - 1) : 0.0;
+    get_reference_offset(t, sp, use_depth, ref);
+    for (int i=0; i<3; i++) out[3*k + i] = origin[i] + ref.at(i);
+  }
+}
+
+
+ErrorTotals tracking_error(const double* pos, const double* ref, std::size_t n_points, int use_depth,
+                           double* dim_err, double* err)
+{
+  ErrorTotals totals;
+  for (std::size_t k=0; k<n_points; k++) {
+    double e[3];
+    for (int i=0; i<3; i++) {
+      e[i] = std::abs(pos[3*k + i] - ref[3*k + i]);
+      totals.dim_total[i] += e[i];
+    }
+    double norm = std::sqrt((use_depth ? e[0] * e[0] : 0.0) + e[1] * e[1] + e[2] * e[2]);
+    totals.total += norm;
+
+    if (dim_err) for (int i=0; i<3; i++) dim_err[3*k + i] = e[i];
+    if (err) err[k] = norm;
+  }
+
+  if (n_points > 0) {
+    for (int i=0; i<3; i++) totals.dim_ave[i] = totals.dim_total[i] / n_points;
+    totals.ave = totals.total / n_points;
+  }
+  return totals;
+}
+
+
+void trajectory_fk(TcpKinematics& kinematics, const double* q, std::size_t n_points,
+                   double* position, double* orientation)
+{
+  const int n = kinematics.n_joints();
+  for (std::size_t k=0; k<n_points; k++) {
+    kinematics.compute(q + n*k, nullptr);
+    for (int i=0; i<3; i++) position[3*k + i] = kinematics.position[i];
+    if (orientation) for (int i=0; i<4; i++) orientation[4*k + i] = kinematics.orientation[i];
+  }
+}
@@ -0,0 +1,178 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the AsyncLogger, the ring is a
+//   bounded multi-producer queue (one sequence number per
+//   slot, as in D. Vyukov's bounded MPMC queue) drained by
+//   a single background thread
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/async_logger.hpp"
+
+#include <chrono>
+#include <cstdarg>
+
+
+const char* log_level_name(LogLevel level)
+{
+  switch (level) {
+    case LogLevel::DEBUG: return "DEBUG";
+    case LogLevel::INFO: return "INFO";
+    case LogLevel::WARN: return "WARN";
+    case LogLevel::ERROR: return "ERROR";
+  }
+  return "";
+}
+
+static int64_t steady_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/////////////////////////////// construction ///////////////////////////////
+AsyncLogger& AsyncLogger::instance()
+{
+  static AsyncLogger logger;
+  return logger;
+}
+
+AsyncLogger::AsyncLogger()
+{
+  for (size_t i=0; i<ring_size; i++) ring_.at(i).sequence.store(i, std::memory_order_relaxed);
+
+  // plain stdout until a node installs its own sink
+  sink_ = [](LogLevel, const char* message) {
+    fputs(message, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+  };
+
+  thread_ = std::thread(&AsyncLogger::drain_loop, this);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+  flush_and_stop();
+}
+
+
+/////////////////////////////// producers (control paths) ///////////////////////////////
+void AsyncLogger::log(LogLevel level, const char* format, ...)
+{
+  // claim a slot, or drop the message if the ring is full
+  size_t pos = head_.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  for (;;) {
+    slot = &ring_[pos & (ring_size - 1)];
+    size_t seq = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+    if (diff == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->stamp_ns = steady_ns();
+  slot->level = level;
+
+  va_list args;
+  va_start(args, format);
+  vsnprintf(slot->message, max_message_length, format, args);
+  va_end(args);
+
+  // hand the slot over to the background thread
+  slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool AsyncLogger::throttle(std::atomic<int64_t>& last_stamp, int64_t period_ms)
+{
+  int64_t now = steady_ns();
+  int64_t last = last_stamp.load(std::memory_order_relaxed);
+  if (last != 0 && now - last < period_ms * 1000000) return false;
+  return last_stamp.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+
+/////////////////////////////// configuration ///////////////////////////////
+void AsyncLogger::set_sink(Sink sink)
+{
+  std::lock_guard<std::mutex> lock(sink_mutex_);
+  sink_ = sink;
+}
+
+bool AsyncLogger::set_file(const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(sink_mutex_);
+  if (file_ != nullptr) fclose(file_);
+  file_ = nullptr;
+  if (path.empty()) return true;
+
+  file_ = fopen(path.c_str(), "a");
+  return file_ != nullptr;
+}
+
+
+/////////////////////////////// background thread ///////////////////////////////
+bool AsyncLogger::pop_and_write()
+{
+  Slot& slot = ring_[tail_ & (ring_size - 1)];
+  size_t seq = slot.sequence.load(std::memory_order_acquire);
+  if ((intptr_t) seq - (intptr_t) (tail_ + 1) < 0) return false;   // empty
+
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (sink_) sink_(slot.level, slot.message);
+    if (file_ != nullptr) fprintf(file_, "%.6f [%s] %s\n", slot.stamp_ns * 1e-9, log_level_name(slot.level), slot.message);
+  }
+
+  // free the slot for the producers, one lap later
+  slot.sequence.store(tail_ + ring_size, std::memory_order_release);
+  tail_++;
+  return true;
+}
+
+void AsyncLogger::drain_loop()
+{
+  uint64_t reported_dropped = 0;
+
+  while (running_.load(std::memory_order_acquire)) {
+    bool wrote = false;
+    while (pop_and_write()) wrote = true;
+
+    uint64_t n_dropped = dropped();
+    if (n_dropped != reported_dropped) {
+      std::lock_guard<std::mutex> lock(sink_mutex_);
+      std::string message = "AsyncLogger: " + std::to_string(n_dropped - reported_dropped) + " messages dropped (ring full)";
+      if (sink_) sink_(LogLevel::WARN, message.c_str());
+      reported_dropped = n_dropped;
+    }
+
+    if (!wrote) {
+      std::lock_guard<std::mutex> lock(sink_mutex_);
+      if (file_ != nullptr) fflush(file_);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(wrote ? 1 : 5));
+  }
+
+  // whatever is left after stopping
+  while (pop_and_write()) {}
+}
+
+void AsyncLogger::flush_and_stop()
+{
+  if (running_.exchange(false) && thread_.joinable()) thread_.join();
+
+  std::lock_guard<std::mutex> lock(sink_mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
@@ -0,0 +1,182 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the kinematic chain cache
+//
+// - Layout of the blob (native endianness, it never leaves the machine):
+//     header:   magic, version, urdf size, urdf mtime, number of segments
+//     segments: segment name, joint name, joint type,
+//               joint origin (3), joint axis (3),
+//               tip frame position (3) and rotation (9, row-major)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/shared_control.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+
+static const uint32_t cache_magic = 0x4b444c43;   // "KDLC"
+static const uint32_t cache_version = 1;
+
+
+/////////////////////////////// helpers ///////////////////////////////
+
+// size and modification time of the urdf, to tell whether the cache is stale
+static bool urdf_stamp(const std::string& urdf, uint64_t& size, int64_t& mtime)
+{
+  std::error_code ec;
+  size = std::filesystem::file_size(urdf, ec);
+  if (ec) return false;
+  mtime = std::filesystem::last_write_time(urdf, ec).time_since_epoch().count();
+  return !ec;
+}
+
+template<typename T>
+static void write_value(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool read_value(std::ifstream& in, T& value)
+{
+  return (bool) in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+static void write_string(std::ofstream& out, const std::string& s)
+{
+  write_value(out, (uint32_t) s.size());
+  out.write(s.data(), s.size());
+}
+
+static bool read_string(std::ifstream& in, std::string& s)
+{
+  uint32_t n = 0;
+  if (!read_value(in, n) || n > 1024) return false;
+  s.resize(n);
+  return (bool) in.read(&s[0], n);
+}
+
+static void write_vector(std::ofstream& out, const KDL::Vector& v)
+{
+  for (int i=0; i<3; i++) write_value(out, v(i));
+}
+
+static bool read_vector(std::ifstream& in, KDL::Vector& v)
+{
+  for (int i=0; i<3; i++) {
+    if (!read_value(in, v(i))) return false;
+  }
+  return true;
+}
+
+
+/////////////////////////////// cache file ///////////////////////////////
+
+std::string default_chain_cache_path(const std::string& urdf)
+{
+  return urdf + ".chain";
+}
+
+bool save_chain_cache(const KDL::Chain& chain, const std::string& urdf, const std::string& cache_path)
+{
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  if (!urdf_stamp(urdf, size, mtime)) return false;
+
+  // write next to the cache and rename, so a crash never leaves a half-written blob behind
+  std::string tmp_path = cache_path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) return false;
+
+  write_value(out, cache_magic);
+  write_value(out, cache_version);
+  write_value(out, size);
+  write_value(out, mtime);
+  write_value(out, (uint32_t) chain.getNrOfSegments());
+
+  for (unsigned int k=0; k<chain.getNrOfSegments(); k++) {
+    const KDL::Segment& segment = chain.getSegment(k);
+    const KDL::Joint& joint = segment.getJoint();
+    KDL::Frame tip = segment.getFrameToTip();
+
+    write_string(out, segment.getName());
+    write_string(out, joint.getName());
+    write_value(out, (int32_t) joint.getType());
+    write_vector(out, joint.JointOrigin());
+    write_vector(out, joint.JointAxis());
+    write_vector(out, tip.p);
+    for (int i=0; i<9; i++) write_value(out, tip.M.data[i]);
+  }
+
+  out.close();
+  if (!out) return false;
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, cache_path, ec);
+  return !ec;
+}
+
+bool load_chain_cache(const std::string& urdf, const std::string& cache_path, KDL::Chain& chain)
+{
+  std::ifstream in(cache_path, std::ios::binary);
+  if (!in.is_open()) return false;
+
+  uint32_t magic = 0, version = 0, n_segments = 0;
+  uint64_t size = 0, urdf_size = 0;
+  int64_t mtime = 0, urdf_mtime = 0;
+  if (!read_value(in, magic) || magic != cache_magic) return false;
+  if (!read_value(in, version) || version != cache_version) return false;
+  if (!read_value(in, size) || !read_value(in, mtime) || !read_value(in, n_segments)) return false;
+
+  // stale if the urdf changed since (a missing urdf is fine, the cache is all we need)
+  if (urdf_stamp(urdf, urdf_size, urdf_mtime) && (urdf_size != size || urdf_mtime != mtime)) return false;
+
+  KDL::Chain result;
+  for (uint32_t k=0; k<n_segments; k++) {
+    std::string segment_name, joint_name;
+    int32_t type = 0;
+    KDL::Vector origin, axis;
+    KDL::Frame tip;
+
+    if (!read_string(in, segment_name) || !read_string(in, joint_name) || !read_value(in, type)) return false;
+    if (!read_vector(in, origin) || !read_vector(in, axis) || !read_vector(in, tip.p)) return false;
+    for (int i=0; i<9; i++) {
+      if (!read_value(in, tip.M.data[i])) return false;
+    }
+
+    // kdl_parser only makes axis joints (revolute / prismatic) and fixed ones
+    KDL::Joint::JointType joint_type = (KDL::Joint::JointType) type;
+    if (joint_type == KDL::Joint::RotAxis || joint_type == KDL::Joint::TransAxis) {
+      result.addSegment(KDL::Segment(segment_name, KDL::Joint(joint_name, origin, axis, joint_type), tip));
+    } else {
+      result.addSegment(KDL::Segment(segment_name, KDL::Joint(joint_name, joint_type), tip));
+    }
+  }
+
+  if (result.getNrOfJoints() != n_joints) return false;
+  chain = result;
+  return true;
+}
+
+bool load_panda_chain(const std::string& urdf, KDL::Chain& chain, bool* from_cache)
+{
+  const std::string cache_path = default_chain_cache_path(urdf);
+  bool cached = load_chain_cache(urdf, cache_path, chain);
+  if (from_cache != nullptr) *from_cache = cached;
+  if (cached) return true;
+
+  KDL::Tree panda_tree;
+  if (!create_tree(urdf, panda_tree)) return false;
+  get_chain(panda_tree, chain);
+
+  if (!save_chain_cache(chain, urdf, cache_path)) std::cout << "Unable to write the chain cache: " << cache_path << std::endl;
+  return true;
+}
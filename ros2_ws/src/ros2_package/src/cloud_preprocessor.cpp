@@ -0,0 +1,176 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - C++ class implementation of the CloudPreprocessor node,
+//   which turns the full-resolution Kinect cloud into a
+//   small one of the task workspace, for RViz (and anything
+//   else that only cares about the workspace)
+//
+// - Main functionalities:
+//   1. Subscribes to the raw cloud ("points2", in depth_camera_link)
+//   2. Moves it into panda_link0 with the ConstBr extrinsics
+//      (camera_extrinsics.hpp), set once, no tf lookups
+//   3. Crops it to a box around the task-space origin and
+//      voxel-downsamples it (voxel_filter.hpp, multi-threaded)
+//   4. Publishes the result ("points_workspace", in panda_link0)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/point_cloud2.hpp"
+#include "sensor_msgs/msg/point_field.hpp"
+
+#include "ros2_package/camera_extrinsics.hpp"
+#include "ros2_package/point_cloud_layout.hpp"
+#include "ros2_package/voxel_filter.hpp"
+
+
+class CloudPreprocessor : public rclcpp::Node
+{
+public:
+
+  //////// KEEP CONSISTENT WITH REAL CONTROLLER ////////
+  std::vector<double> origin {0.5059, 0.0, 0.4346};
+
+  // crop box around the origin (down to just below the table top) and voxel size, in [m]
+  std::vector<double> crop_half_size {0.45, 0.55, 0.45};
+  double voxel_size {0.01};
+  int num_threads {0};      // 0 = one per core
+
+  std::string input_topic {"points2"};
+  std::string output_topic {"points_workspace"};
+
+  const int report_every = 100;   // clouds between the timing reports
+
+  CloudPreprocessor()
+  : Node("cloud_preprocessor")
+  {
+    input_topic = this->declare_parameter("input_topic", input_topic);
+    output_topic = this->declare_parameter("output_topic", output_topic);
+    crop_half_size = this->declare_parameter("crop_half_size", crop_half_size);
+    voxel_size = this->declare_parameter("voxel_size", voxel_size);
+    num_threads = this->declare_parameter("num_threads", num_threads);
+
+    double lower[3], upper[3];
+    for (int j=0; j<3; j++) {
+      lower[j] = origin.at(j) - crop_half_size.at(j);
+      upper[j] = origin.at(j) + crop_half_size.at(j);
+    }
+    filter_ = std::make_unique<VoxelFilter>(lower, upper, voxel_size, num_threads);
+
+    // the camera does not move, so its pose is applied as a plain matrix
+    tf2::Transform camera_tf = depth_camera_in_panda();
+    tf2::Matrix3x3 basis = camera_tf.getBasis();
+    double rotation[9];
+    double translation[3] = {camera_tf.getOrigin().x(), camera_tf.getOrigin().y(), camera_tf.getOrigin().z()};
+    for (int i=0; i<3; i++) {
+      for (int j=0; j<3; j++) rotation[3*i + j] = basis[i][j];
+    }
+    filter_->set_transform(rotation, translation);
+
+    // the output layout never changes, only the points
+    out_msg.header.frame_id = panda_base_frame;
+    out_msg.height = 1;
+    out_msg.is_bigendian = false;
+    out_msg.is_dense = true;
+    out_msg.point_step = 3 * sizeof(float);
+    const char* names[3] = {"x", "y", "z"};
+    for (int j=0; j<3; j++) {
+      sensor_msgs::msg::PointField field;
+      field.name = names[j];
+      field.offset = j * sizeof(float);
+      field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+      field.count = 1;
+      out_msg.fields.push_back(field);
+    }
+
+    // reliable keep-last-1 out (what RViz asks for), best effort in (newest cloud only)
+    cloud_pub_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(output_topic, rclcpp::QoS(1));
+    cloud_sub_ = this->create_subscription<sensor_msgs::msg::PointCloud2>(
+      input_topic, rclcpp::SensorDataQoS(), std::bind(&CloudPreprocessor::cloud_callback, this, std::placeholders::_1));
+
+    std::cout << "Cropping " << input_topic << " to [" << lower[0] << ", " << upper[0] << "] x [" << lower[1] << ", " << upper[1]
+              << "] x [" << lower[2] << ", " << upper[2] << "] in " << panda_base_frame << ", " << voxel_size * 100 << " cm voxels, "
+              << filter_->n_threads() << " threads -> " << output_topic << std::endl;
+  }
+
+private:
+
+  ///////////////////////////////////// RAW CLOUD SUBSCRIBER /////////////////////////////////////
+  void cloud_callback(const sensor_msgs::msg::PointCloud2 & msg)
+  {
+    // only the depth camera's own frame is known without tf
+    if (msg.header.frame_id != depth_camera_frame) {
+      warn_once("the cloud is in " + msg.header.frame_id + ", expected " + depth_camera_frame);
+      return;
+    }
+
+    int x_offset = packed_xyz_offset(msg);
+    if (x_offset < 0) {
+      warn_once("the cloud needs packed little-endian float32 x, y, z fields");
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t n_in = (std::size_t) msg.width * msg.height;
+    std::size_t n_out = filter_->filter(msg.data.data(), n_in, msg.point_step, x_offset, points);
+
+    out_msg.header.stamp = msg.header.stamp;
+    out_msg.width = n_out;
+    out_msg.row_step = n_out * out_msg.point_step;
+    out_msg.data.resize(out_msg.row_step);
+    std::memcpy(out_msg.data.data(), points.data(), out_msg.row_step);
+    cloud_pub_->publish(out_msg);
+
+    ///////// timing report /////////
+    time_sum += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    points_in_sum += n_in;
+    points_out_sum += n_out;
+    if (++n_clouds % report_every == 0) {
+      std::cout << "Last " << report_every << " clouds: " << time_sum / report_every << " ms each, "
+                << points_in_sum / report_every << " -> " << points_out_sum / report_every << " points" << std::endl;
+      time_sum = 0.0;
+      points_in_sum = points_out_sum = 0;
+    }
+  }
+
+  void warn_once(const std::string & what)
+  {
+    if (warned) return;
+    warned = true;
+    std::cout << "Dropping the clouds on " << input_topic << ": " << what << std::endl;
+  }
+
+  std::unique_ptr<VoxelFilter> filter_;
+  std::vector<float> points;
+  sensor_msgs::msg::PointCloud2 out_msg;
+  bool warned = false;
+
+  long n_clouds = 0;
+  double time_sum = 0.0;
+  std::size_t points_in_sum = 0;
+  std::size_t points_out_sum = 0;
+
+  rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_pub_;
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_sub_;
+};
+
+
+
+int main(int argc, char * argv[])
+{
+  // initialize node and spin it
+  rclcpp::init(argc, argv);
+  rclcpp::spin(std::make_shared<CloudPreprocessor>());
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,53 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the CollisionMap (self spheres,
+//   hand-over of the clouds to the OccupancyMap)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/collision_map.hpp"
+#include "ros2_package/async_logger.hpp"
+
+#include <cstring>
+
+
+CollisionMap::CollisionMap(const std::vector<double>& origin, const std::vector<double>& half_size, double voxel_size, double clearance)
+{
+  double lower[3], upper[3];
+  for (int j=0; j<3; j++) {
+    lower[j] = origin.at(j) - half_size.at(j);
+    upper[j] = origin.at(j) + half_size.at(j);
+  }
+  occupancy_ = std::make_unique<OccupancyMap>(lower, upper, voxel_size, clearance);
+}
+
+void CollisionMap::submit(const uint8_t* data, std::size_t n_points, SharedControlCore & core, const double sensor[3])
+{
+  cloud_points.resize(3 * n_points);
+  std::memcpy(cloud_points.data(), data, cloud_points.size() * sizeof(float));
+
+  // every link origin and the point between it and the next one, the gripper gets a bigger one
+  core.compute_link_positions(core.curr_joint_vals, link_positions);
+  std::size_t n_links = link_positions.size() / 3;
+  self_spheres.clear();
+  for (std::size_t k=0; k<n_links; k++) {
+    bool tcp = (k + 1 == n_links);
+    for (int j=0; j<3; j++) self_spheres.push_back(link_positions.at(3*k + j));
+    self_spheres.push_back(tcp ? tcp_sphere_radius : link_sphere_radius);
+    if (tcp) break;
+    for (int j=0; j<3; j++) self_spheres.push_back(0.5 * (link_positions.at(3*k + j) + link_positions.at(3*(k+1) + j)));
+    self_spheres.push_back(link_sphere_radius);
+  }
+
+  occupancy_->submit(cloud_points, sensor, self_spheres);
+}
+
+void CollisionMap::report(int n_clamped) const
+{
+  ASYNC_LOG_INFO("Collision map: %d clamped ticks, %ld snapshots (%ld skipped, %.2f ms per cloud), %d occupied voxels",
+                 n_clamped, occupancy_->n_snapshots(), occupancy_->n_skipped(),
+                 occupancy_->mean_integration_ms(), occupancy_->n_occupied());
+}
@@ -10,6 +10,9 @@
 //   of the point cloud in the robot's frame
 //
 // - Used for rendering the task scene in RViz
+//
+// - The transforms themselves are in camera_extrinsics.hpp,
+//   shared with the CloudPreprocessor
 //////////////////////////////////////////////////////
 //////////////////////////////////////////////////////
 
@@ -20,32 +23,13 @@
 #include "tf2/LinearMath/Quaternion.h"
 #include "tf2_ros/static_transform_broadcaster.h"
 
-#include "angles/angles.h"
-
-
-
-#define DEPTH_CAMERA_OFFSET_MM_X 0.0f
-#define DEPTH_CAMERA_OFFSET_MM_Y 0.0f
-#define DEPTH_CAMERA_OFFSET_MM_Z 1.8f  // The depth camera is shifted 1.8mm up in the depth window
+#include "ros2_package/camera_extrinsics.hpp"
 
 
 class ConstBr : public rclcpp::Node
 {
 public:
 
-  std::string panda_base_frame = "panda_link0";
-  std::string camera_base_frame = "camera_base";
-  std::string depth_camera_frame = "depth_camera_link";
-
-  // define transformation values
-  // note: TF does translation before rotation
-  double dx = 1.22;
-  double dy = 0.6;
-  double dz = 1.15;
-  double rx = deg2rad(183);
-  double ry = deg2rad(30);
-  double rz = deg2rad(212);
-
   ConstBr()
   : Node("const_br")
   {
@@ -67,14 +51,15 @@ private:
     t.header.frame_id = panda_base_frame;
     t.child_frame_id = camera_base_frame;
 
+    tf2::Transform base_tf = camera_base_in_panda();
+
     // translations
-    t.transform.translation.x = dx;
-    t.transform.translation.y = dy;
-    t.transform.translation.z = dz;
+    t.transform.translation.x = base_tf.getOrigin().x();
+    t.transform.translation.y = base_tf.getOrigin().y();
+    t.transform.translation.z = base_tf.getOrigin().z();
 
     // rotations
-    tf2::Quaternion q;
-    q.setRPY(rx, ry, rz);
+    tf2::Quaternion q = base_tf.getRotation();
     t.transform.rotation.x = q.x();
     t.transform.rotation.y = q.y();
     t.transform.rotation.z = q.z();
@@ -85,19 +70,21 @@ private:
 
   void publishDepthToBaseTf()
   {
-    // This is a purely cosmetic transform to make the base model of the URDF look good.
     geometry_msgs::msg::TransformStamped static_transform;
 
     static_transform.header.stamp = this->get_clock()->now();
     static_transform.header.frame_id = camera_base_frame;
     static_transform.child_frame_id = depth_camera_frame;
 
-    tf2::Vector3 depth_translation = getDepthToBaseTranslationCorrection();
+    // This is a purely cosmetic transform to make the base model of the URDF look good.
+    tf2::Transform depth_tf = depth_camera_in_camera_base();
+
+    tf2::Vector3 depth_translation = depth_tf.getOrigin();
     static_transform.transform.translation.x = depth_translation.x();
     static_transform.transform.translation.y = depth_translation.y();
     static_transform.transform.translation.z = depth_translation.z();
 
-    tf2::Quaternion depth_rotation = getDepthToBaseRotationCorrection();
+    tf2::Quaternion depth_rotation = depth_tf.getRotation();
     static_transform.transform.rotation.x = depth_rotation.x();
     static_transform.transform.rotation.y = depth_rotation.y();
     static_transform.transform.rotation.z = depth_rotation.z();
@@ -106,30 +93,6 @@ private:
     tf_static_broadcaster_->sendTransform(static_transform);
   }
 
-  tf2::Vector3 getDepthToBaseTranslationCorrection()
-  {
-    // These are purely cosmetic tranformations for the URDF drawing!!
-    return tf2::Vector3(DEPTH_CAMERA_OFFSET_MM_X / 1000.0f, DEPTH_CAMERA_OFFSET_MM_Y / 1000.0f,
-                        DEPTH_CAMERA_OFFSET_MM_Z / 1000.0f);
-  }
-
-  tf2::Quaternion getDepthToBaseRotationCorrection()
-  {
-    // These are purely cosmetic tranformations for the URDF drawing!!
-    tf2::Quaternion ros_camera_rotation;  // ROS camera co-ordinate system requires rotating the entire camera relative to
-                                          // camera_base
-    tf2::Quaternion depth_rotation;       // K4A has one physical camera that is about 6 degrees downward facing.
-
-    depth_rotation.setEuler(0, angles::from_degrees(-6.0), 0);
-    ros_camera_rotation.setEuler(M_PI / -2.0f, M_PI, (M_PI / 2.0f));
-
-    return ros_camera_rotation * depth_rotation;
-  }
-
-  double deg2rad(double deg) {
-    return (deg / 180) * M_PI;
-  }
-
   std::shared_ptr<tf2_ros::StaticTransformBroadcaster> tf_static_broadcaster_;
 
 };
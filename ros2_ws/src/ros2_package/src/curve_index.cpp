@@ -0,0 +1,140 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the CurveIndex (nearest point on
+//   the reference trajectory) and the curve sampling
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/curve_index.hpp"
+#include "ros2_package/shared_control.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+/////////////////////////////// building the grid ///////////////////////////////
+CurveIndex::CurveIndex(const std::vector<double>& a_vertices, double a_cell_size, double margin)
+: vertices(a_vertices),
+  cell_size(a_cell_size)
+{
+  // bounding box of the curve plus the margin
+  double upper[3];
+  for (int j=0; j<3; j++) {
+    lower[j] = std::numeric_limits<double>::max();
+    upper[j] = std::numeric_limits<double>::lowest();
+  }
+  for (size_t i=0; i<vertices.size(); i+=3) {
+    for (int j=0; j<3; j++) {
+      lower[j] = std::min(lower[j], vertices[i+j]);
+      upper[j] = std::max(upper[j], vertices[i+j]);
+    }
+  }
+  for (int j=0; j<3; j++) {
+    lower[j] -= margin;
+    dims[j] = std::max(1, (int) std::ceil((upper[j] + margin - lower[j]) / cell_size));
+  }
+
+  // a query q in a cell is at most e from its center c, so its nearest segment is at most
+  // d(c, nearest) + e away from q, and at most d(c, nearest) + 2e from c: those are the candidates
+  const double e = 0.5 * cell_size * std::sqrt(3.0);
+  const int n_seg = n_segments();
+  std::vector<double> d2(n_seg);
+
+  cell_start.assign(1, 0);
+  for (int ix=0; ix<dims[0]; ix++) {
+    for (int iy=0; iy<dims[1]; iy++) {
+      for (int iz=0; iz<dims[2]; iz++) {
+        double c[3] = {lower[0] + (ix + 0.5) * cell_size, lower[1] + (iy + 0.5) * cell_size, lower[2] + (iz + 0.5) * cell_size};
+        double u;
+        double d_min2 = std::numeric_limits<double>::max();
+        for (int s=0; s<n_seg; s++) {
+          d2[s] = segment_distance2(s, c, u);
+          d_min2 = std::min(d_min2, d2[s]);
+        }
+        double bound = std::sqrt(d_min2) + 2 * e;
+        for (int s=0; s<n_seg; s++) {
+          if (d2[s] <= bound * bound) cell_segments.push_back(s);
+        }
+        cell_start.push_back(cell_segments.size());
+      }
+    }
+  }
+}
+
+
+/////////////////////////////// queries ///////////////////////////////
+double CurveIndex::segment_distance2(int s, const double q[3], double& u) const
+{
+  const double* a = &vertices[3*s];
+  const double* b = &vertices[3*s + 3];
+  double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  double aq[3] = {q[0] - a[0], q[1] - a[1], q[2] - a[2]};
+
+  double len2 = ab[0]*ab[0] + ab[1]*ab[1] + ab[2]*ab[2];
+  u = (len2 > 0.0) ? (aq[0]*ab[0] + aq[1]*ab[1] + aq[2]*ab[2]) / len2 : 0.0;
+  u = std::min(1.0, std::max(0.0, u));
+
+  double d[3] = {aq[0] - u * ab[0], aq[1] - u * ab[1], aq[2] - u * ab[2]};
+  return d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+}
+
+int CurveIndex::cell_of(const double q[3]) const
+{
+  int idx[3];
+  for (int j=0; j<3; j++) {
+    double f = (q[j] - lower[j]) / cell_size;
+    if (f < 0.0 || f >= dims[j]) return -1;
+    idx[j] = (int) f;
+  }
+  return (idx[0] * dims[1] + idx[1]) * dims[2] + idx[2];
+}
+
+double CurveIndex::nearest(const double q[3], double closest[3], double tangent[3]) const
+{
+  int c = cell_of(q);
+  int first = (c >= 0) ? cell_start[c] : 0;
+  int last = (c >= 0) ? cell_start[c+1] : n_segments();
+
+  int best_s = 0;
+  double best_u = 0.0;
+  double best_d2 = std::numeric_limits<double>::max();
+  for (int k=first; k<last; k++) {
+    int s = (c >= 0) ? cell_segments[k] : k;
+    double u;
+    double d2 = segment_distance2(s, q, u);
+    if (d2 < best_d2) {
+      best_d2 = d2;
+      best_s = s;
+      best_u = u;
+    }
+  }
+
+  const double* a = &vertices[3*best_s];
+  const double* b = &vertices[3*best_s + 3];
+  double len = std::sqrt((b[0]-a[0])*(b[0]-a[0]) + (b[1]-a[1])*(b[1]-a[1]) + (b[2]-a[2])*(b[2]-a[2]));
+  for (int j=0; j<3; j++) {
+    closest[j] = a[j] + best_u * (b[j] - a[j]);
+    tangent[j] = (len > 0.0) ? (b[j] - a[j]) / len : 0.0;
+  }
+  return std::sqrt(best_d2);
+}
+
+
+/////////////////////////////// the reference in Falcon coordinates ///////////////////////////////
+std::vector<double> sample_reference_curve(int traj_id, int use_depth, double mapping_ratio, int n_samples)
+{
+  SineParams sp = get_sine_params(traj_id);
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  std::vector<double> curve;
+  curve.reserve(3 * (n_samples + 1));
+
+  for (int i=0; i<=n_samples; i++) {
+    get_reference_offset(2 * M_PI * i / n_samples, sp, use_depth, ref);
+    for (int j=0; j<3; j++) curve.push_back(ref.at(j) / mapping_ratio);
+  }
+  return curve;
+}
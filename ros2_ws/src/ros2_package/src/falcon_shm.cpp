@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the Falcon shared-memory channel
+//   (falcon_shm.hpp): segment setup, the seqlock and the
+//   polling reader of the controllers
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/falcon_shm.hpp"
+#include "ros2_package/async_logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+
+
+static const uint32_t falcon_shm_magic = 0x464c434e;   // "FLCN"
+static const uint32_t falcon_shm_version = 1;
+static const int max_read_retries = 16;
+
+
+/////////////////////////////// seqlock ///////////////////////////////
+static void write_slot(FalconShmSlot & slot, const FalconShmSample & sample)
+{
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  slot.seq.store(seq + 1, std::memory_order_relaxed);     // odd: being written
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.index.store(sample.index, std::memory_order_relaxed);
+  slot.stamp_ns.store(sample.stamp_ns, std::memory_order_relaxed);
+  slot.x.store(sample.x, std::memory_order_relaxed);
+  slot.y.store(sample.y, std::memory_order_relaxed);
+  slot.z.store(sample.z, std::memory_order_relaxed);
+
+  slot.seq.store(seq + 2, std::memory_order_release);     // even: consistent again
+}
+
+// a writer that died between the two stores of write_slot() leaves the sequence odd, which would flip the parity
+// of every later write: finish that write with an empty sample (index 0, which no reader accepts) instead
+static void recover_slot(FalconShmSlot & slot)
+{
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  if (!(seq & 1)) return;
+
+  const FalconShmSample empty;
+  slot.index.store(empty.index, std::memory_order_relaxed);
+  slot.stamp_ns.store(empty.stamp_ns, std::memory_order_relaxed);
+  slot.x.store(empty.x, std::memory_order_relaxed);
+  slot.y.store(empty.y, std::memory_order_relaxed);
+  slot.z.store(empty.z, std::memory_order_relaxed);
+
+  slot.seq.store(seq + 1, std::memory_order_release);
+}
+
+static bool read_slot(const FalconShmSlot & slot, FalconShmSample & sample)
+{
+  for (int i=0; i<max_read_retries; i++) {
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq & 1) continue;
+
+    sample.index = slot.index.load(std::memory_order_relaxed);
+    sample.stamp_ns = slot.stamp_ns.load(std::memory_order_relaxed);
+    sample.x = slot.x.load(std::memory_order_relaxed);
+    sample.y = slot.y.load(std::memory_order_relaxed);
+    sample.z = slot.z.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) return true;
+  }
+  return false;
+}
+
+
+/////////////////////////////// writer ///////////////////////////////
+FalconShmWriter::FalconShmWriter(const std::string & a_name)
+: name(a_name)
+{
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd < 0) {
+    std::cout << "Unable to create the shared memory segment " << name << std::endl;
+    return;
+  }
+
+  struct stat st;
+  bool reuse = (fstat(fd, &st) == 0 && st.st_size == (off_t) sizeof(FalconShmSegment));
+  if (!reuse && ftruncate(fd, sizeof(FalconShmSegment)) != 0) {
+    std::cout << "Unable to size the shared memory segment " << name << std::endl;
+    close(fd);
+    return;
+  }
+
+  void* addr = mmap(nullptr, sizeof(FalconShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    std::cout << "Unable to map the shared memory segment " << name << std::endl;
+    return;
+  }
+  segment = static_cast<FalconShmSegment*>(addr);
+
+  // the previous talker may have died in the middle of a write, every slot has to be even before writing again
+  recover_slot(segment->newest);
+  for (int i=0; i<falcon_shm_history; i++) recover_slot(segment->history[i]);
+
+  // keep a segment of the same version (readers may have it mapped already), otherwise start from scratch
+  if (!reuse || segment->magic.load(std::memory_order_acquire) != falcon_shm_magic || segment->version != falcon_shm_version) {
+    segment->magic.store(0, std::memory_order_relaxed);
+    segment->version = falcon_shm_version;
+    segment->count.store(0, std::memory_order_relaxed);
+    write_slot(segment->newest, FalconShmSample());
+    for (int i=0; i<falcon_shm_history; i++) write_slot(segment->history[i], FalconShmSample());
+    segment->magic.store(falcon_shm_magic, std::memory_order_release);
+  }
+}
+
+FalconShmWriter::~FalconShmWriter()
+{
+  if (segment) munmap(segment, sizeof(FalconShmSegment));
+}
+
+void FalconShmWriter::write(int64_t stamp_ns, double x, double y, double z)
+{
+  if (!segment) return;
+
+  FalconShmSample sample;
+  sample.index = segment->count.load(std::memory_order_relaxed) + 1;
+  sample.stamp_ns = stamp_ns;
+  sample.x = x;
+  sample.y = y;
+  sample.z = z;
+
+  write_slot(segment->history[(sample.index - 1) % falcon_shm_history], sample);
+  write_slot(segment->newest, sample);
+  segment->count.store(sample.index, std::memory_order_release);
+}
+
+
+/////////////////////////////// reader ///////////////////////////////
+FalconShmReader::FalconShmReader(const std::string & a_name)
+: name(a_name)
+{
+}
+
+FalconShmReader::~FalconShmReader()
+{
+  if (segment) munmap(const_cast<FalconShmSegment*>(segment), sizeof(FalconShmSegment));
+}
+
+bool FalconShmReader::open()
+{
+  if (segment) return true;
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size != (off_t) sizeof(FalconShmSegment)) {
+    close(fd);
+    return false;
+  }
+
+  void* addr = mmap(nullptr, sizeof(FalconShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) return false;
+
+  const FalconShmSegment* candidate = static_cast<const FalconShmSegment*>(addr);
+  if (candidate->magic.load(std::memory_order_acquire) != falcon_shm_magic || candidate->version != falcon_shm_version) {
+    munmap(addr, sizeof(FalconShmSegment));
+    return false;
+  }
+  segment = candidate;
+  return true;
+}
+
+bool FalconShmReader::read_newest(FalconShmSample & sample) const
+{
+  if (!segment) return false;
+  return read_slot(segment->newest, sample) && sample.index > 0;
+}
+
+int FalconShmReader::read_history(int n, std::vector<FalconShmSample> & samples) const
+{
+  samples.clear();
+  if (!segment) return 0;
+
+  uint64_t count = segment->count.load(std::memory_order_acquire);
+  n = std::min<uint64_t>(std::min(n, falcon_shm_history), count);
+
+  // walk back from the newest one, each slot has to still hold the expected sample
+  samples.resize(n);
+  int got = 0;
+  for (int k=0; k<n; k++) {
+    uint64_t index = count - k;
+    FalconShmSample & sample = samples.at(n - 1 - k);
+    if (!read_slot(segment->history[(index - 1) % falcon_shm_history], sample) || sample.index != index) break;
+    got++;
+  }
+  samples.erase(samples.begin(), samples.begin() + (n - got));
+  return got;
+}
+
+
+/////////////////////////////// polling reader ///////////////////////////////
+FalconShmPoller::FalconShmPoller(const std::string & a_name, int a_retry_polls)
+: reader(a_name),
+  retry_polls(a_retry_polls)
+{
+}
+
+bool FalconShmPoller::poll(FalconShmSample & sample)
+{
+  if (!reader.is_open()) {
+    // the talker may come up later
+    if (open_wait-- > 0) return false;
+    open_wait = retry_polls;
+    if (!reader.open()) return false;
+    ASYNC_LOG_INFO("Reading the Falcon input from shared memory %s", reader.name.c_str());
+  }
+
+  if (!reader.read_newest(sample) || sample.index == last_index) return false;
+  last_index = sample.index;
+  last_sample = std::chrono::steady_clock::now();
+  return true;
+}
+
+bool FalconShmPoller::fresh(int max_age_ms) const
+{
+  if (last_index == 0) return false;
+  return std::chrono::steady_clock::now() - last_sample < std::chrono::milliseconds(std::max(max_age_ms, 1));
+}
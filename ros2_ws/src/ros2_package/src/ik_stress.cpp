@@ -0,0 +1,309 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Offline stress test of the controller's IK, for setting
+//   control_freq and the IK budget from data
+//
+// - Main functionalities:
+//   1. Replays every reference trajectory (traj_id x use_depth)
+//      at the control rate, once on its own and once per
+//      recorded human in csv_logs (same traj_id), for each
+//      alpha_id and mapping_ratio
+//   2. Calls compute_ik() on an approximation of the controller's
+//      target: the convex combination of human and reference
+//      offsets around the origin (no authority scaling, occupancy
+//      clamp or robot noise), warm-started from the last solution
+//      (ideal plant), in the orientation of the first IK, and
+//      from a converged solution at the first curve point, where
+//      the approach leaves the robot
+//   3. Counts the Newton-Raphson iterations and the solve time
+//      of every point, and the failures (no convergence, or
+//      outside the joint limits)
+//   4. Spreads the runs over a pool of worker threads, each
+//      owning its own controller core, and writes a summary
+//      per run, every failure and optionally every point
+//
+// - Human model of trial_log.hpp, as in the sweep_simulator:
+//   the hand-space error of a recorded trial, (human - ref)
+//   / recorded_ratio, on top of the reference and scaled by
+//   the mapping_ratio
+//
+// - The solve times are wall-clock times on a shared machine:
+//   for the tail percentiles, run with at most one thread per
+//   physical core and nothing else busy
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tool_args.hpp"
+#include "ros2_package/trial_log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/////////////////// stress settings (overridable from the command line) ///////////////////
+struct StressSettings
+{
+  std::string urdf {urdf_path};
+  std::string csv_dir {""};
+  std::string out_file {"ik_stress.csv"};
+  std::string failures_file {"ik_stress_failures.csv"};
+  std::string points_file {""};    // every point, off by default (a few million rows)
+  unsigned int threads {std::max(1u, std::thread::hardware_concurrency())};
+
+  std::vector<int> alpha_ids {1, 2, 3, 4, 5};
+  std::vector<int> traj_ids {0, 1, 2, 3, 4, 5};
+  std::vector<int> use_depths {0, 1};
+  std::vector<double> mapping_ratios {2.0, 3.0, 4.0};
+  std::vector<double> origin {};   // the core's if empty
+
+  int humans_per_traj {5};         // recorded trials per traj_id
+  double recorded_ratio {3.0};     // mapping_ratio the trials in csv_logs were recorded with
+};
+
+struct StressRun
+{
+  int alpha_id;
+  int traj_id;
+  int use_depth;
+  double mapping_ratio;
+  int human;     // -1 = the reference alone
+};
+
+// one IK call
+struct StressPoint
+{
+  int iterations;
+  float time_us;
+  bool failed;
+  float target[3];
+};
+
+struct StressResult
+{
+  std::vector<StressPoint> points;
+  int failures = 0;
+};
+
+
+/////////////////// one run along the whole trajectory ///////////////////
+StressResult run_stress(SharedControlCore& core, const StressRun& run, const std::vector<HumanModel>& humans)
+{
+  StressResult res;
+  core.start_trial(run.alpha_id, run.traj_id, run.use_depth, run.mapping_ratio);
+  const HumanModel* human = (run.human >= 0) ? &humans.at(run.human) : nullptr;
+
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  std::vector<double> err {0.0, 0.0, 0.0};
+  std::vector<double> target = core.origin;
+  const double alphas[3] = {core.ax, core.ay, core.az};
+  const int n_points = core.max_recording_count;
+
+  // the convex combination of the tick at curve point k, with the reference as the robot's offset
+  auto set_target = [&](int k) {
+    get_reference_offset(2 * M_PI * k / n_points, core.sine, run.use_depth, ref);
+    if (human) interpolate_log(human->times, human->hand_err, (double) k / core.control_freq, err);
+    for (size_t i=0; i<3; i++) {
+      double human_offset = ref.at(i) + run.mapping_ratio * err.at(i);
+      target.at(i) = core.origin.at(i) + alphas[i] * human_offset + (1 - alphas[i]) * ref.at(i);
+    }
+  };
+
+  // the first IK of the trial: from home to the origin, which also fixes the tcp orientation
+  std::vector<double> q(n_joints, 0.0);
+  core.compute_ik(core.origin, home_joint_vals, q);
+
+  // the approach and the float leave the robot converged at the first curve point: not part of the stats
+  std::vector<double> seed(n_joints, 0.0);
+  set_target(0);
+  core.compute_ik(target, q, seed);
+
+  res.points.reserve(n_points);
+  for (int k=0; k<n_points; k++) {
+    set_target(k);
+    core.compute_ik(target, seed, q);
+    bool failed = core.ik_error < 0 || !within_limits(q);
+    res.points.push_back({core.ik_iterations, (float) core.ik_time_us, failed,
+                          {(float) target.at(0), (float) target.at(1), (float) target.at(2)}});
+    if (failed) res.failures++;
+
+    // ideal plant: the joints are where they were commanded at the next tick
+    seed.swap(q);
+  }
+  return res;
+}
+
+
+/////////////////// percentiles ///////////////////
+template <typename T>
+T percentile(std::vector<T>& vals, double p)
+{
+  if (vals.empty()) return T();
+  size_t idx = (size_t) (p / 100.0 * (vals.size() - 1));
+  std::nth_element(vals.begin(), vals.begin() + idx, vals.end());
+  return vals.at(idx);
+}
+
+
+/////////////////// command line parsing ///////////////////
+bool parse_args(int argc, char * argv[], StressSettings& settings)
+{
+  bool ok = parse_key_values(argc, argv, [&](const std::string& key, const std::string& value) {
+      if (key == "--urdf") settings.urdf = value;
+      else if (key == "--csv_dir") settings.csv_dir = value;
+      else if (key == "--out") settings.out_file = value;
+      else if (key == "--failures") settings.failures_file = value;
+      else if (key == "--points") settings.points_file = value;
+      else if (key == "--threads") settings.threads = std::max(1, std::stoi(value));
+      else if (key == "--alpha_ids") settings.alpha_ids = parse_list<int>(value);
+      else if (key == "--traj_ids") settings.traj_ids = parse_list<int>(value);
+      else if (key == "--use_depth") settings.use_depths = parse_list<int>(value);
+      else if (key == "--mapping_ratios") settings.mapping_ratios = parse_list<double>(value);
+      else if (key == "--origin") settings.origin = parse_list<double>(value);
+      else if (key == "--humans_per_traj") settings.humans_per_traj = std::stoi(value);
+      else if (key == "--recorded_ratio") settings.recorded_ratio = std::stod(value);
+      else return false;
+      return true;
+    });
+  if (!ok) return false;
+  if (!check_ids("--alpha_ids", settings.alpha_ids, alphas_dict.size()) || !check_ids("--traj_ids", settings.traj_ids, n_traj_ids)) return false;
+  if (!settings.origin.empty() && settings.origin.size() != 3) {
+    std::cerr << "The origin needs x,y,z" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+//////////////////// MAIN FUNCTION ///////////////////
+
+int main(int argc, char * argv[])
+{
+  StressSettings settings;
+  if (!parse_args(argc, argv, settings)) {
+    std::cerr << "usage: ik_stress [--csv_dir DIR] [--threads N] [--alpha_ids 1,2,..] [--traj_ids 0,1,..] [--use_depth 0,1]\n"
+              << "                 [--mapping_ratios 2.0,3.0,..] [--origin x,y,z] [--humans_per_traj N] [--recorded_ratio R]\n"
+              << "                 [--out FILE] [--failures FILE] [--points FILE] [--urdf FILE]" << std::endl;
+    return 1;
+  }
+
+  // the kinematic chain is loaded once (from the cache if up to date) and copied into every worker's core
+  KDL::Chain panda_chain;
+  if (!load_panda_chain(settings.urdf, panda_chain)) return 1;
+
+  // load the human models once per trajectory
+  std::vector< std::vector<HumanModel> > humans_per_traj(n_traj_ids);
+  for (int traj_id : settings.traj_ids) humans_per_traj.at(traj_id) = load_human_models(settings.csv_dir, traj_id, settings.humans_per_traj, settings.recorded_ratio);
+
+  // all runs: each trajectory on its own and with every human
+  std::vector<StressRun> runs;
+  for (int alpha_id : settings.alpha_ids)
+    for (int traj_id : settings.traj_ids)
+      for (int use_depth : settings.use_depths)
+        for (double mapping_ratio : settings.mapping_ratios)
+          for (int human = -1; human < (int) humans_per_traj.at(traj_id).size(); human++)
+            runs.push_back({alpha_id, traj_id, use_depth, mapping_ratio, human});
+
+  std::cout << "Running " << runs.size() << " trajectories on " << settings.threads << " threads ..." << std::endl;
+
+  // each worker owns a core and pulls the next run, results are written to their own slot
+  std::vector<StressResult> results(runs.size());
+  std::atomic<size_t> next_run {0};
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned int w=0; w<settings.threads; w++) {
+    workers.emplace_back([&]() {
+      SharedControlCore core(panda_chain);
+      if (!settings.origin.empty()) core.origin = settings.origin;
+
+      for (size_t r = next_run++; r < runs.size(); r = next_run++) {
+        const StressRun& run = runs.at(r);
+        results.at(r) = run_stress(core, run, humans_per_traj.at(run.traj_id));
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  auto finish = std::chrono::steady_clock::now();
+  double duration = std::chrono::duration<double>(finish - start).count();
+
+  ///////// per run summary, failures and (optionally) every point /////////
+  std::ofstream out(settings.out_file);
+  out << "alpha_id,traj_id,use_depth,mapping_ratio,human,points,failures,iter_mean,iter_p99,iter_max,"
+         "time_mean_us,time_p50_us,time_p99_us,time_p999_us,time_max_us\n";
+  std::ofstream failures_out(settings.failures_file);
+  failures_out << "alpha_id,traj_id,use_depth,mapping_ratio,human,point,target_x,target_y,target_z,iterations,time_us\n";
+  std::ofstream points_out;
+  if (!settings.points_file.empty()) {
+    points_out.open(settings.points_file);
+    points_out << "alpha_id,traj_id,use_depth,mapping_ratio,human,point,iterations,time_us,failed\n";
+  }
+
+  std::vector<int> all_iterations;
+  std::vector<float> all_times;
+  long n_points = 0, n_failures = 0;
+
+  for (size_t r=0; r<runs.size(); r++) {
+    const StressRun& run = runs.at(r);
+    const StressResult& res = results.at(r);
+    std::string key = std::to_string(run.alpha_id) + "," + std::to_string(run.traj_id) + "," + std::to_string(run.use_depth) + ","
+                      + std::to_string(run.mapping_ratio) + "," + std::to_string(run.human);
+
+    std::vector<int> iterations;
+    std::vector<float> times;
+    double iter_sum = 0.0, time_sum = 0.0;
+    for (size_t k=0; k<res.points.size(); k++) {
+      const StressPoint& p = res.points.at(k);
+      iterations.push_back(p.iterations);
+      times.push_back(p.time_us);
+      iter_sum += p.iterations;
+      time_sum += p.time_us;
+      if (p.failed) {
+        failures_out << key << "," << k << "," << p.target[0] << "," << p.target[1] << "," << p.target[2] << ","
+                     << p.iterations << "," << p.time_us << "\n";
+      }
+      if (points_out.is_open()) points_out << key << "," << k << "," << p.iterations << "," << p.time_us << "," << p.failed << "\n";
+    }
+    all_iterations.insert(all_iterations.end(), iterations.begin(), iterations.end());
+    all_times.insert(all_times.end(), times.begin(), times.end());
+    n_points += res.points.size();
+    n_failures += res.failures;
+
+    size_t n = std::max<size_t>(1, res.points.size());
+    int iter_max = iterations.empty() ? 0 : *std::max_element(iterations.begin(), iterations.end());
+    float time_max = times.empty() ? 0.0f : *std::max_element(times.begin(), times.end());
+    out << key << "," << res.points.size() << "," << res.failures << "," << iter_sum / n << "," << percentile(iterations, 99) << ","
+        << iter_max << "," << time_sum / n << "," << percentile(times, 50) << "," << percentile(times, 99) << ","
+        << percentile(times, 99.9) << "," << time_max << "\n";
+  }
+
+  ///////// overall, against the control period /////////
+  SharedControlCore reference_core(panda_chain);
+  const double period_us = 1e6 / reference_core.control_freq;
+  float p999 = percentile(all_times, 99.9);
+  float time_max = all_times.empty() ? 0.0f : *std::max_element(all_times.begin(), all_times.end());
+
+  std::cout << "\n" << n_points << " IK calls, " << n_failures << " failures" << std::endl;
+  std::cout << "Iterations: p50 = " << percentile(all_iterations, 50) << ", p99 = " << percentile(all_iterations, 99)
+            << ", p99.9 = " << percentile(all_iterations, 99.9)
+            << ", max = " << (all_iterations.empty() ? 0 : *std::max_element(all_iterations.begin(), all_iterations.end())) << std::endl;
+  std::cout << "Solve time [us]: p50 = " << percentile(all_times, 50) << ", p99 = " << percentile(all_times, 99)
+            << ", p99.9 = " << p999 << ", max = " << time_max << std::endl;
+  std::cout << "At " << reference_core.control_freq << " Hz (" << period_us << " us per tick) the IK takes "
+            << 100.0 * p999 / period_us << " % of the tick at p99.9 and " << 100.0 * time_max / period_us << " % at worst" << std::endl;
+  std::cout << "Finished in " << duration << " seconds, results written to " << settings.out_file << " and "
+            << settings.failures_file << std::endl;
+  return 0;
+}
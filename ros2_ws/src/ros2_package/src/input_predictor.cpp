@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the InputPredictor
+//   (constant-acceleration Kalman filter per axis)
+//   and of the TickPrediction
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/input_predictor.hpp"
+
+#include <algorithm>
+
+
+InputPredictor::InputPredictor(double a_jerk_psd, double a_meas_std)
+: jerk_psd(a_jerk_psd),
+  meas_var(a_meas_std * a_meas_std)
+{
+  reset();
+}
+
+void InputPredictor::reset()
+{
+  n_updates = 0;
+  last_stamp_ns = 0;
+  for (Axis& axis : axes) start_axis(axis, 0.0);
+}
+
+// at rest at z, with ~1 m/s and ~10 m/s^2 of uncertainty on the motion
+void InputPredictor::start_axis(Axis& axis, double z) const
+{
+  axis.x[0] = z;
+  axis.x[1] = 0.0;
+  axis.x[2] = 0.0;
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++) axis.P[i][j] = 0.0;
+  }
+  axis.P[0][0] = meas_var;
+  axis.P[1][1] = 1.0;
+  axis.P[2][2] = 100.0;
+}
+
+
+/////////////////////////////// filter update ///////////////////////////////
+void InputPredictor::update(int64_t stamp_ns, const std::vector<double>& z)
+{
+  double dt = (stamp_ns - last_stamp_ns) * 1e-9;
+  bool restart = (n_updates == 0 || dt > max_gap);
+  dt = std::max(dt, 0.0);   // a repeated (or out-of-order) stamp only refines the current state
+
+  for (int j=0; j<3; j++) {
+    if (restart) start_axis(axes[j], z.at(j));
+    else update_axis(axes[j], dt, z.at(j));
+  }
+  if (stamp_ns > last_stamp_ns || restart) last_stamp_ns = stamp_ns;
+  n_updates++;
+}
+
+void InputPredictor::update_axis(Axis& axis, double dt, double z) const
+{
+  double (&x)[3] = axis.x;
+  double (&P)[3][3] = axis.P;
+
+  ///////// predict: x = F x, P = F P F' + Q /////////
+  const double dt2 = dt * dt;
+  const double F[3][3] = {{1.0, dt, 0.5 * dt2}, {0.0, 1.0, dt}, {0.0, 0.0, 1.0}};
+  const double Q[3][3] = {
+    {jerk_psd * dt2 * dt2 * dt / 20, jerk_psd * dt2 * dt2 / 8, jerk_psd * dt2 * dt / 6},
+    {jerk_psd * dt2 * dt2 / 8,       jerk_psd * dt2 * dt / 3,  jerk_psd * dt2 / 2},
+    {jerk_psd * dt2 * dt / 6,        jerk_psd * dt2 / 2,       jerk_psd * dt}
+  };
+
+  double xp[3];
+  double FP[3][3];
+  for (int i=0; i<3; i++) {
+    xp[i] = F[i][0] * x[0] + F[i][1] * x[1] + F[i][2] * x[2];
+    for (int j=0; j<3; j++) FP[i][j] = F[i][0] * P[0][j] + F[i][1] * P[1][j] + F[i][2] * P[2][j];
+  }
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++) P[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2] + Q[i][j];
+  }
+
+  ///////// correct with the position sample (H = [1 0 0]) /////////
+  const double S = P[0][0] + meas_var;
+  const double K[3] = {P[0][0] / S, P[1][0] / S, P[2][0] / S};
+  const double innovation = z - xp[0];
+  for (int i=0; i<3; i++) x[i] = xp[i] + K[i] * innovation;
+
+  const double P0[3] = {P[0][0], P[0][1], P[0][2]};
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++) P[i][j] -= K[i] * P0[j];
+  }
+}
+
+
+/////////////////////////////// prediction ///////////////////////////////
+double InputPredictor::predict(int64_t t_ns, std::vector<double>& out) const
+{
+  double h = std::min(std::max((t_ns - last_stamp_ns) * 1e-9, 0.0), max_horizon);
+  if (n_updates == 0) h = 0.0;
+
+  for (int j=0; j<3; j++) {
+    const double* x = axes[j].x;
+    out.at(j) = x[0] + h * x[1] + 0.5 * h * h * x[2];
+  }
+  return h;
+}
+
+
+/////////////////////////////// prediction of the control tick ///////////////////////////////
+bool TickPrediction::apply(int64_t now_ns, std::vector<double>& offset)
+{
+  if (!predictor.started()) return false;
+
+  // horizon = how old the newest sample is right now + the lookahead (capped by the predictor)
+  measured_offset = offset;
+  horizon_sum += predictor.predict(now_ns + (int64_t) (lookahead_ms * 1e6), offset);
+  n++;
+  return true;
+}
+
+void TickPrediction::reset()
+{
+  predictor.reset();
+  horizon_sum = 0.0;
+  n = 0;
+}
@@ -0,0 +1,112 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the jerk-limited profiles, following
+//   the rest-to-rest "double S" trajectory of Biagiotti &
+//   Melchiorri (Trajectory Planning for Automatic Machines
+//   and Robots, ch. 3.4)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/jerk_limited_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+/////////////////////////////// planning ///////////////////////////////
+void JerkLimitedProfile::plan(double distance, double v_max, double a_max, double j_max)
+{
+  h = std::max(distance, 0.0);
+  T = Ta = Tv = Tj = 0.0;
+  j_lim = a_lim = v_lim = 0.0;
+  if (h <= 0.0 || v_max <= 0.0 || a_max <= 0.0 || j_max <= 0.0) return;
+
+  // assume v_max is reached
+  if (v_max * j_max >= a_max * a_max) {
+    Tj = a_max / j_max;
+    Ta = Tj + v_max / a_max;
+  } else {
+    Tj = sqrt(v_max / j_max);
+    Ta = 2 * Tj;
+  }
+  Tv = h / v_max - Ta;
+
+  if (Tv < 0.0) {
+    // v_max is not reached, assume a_max still is
+    Tv = 0.0;
+    Tj = a_max / j_max;
+    Ta = (a_max * a_max / j_max + sqrt(pow(a_max, 4) / (j_max * j_max) + 4 * h * a_max)) / (2 * a_max);
+
+    // a_max is not reached either
+    if (Ta < 2 * Tj) {
+      Tj = cbrt(h / (2 * j_max));
+      Ta = 2 * Tj;
+    }
+  }
+
+  j_lim = j_max;
+  a_lim = j_max * Tj;
+  v_lim = (Ta - Tj) * a_lim;
+  T = 2 * Ta + Tv;
+}
+
+
+/////////////////////////////// sampling ///////////////////////////////
+double JerkLimitedProfile::accel_position(double t) const
+{
+  if (t < Tj) return j_lim * t * t * t / 6;
+  if (t < Ta - Tj) return a_lim / 6 * (3 * t * t - 3 * Tj * t + Tj * Tj);
+  return v_lim * Ta / 2 - v_lim * (Ta - t) + j_lim * pow(Ta - t, 3) / 6;
+}
+
+double JerkLimitedProfile::position(double t) const
+{
+  if (t <= 0.0) return 0.0;
+  if (t >= T) return h;
+
+  if (t < Ta) return accel_position(t);
+  if (t < Ta + Tv) return v_lim * Ta / 2 + v_lim * (t - Ta);
+
+  // the deceleration phase mirrors the acceleration phase
+  return h - accel_position(T - t);
+}
+
+
+/////////////////////////////// normalized multi-dimensional moves ///////////////////////////////
+JerkLimitedProfile plan_joint_profile(const std::vector<double>& q0, const std::vector<double>& q1, const LimitScales& scales)
+{
+  // limits on s = [0, 1] are the joint limits divided by each joint's distance, the slowest joint decides
+  double v_max = std::numeric_limits<double>::infinity();
+  double a_max = v_max;
+  double j_max = v_max;
+  bool moving = false;
+
+  for (size_t i=0; i<q0.size(); i++) {
+    double dq = std::abs(q1.at(i) - q0.at(i));
+    if (dq < 1e-9) continue;
+    moving = true;
+    v_max = std::min(v_max, scales.velocity * fr3_velocity_limits.at(i) / dq);
+    a_max = std::min(a_max, scales.acceleration * fr3_acceleration_limits.at(i) / dq);
+    j_max = std::min(j_max, scales.jerk * fr3_jerk_limits.at(i) / dq);
+  }
+
+  JerkLimitedProfile profile;
+  if (moving) profile.plan(1.0, v_max, a_max, j_max);
+  return profile;
+}
+
+JerkLimitedProfile plan_cartesian_profile(double distance, const LimitScales& scales)
+{
+  JerkLimitedProfile profile;
+  if (distance < 1e-9) return profile;
+
+  profile.plan(1.0,
+               scales.velocity * fr3_cartesian_velocity_limit / distance,
+               scales.acceleration * fr3_cartesian_acceleration_limit / distance,
+               scales.jerk * fr3_cartesian_jerk_limit / distance);
+  return profile;
+}
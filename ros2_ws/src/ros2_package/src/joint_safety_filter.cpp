@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the JointSafetyFilter
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/joint_safety_filter.hpp"
+#include "ros2_package/jerk_limited_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+JointSafetyFilter::JointSafetyFilter(const std::vector<double>& a_lower, const std::vector<double>& a_upper, double a_dt,
+                                     double a_limit_scale, double a_position_margin)
+: dt(a_dt),
+  limit_scale(a_limit_scale),
+  position_margin(a_position_margin),
+  lower(a_lower),
+  upper(a_upper)
+{
+  for (size_t i=0; i<lower.size(); i++) {
+    v_max.push_back(limit_scale * fr3_velocity_limits.at(i));
+    a_max.push_back(limit_scale * fr3_acceleration_limits.at(i));
+    j_max.push_back(limit_scale * fr3_jerk_limits.at(i));
+  }
+  q_prev.assign(lower.size(), 0.0);
+  v_prev.assign(lower.size(), 0.0);
+  a_prev.assign(lower.size(), 0.0);
+  target_prev.assign(lower.size(), 0.0);
+}
+
+
+// fastest velocity from which it can still stop within distance d, braking at a in steps of dt after going on for
+// ramp seconds (the jerk limit keeps the acceleration from flipping at once): v ramp + v (v + a dt) / 2a = d
+static inline double braking_velocity(double a, double d, double dt, double ramp)
+{
+  const double b = a * (dt + 2 * ramp);
+  return 0.5 * (std::sqrt(b * b + 8 * a * d) - b);
+}
+
+
+double JointSafetyFilter::apply(std::vector<double>& q)
+{
+  if (!started) {
+    q_prev = q;
+    target_prev = q;
+    std::fill(v_prev.begin(), v_prev.end(), 0.0);
+    std::fill(a_prev.begin(), a_prev.end(), 0.0);
+    started = true;
+    return 0.0;
+  }
+
+  double deviation = 0.0;
+  for (size_t i=0; i<q.size(); i++) {
+    const double A = a_max[i];
+    const double ramp = A / j_max[i];   // from full acceleration to none
+
+    // velocity to aim for: the command's own, plus closing the gap to it no faster than it can brake
+    // (for a command it is already on, that is exactly the command's velocity)
+    double target_velocity = (q[i] - target_prev[i]) / dt;
+    double gap = q[i] - q_prev[i] - target_velocity * dt;
+    double closing = std::min(std::abs(gap) / dt, braking_velocity(A, std::abs(gap), dt, ramp));
+    double v_goal = target_velocity + std::copysign(closing, gap);
+
+    // velocity bounds: the limit, and stopping before the soft position limits (never further out than it already is)
+    double room_up = std::max(upper[i] - position_margin - q_prev[i], 0.0);
+    double room_down = std::max(q_prev[i] - lower[i] - position_margin, 0.0);
+    double v_hi = std::min(v_max[i], braking_velocity(A, room_up, dt, ramp));
+    double v_lo = std::max(-v_max[i], -braking_velocity(A, room_down, dt, ramp));
+
+    // acceleration bounds: the limit and the jerk limit, then the velocity bounds on top if they can be met
+    double a_hi = std::min(A, a_prev[i] + j_max[i] * dt);
+    double a_lo = std::max(-A, a_prev[i] - j_max[i] * dt);
+    double a_hi_v = (v_hi - v_prev[i]) / dt;
+    double a_lo_v = (v_lo - v_prev[i]) / dt;
+    double hi = std::max(std::min(a_hi, a_hi_v), a_lo);
+    double lo = std::min(std::max(a_lo, a_lo_v), hi);
+
+    double a = std::clamp((v_goal - v_prev[i]) / dt, lo, hi);
+    double v = v_prev[i] + a * dt;
+
+    target_prev[i] = q[i];
+    q_prev[i] += v * dt;
+    v_prev[i] = v;
+    a_prev[i] = a;
+
+    deviation = std::max(deviation, std::abs(q_prev[i] - q[i]));
+    q[i] = q_prev[i];
+  }
+  return deviation;
+}
@@ -0,0 +1,166 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the RViz marker builders of the
+//   MarkerPublisher (markers.hpp)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/markers.hpp"
+
+#include <cmath>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "geometry_msgs/msg/point.hpp"
+
+
+/////////////////////////////////// FUNCTIONS TO GENERATE REFERENCE BALL ///////////////////////////////////
+void generate_ref_ball(visualization_msgs::msg::Marker &ref_marker, double x, double y, double z, double d,
+                       visualization_msgs::msg::Marker &traj_marker)
+{
+  // fill-in the tcp_marker message
+  ref_marker.header.frame_id = "/panda_link0";
+  ref_marker.header.stamp = rclcpp::Clock().now();
+  ref_marker.ns = "marker_publisher";
+  ref_marker.action = visualization_msgs::msg::Marker::ADD;
+  ref_marker.id = 0;
+  ref_marker.type = visualization_msgs::msg::Marker::SPHERE;
+
+  // diameters of the sphere in x, y, z directions [cm]
+  double my_size = 0.015 + d/20;
+  ref_marker.scale.x = my_size;
+  ref_marker.scale.y = my_size;
+  ref_marker.scale.z = my_size;
+
+  // sphere is green
+  ref_marker.color.g = 1.0;
+  ref_marker.color.a = 0.35;
+  
+  if (x == 0.0) {
+    // use first point of traj_marker_
+    ref_marker.pose.position.x = traj_marker.points.at(0).x;
+    ref_marker.pose.position.y = traj_marker.points.at(0).y;
+    ref_marker.pose.position.z = traj_marker.points.at(0).z;
+  } else {
+    // use the reading from "robot position"
+    ref_marker.pose.position.x = x;
+    ref_marker.pose.position.y = y;
+    ref_marker.pose.position.z = z;
+  }
+}
+
+
+/////////////////////////////////// FUNCTIONS TO GENERATE TCP MARKER ///////////////////////////////////
+void generate_tcp_marker(visualization_msgs::msg::Marker &tcp_marker) 
+{
+  // fill-in the tcp_marker message
+  tcp_marker.header.frame_id = "/panda_hand_tcp";
+  tcp_marker.header.stamp = rclcpp::Clock().now();
+  tcp_marker.ns = "marker_publisher";
+  tcp_marker.action = visualization_msgs::msg::Marker::ADD;
+  tcp_marker.id = 1;
+  tcp_marker.type = visualization_msgs::msg::Marker::SPHERE;
+
+  // diameters of the sphere in x, y, z directions [cm]
+  tcp_marker.scale.x = 0.015;
+  tcp_marker.scale.y = 0.015;
+  tcp_marker.scale.z = 0.015;
+
+  // sphere is red
+  tcp_marker.color.r = 1.0;
+  tcp_marker.color.a = 1.0;
+  
+  // zero offset from the panda tcp link frame
+  tcp_marker.pose.position.x = 0.0;
+  tcp_marker.pose.position.y = 0.0;
+  tcp_marker.pose.position.z = 0.0;
+}
+
+
+/////////////////////////////////// FUNCTIONS TO GENERATE COUNTDOWN TEXT ///////////////////////////////////
+visualization_msgs::msg::Marker generate_countdown(int count, std::vector<double> &center)
+{ 
+  auto text = visualization_msgs::msg::Marker();
+
+  // fill-in the text message
+  text.header.frame_id = "/panda_link0";
+  text.header.stamp = rclcpp::Clock().now();
+  text.ns = "marker_publisher";
+  text.action = visualization_msgs::msg::Marker::ADD;
+  text.id = 10;
+  text.type = visualization_msgs::msg::Marker::TEXT_VIEW_FACING;
+
+  // height of 'A' is 20 cm
+  text.scale.z = 0.2;
+
+  // set text color and opacity
+  switch (count) {
+    case 5: text.color.r = 1.0; break;
+    case 4: text.color.r = 1.0; break;
+    case 3: text.color.r = 1.0; break;
+    case 2: text.color.r = 1.0; text.color.g = 1.0; break;
+    case 1: text.color.r = 1.0; text.color.g = 1.0; break;
+    case 0: text.color.g = 1.0; break;
+  }
+  text.color.a = 1.0;
+
+  text.text = std::to_string(count);
+
+  if (count == 0) {
+    text.text = "Go!";
+  }
+  if (count == -10) {
+    text.text = "Stop!";
+    text.color.r = 1.0;
+  }
+
+  // constant offset from panda base link
+  text.pose.position.x = center.at(0);
+  text.pose.position.y = center.at(1);
+  text.pose.position.z = center.at(2) + 0.05;
+
+  return text;
+}
+
+
+/////////////////////////////////// FUNCTIONS TO GENERATE REFERENCE TRAJECTORY MARKERS ///////////////////////////////////
+void generate_traj_marker(visualization_msgs::msg::Marker &traj_marker, std::vector<double> &origin, int max_points,
+                          double pa, double pb, double pc, double ps, double ph, double height, double width, double depth, int use_depth)
+{
+  // fill-in the traj_marker message
+  traj_marker.header.frame_id = "/panda_link0";
+  traj_marker.header.stamp = rclcpp::Clock().now();
+  traj_marker.ns = "marker_publisher";
+  traj_marker.action = visualization_msgs::msg::Marker::ADD;
+  traj_marker.id = 2;
+  traj_marker.type = visualization_msgs::msg::Marker::LINE_STRIP;
+
+  // LINE_STRIP/LINE_LIST markers use only the x component of scale, for the line width
+  traj_marker.scale.x = 0.015;  // make this 1.5 cm
+
+  // Line strip is blue
+  traj_marker.color.b = 1.0;
+  traj_marker.color.a = 0.2;
+
+  // Create the vertices for the points and lines
+  for (int count=0; count<=max_points; count++) {
+
+    double t = (double) count / max_points * 2 * M_PI;   // parametrized in the range [0, 2pi]
+
+    double x = 0.0;
+    if (use_depth) x = abs(t-M_PI) / M_PI * depth - (depth/2);
+    
+    double y = t / (2*M_PI) * width - (width/2);
+    double z = (ph*height) * (sin(pa*(t+ps)) + sin(pb*(t+ps)) + sin(pc*(t+ps)));
+
+    geometry_msgs::msg::Point p;
+    p.x = x + origin.at(0);
+    p.y = y + origin.at(1);
+    p.z = z + origin.at(2);
+
+    traj_marker.points.push_back(p);
+  }
+}
@@ -0,0 +1,329 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the OccupancyMap (cloud integration
+//   on the worker thread, snapshot pool, queries)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/occupancy_map.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+
+// log-odds in fixed point: two hits make a voxel occupied, it takes a few free sightings to clear it again
+static const int hit = 6;
+static const int miss = -2;
+static const int min_log_odds = -20;
+static const int max_log_odds = 40;
+static const int occupied_threshold = 8;
+
+static const int max_clamp_steps = 64;     // checks along the way to a target
+static const int clamp_iterations = 10;    // binary search steps back from the first blocked one
+
+
+OccupancyMap::OccupancyMap(const double a_lower[3], const double a_upper[3], double a_voxel_size, double a_clearance)
+: voxel_size(a_voxel_size),
+  clearance(a_clearance)
+{
+  for (int j=0; j<3; j++) {
+    lower[j] = a_lower[j];
+    dims[j] = std::max(1, (int) std::ceil((a_upper[j] - a_lower[j]) / voxel_size));
+  }
+  n_voxels = (long) dims[0] * dims[1] * dims[2];
+  inflation = (int) std::ceil(clearance / voxel_size);
+
+  log_odds.assign(n_voxels, 0);
+  dilate_tmp.assign(n_voxels, 0);
+  for (int b=0; b<n_buffers; b++) {
+    buffers[b].blocked.assign(n_voxels, 0);
+    readers[b].store(0);
+  }
+
+  worker = std::thread(&OccupancyMap::worker_loop, this);
+}
+
+OccupancyMap::~OccupancyMap()
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    stop = true;
+  }
+  pending_cv.notify_one();
+  worker.join();
+}
+
+
+/////////////////////////////// hand-over ///////////////////////////////
+void OccupancyMap::submit(const std::vector<float>& points, const double sensor[3], const std::vector<double>& self_spheres)
+{
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    pending_points = points;
+    for (int j=0; j<3; j++) pending_sensor[j] = sensor[j];
+    pending_spheres = self_spheres;
+    has_pending = true;
+  }
+  pending_cv.notify_one();
+}
+
+void OccupancyMap::worker_loop()
+{
+  std::vector<float> points;
+  std::vector<double> spheres;
+  double sensor[3];
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(pending_mutex);
+      pending_cv.wait(lock, [this]() {return has_pending || stop;});
+      if (stop) return;
+      points.swap(pending_points);
+      spheres.swap(pending_spheres);
+      for (int j=0; j<3; j++) sensor[j] = pending_sensor[j];
+      has_pending = false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    integrate(points, sensor, spheres);
+    publish();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    integration_ms_sum.store(integration_ms_sum.load(std::memory_order_relaxed) + ms, std::memory_order_relaxed);
+  }
+}
+
+
+/////////////////////////////// integration (worker) ///////////////////////////////
+void OccupancyMap::integrate(const std::vector<float>& points, const double sensor[3], const std::vector<double>& self_spheres)
+{
+  const std::size_t n_points = points.size() / 3;
+  const std::size_t n_spheres = self_spheres.size() / 4;
+
+  auto on_robot = [&](const double p[3]) {
+    for (std::size_t s=0; s<n_spheres; s++) {
+      const double* c = &self_spheres[4*s];
+      double d2 = (p[0] - c[0]) * (p[0] - c[0]) + (p[1] - c[1]) * (p[1] - c[1]) + (p[2] - c[2]) * (p[2] - c[2]);
+      if (d2 < c[3] * c[3]) return true;
+    }
+    return false;
+  };
+
+  ///////// free space: walk every ray from the sensor, voxel by voxel, up to its point /////////
+  for (std::size_t i=0; i<n_points; i++) {
+    const double p[3] = {points[3*i], points[3*i + 1], points[3*i + 2]};
+    if (on_robot(p)) continue;
+
+    // clip the ray to the box (slabs), the sensor itself is usually outside of it
+    double d[3] = {p[0] - sensor[0], p[1] - sensor[1], p[2] - sensor[2]};
+    double t_enter = 0.0, t_exit = 1.0;
+    for (int j=0; j<3; j++) {
+      double upper = lower[j] + dims[j] * voxel_size;
+      if (std::abs(d[j]) < 1e-12) {
+        if (sensor[j] < lower[j] || sensor[j] >= upper) t_enter = 2.0;
+        continue;
+      }
+      double t0 = (lower[j] - sensor[j]) / d[j];
+      double t1 = (upper - sensor[j]) / d[j];
+      t_enter = std::max(t_enter, std::min(t0, t1));
+      t_exit = std::min(t_exit, std::max(t0, t1));
+    }
+    if (t_enter >= t_exit) continue;
+
+    // voxel traversal (Amanatides & Woo) from the entry point to the voxel of p
+    int idx[3], end[3], step[3];
+    double t_max[3], t_delta[3];
+    for (int j=0; j<3; j++) {
+      double start = sensor[j] + t_enter * d[j];
+      idx[j] = std::clamp((int) std::floor((start - lower[j]) / voxel_size), 0, dims[j] - 1);
+      end[j] = (int) std::floor((p[j] - lower[j]) / voxel_size);
+      step[j] = (d[j] > 0) ? 1 : -1;
+      if (std::abs(d[j]) < 1e-12) {
+        t_max[j] = t_delta[j] = std::numeric_limits<double>::max();
+        continue;
+      }
+      double boundary = lower[j] + (idx[j] + (step[j] > 0 ? 1 : 0)) * voxel_size;
+      t_max[j] = (boundary - sensor[j]) / d[j];
+      t_delta[j] = voxel_size / std::abs(d[j]);
+    }
+
+    while (t_enter < t_exit) {
+      if (idx[0] == end[0] && idx[1] == end[1] && idx[2] == end[2]) break;
+      long v = ((long) idx[0] * dims[1] + idx[1]) * dims[2] + idx[2];
+      log_odds[v] = std::max(min_log_odds, log_odds[v] + miss);
+
+      int j = (t_max[0] < t_max[1]) ? ((t_max[0] < t_max[2]) ? 0 : 2) : ((t_max[1] < t_max[2]) ? 1 : 2);
+      t_enter = t_max[j];
+      t_max[j] += t_delta[j];
+      idx[j] += step[j];
+      if (idx[j] < 0 || idx[j] >= dims[j]) break;
+    }
+  }
+
+  ///////// occupied: the voxels holding the points /////////
+  for (std::size_t i=0; i<n_points; i++) {
+    const double p[3] = {points[3*i], points[3*i + 1], points[3*i + 2]};
+    long v = voxel_of(p);
+    if (v < 0 || on_robot(p)) continue;
+    log_odds[v] = std::min(max_log_odds, log_odds[v] + hit);
+  }
+}
+
+// box dilation by k voxels along one axis (stride = distance between neighbours along it)
+static void dilate_axis(const uint8_t* in, uint8_t* out, long n, long stride, int length, int k)
+{
+  for (long v=0; v<n; v++) {
+    int i = (v / stride) % length;
+    uint8_t value = 0;
+    for (int o=std::max(-k, -i); o<=std::min(k, length - 1 - i) && !value; o++) value = in[v + o * stride];
+    out[v] = value;
+  }
+}
+
+void OccupancyMap::publish()
+{
+  // a buffer that is neither published nor pinned by a reader
+  int current = published.load();
+  int b = -1;
+  for (int k=0; k<n_buffers; k++) {
+    if (k != current && readers[k].load() == 0) {
+      b = k;
+      break;
+    }
+  }
+  if (b < 0) {
+    skipped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Snapshot & snapshot = buffers[b];
+  uint8_t* blocked_out = snapshot.blocked.data();
+  snapshot.n_occupied = 0;
+  for (long v=0; v<n_voxels; v++) {
+    blocked_out[v] = log_odds[v] > occupied_threshold;
+    snapshot.n_occupied += blocked_out[v];
+  }
+
+  // inflate by the clearance (z, y, x in turn, a cube rather than a sphere, so a bit more than asked)
+  dilate_axis(blocked_out, dilate_tmp.data(), n_voxels, 1, dims[2], inflation);
+  dilate_axis(dilate_tmp.data(), blocked_out, n_voxels, dims[2], dims[1], inflation);
+  dilate_axis(blocked_out, dilate_tmp.data(), n_voxels, (long) dims[1] * dims[2], dims[0], inflation);
+  std::copy(dilate_tmp.begin(), dilate_tmp.end(), snapshot.blocked.begin());
+
+  published.store(b);
+  snapshots.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/////////////////////////////// snapshot pool ///////////////////////////////
+int OccupancyMap::acquire() const
+{
+  while (true) {
+    int b = published.load();
+    if (b < 0) return -1;
+    readers[b].fetch_add(1);
+    if (published.load() == b) return b;    // still the published one, so the worker will not touch it now
+    readers[b].fetch_sub(1);                // a newer one came out in between
+  }
+}
+
+void OccupancyMap::release(int b) const
+{
+  if (b >= 0) readers[b].fetch_sub(1);
+}
+
+
+/////////////////////////////// queries ///////////////////////////////
+long OccupancyMap::voxel_of(const double p[3]) const
+{
+  int idx[3];
+  for (int j=0; j<3; j++) {
+    double f = (p[j] - lower[j]) / voxel_size;
+    if (!(f >= 0.0 && f < dims[j])) return -1;
+    idx[j] = (int) f;
+  }
+  return ((long) idx[0] * dims[1] + idx[1]) * dims[2] + idx[2];
+}
+
+bool OccupancyMap::blocked_in(const Snapshot & snapshot, const double p[3]) const
+{
+  long v = voxel_of(p);
+  return v >= 0 && snapshot.blocked[v];
+}
+
+bool OccupancyMap::blocked(const double p[3]) const
+{
+  int b = acquire();
+  if (b < 0) return false;
+  bool result = blocked_in(buffers[b], p);
+  release(b);
+  return result;
+}
+
+bool OccupancyMap::clamp(const std::vector<double>& from, std::vector<double>& target) const
+{
+  int b = acquire();
+  if (b < 0) return false;
+  const Snapshot & snapshot = buffers[b];
+
+  const double t[3] = {target.at(0), target.at(1), target.at(2)};
+  const double f[3] = {from.at(0), from.at(1), from.at(2)};
+  auto point_at = [&](double u, double p[3]) {
+    for (int j=0; j<3; j++) p[j] = f[j] + u * (t[j] - f[j]);
+  };
+
+  // the way there, every half voxel (only the inflated surface is marked, not what is behind it,
+  // so a free target does not mean the way is free), at most max_clamp_steps checks
+  double length = std::sqrt((t[0] - f[0]) * (t[0] - f[0]) + (t[1] - f[1]) * (t[1] - f[1]) + (t[2] - f[2]) * (t[2] - f[2]));
+  int n_steps = std::clamp((int) std::ceil(length / (0.5 * voxel_size)), 1, max_clamp_steps);
+  double p[3];
+  double free_u = 0.0, blocked_u = -1.0;
+  for (int k=1; k<=n_steps; k++) {
+    double u = (double) k / n_steps;
+    point_at(u, p);
+    if (blocked_in(snapshot, p)) {
+      blocked_u = u;
+      break;
+    }
+    free_u = u;
+  }
+
+  bool moved = blocked_u >= 0.0;
+  if (moved && blocked_in(snapshot, f)) {
+    target = from;
+  } else if (moved) {
+    // last free point before the first blocked step
+    for (int k=0; k<clamp_iterations; k++) {
+      double u = 0.5 * (free_u + blocked_u);
+      point_at(u, p);
+      if (blocked_in(snapshot, p)) blocked_u = u;
+      else free_u = u;
+    }
+    point_at(free_u, p);
+    for (int j=0; j<3; j++) target.at(j) = p[j];
+  }
+
+  release(b);
+  return moved;
+}
+
+
+/////////////////////////////// statistics ///////////////////////////////
+double OccupancyMap::mean_integration_ms() const
+{
+  long n = n_snapshots() + n_skipped();
+  return (n > 0) ? integration_ms_sum.load(std::memory_order_relaxed) / n : 0.0;
+}
+
+int OccupancyMap::n_occupied() const
+{
+  int b = acquire();
+  if (b < 0) return 0;
+  int n = buffers[b].n_occupied;
+  release(b);
+  return n;
+}
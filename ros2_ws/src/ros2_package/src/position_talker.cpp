@@ -7,12 +7,22 @@
 //
 // - Main functionalities:
 //   1. Listens to the Falcon joystick position (via ForceDimension SDK)
-//   2. Publishes the joystick position (-> GazeboController / RealController)
+//   2. Publishes the joystick position (-> GazeboController / RealController),
+//      stamped with the time it was read from the device
+//   3. Optionally also hands every sample to the controllers on this host
+//      through shared memory (falcon_shm.hpp), set "falcon_shm" to the
+//      segment name (e.g. /ros2_package_falcon) on both sides
+//   4. Optional haptic guidance (guidance_gain > 0): after the centering,
+//      a virtual fixture pulls the handle toward the closest point of the
+//      reference trajectory (traj_id, use_depth, scaled by the mapping_ratio),
+//      looked up every loop in a precomputed CurveIndex (curve_index.hpp)
 //
 //////////////////////////////////////////////////////
 //////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <string>
@@ -20,7 +30,12 @@
 #include "rclcpp/rclcpp.hpp"
 #include "std_msgs/msg/string.hpp"
 
-#include "tutorial_interfaces/msg/falconpos.hpp"
+#include "tutorial_interfaces/msg/falconpos_stamped.hpp"
+
+#include "ros2_package/curve_index.hpp"
+#include "ros2_package/falcon_shm.hpp"
+#include "ros2_package/input_monitor.hpp"
+#include "ros2_package/tracing.hpp"
 
 #include <stdio.h>
 #include "dhdc.h"
@@ -36,12 +51,13 @@ class PositionTalker : public rclcpp::Node
 public:
 
   // parameters name list
-  std::vector<std::string> param_names = {"mapping_ratio", "use_depth", "part_id", "alpha_id", "traj_id"};
+  std::vector<std::string> param_names = {"mapping_ratio", "use_depth", "part_id", "alpha_id", "traj_id", "guidance_gain"};
   double mapping_ratio {3.0};
   int use_depth {0};
   int part_id {0};
   int alpha_id {0};
   int traj_id {0};
+  double guidance_gain {0.0};   // stiffness of the virtual fixture toward the reference in [N/m], 0 = no guidance
 
   // other arrays
   double p[3] {0.0, 0.0, 0.0};
@@ -64,6 +80,12 @@ public:
   // sine curve's first point is currently all the same
   std::vector<double> first_point {0.06, -0.16, -0.01};
 
+  // haptic guidance: the reference curve in Falcon coordinates (2.5 mm cells, 3 cm around the curve)
+  std::unique_ptr<CurveIndex> guide_curve;
+  const double guide_cell_size = 0.0025;    // [meters]
+  const double guide_margin = 0.03;         // [meters]
+  const double max_guidance_force = 5.0;    // [N], the Falcon peaks at about 9 N
+
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////////////
   PositionTalker(int a_choice)
@@ -77,6 +99,7 @@ public:
     this->declare_parameter(param_names.at(2), 0);
     this->declare_parameter(param_names.at(3), 0);
     this->declare_parameter(param_names.at(4), 0);
+    this->declare_parameter(param_names.at(5), 0.0);
     
     std::vector<rclcpp::Parameter> params = this->get_parameters(param_names);
     mapping_ratio = std::stod(params.at(0).value_to_string().c_str());
@@ -84,6 +107,7 @@ public:
     part_id = std::stoi(params.at(2).value_to_string().c_str());
     alpha_id = std::stoi(params.at(3).value_to_string().c_str());
     traj_id = std::stoi(params.at(4).value_to_string().c_str());
+    guidance_gain = std::stod(params.at(5).value_to_string().c_str());
     print_params();
 
     // update first point if not using depth
@@ -92,8 +116,27 @@ public:
     // update centering position using "post_point" computed above
     for (size_t i=0; i<3; i++) centering.at(i) = first_point.at(i) / mapping_ratio;
 
-    // publisher
-    publisher_ = this->create_publisher<tutorial_interfaces::msg::Falconpos>("falcon_position", 10);
+    // precompute the curve index once, so the haptic loop only does a lookup
+    if (guidance_gain > 0.0) {
+      auto start = std::chrono::steady_clock::now();
+      guide_curve = std::make_unique<CurveIndex>(sample_reference_curve(traj_id, use_depth, mapping_ratio), guide_cell_size, guide_margin);
+      double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      printf("Haptic guidance: K = %.0f N/m, %zu segments, %zu cells (%.1f candidates per cell), built in %.0f ms\n",
+             guidance_gain, guide_curve->n_segments(), guide_curve->n_cells(), guide_curve->mean_candidates(), build_ms);
+    }
+
+    // publisher: newest sample only, offering a deadline and liveliness the controllers can monitor
+    // (they request 20 ms / 500 ms, the offered values must not be longer)
+    StreamQos qos = declare_stream_qos(*this, "falcon_qos", {1, false, 10, 250, 0});
+    publisher_ = this->create_publisher<tutorial_interfaces::msg::FalconposStamped>("falcon_position", make_qos(qos));
+
+    // shared-memory handoff to the controllers (the topic stays for logging and visualization)
+    std::string shm_name = this->declare_parameter("falcon_shm", std::string(""));
+    if (!shm_name.empty()) {
+      falcon_shm_ = std::make_unique<FalconShmWriter>(shm_name);
+      if (falcon_shm_->is_open()) std::cout << "Writing the Falcon samples to shared memory " << shm_name << std::endl;
+      else falcon_shm_.reset();
+    }
     timer_ = this->create_wall_timer(2ms, std::bind(&PositionTalker::timer_callback, this));       ///////// publishing at 500 Hz /////////
   }
 
@@ -104,11 +147,15 @@ private:
   { 
     ///////////////////////// FALCON STUFF /////////////////////////
     dhdGetPosition(&(p[0]), &(p[1]), &(p[2]));
+    rclcpp::Time read_stamp = this->now();   // the controllers measure their input latency from here
+    TRACE_DEVICE_READ(read_stamp.nanoseconds());
     dhdGetLinearVelocity (&(v[0]), &(v[1]), &(v[2]));
 
     if (count < count_thres2) {
       // gradually perform centering {in increasing levels of K = 1000 -> K = 2000, after 1 -> 2 seconds}
       for (int i=0; i<3; i++) f[i] = - K[i] * (p[i] - centering[i]) - C[i] * v[i];
+    } else if (guide_curve) {
+      render_guidance();
     } else {
       switch (choice) {
         case 0: for (int i=0; i<3; i++) f[i] = 0; break;
@@ -124,13 +171,18 @@ private:
       rclcpp::shutdown();
     }
 
+    // shared memory first, it is what the controllers wait for
+    if (falcon_shm_) falcon_shm_->write(read_stamp.nanoseconds(), p[0] * 100, p[1] * 100, p[2] * 100);
+
     // generate and publish the message
-    auto message = tutorial_interfaces::msg::Falconpos();
+    auto message = tutorial_interfaces::msg::FalconposStamped();
+    message.header.stamp = read_stamp;
     message.x = p[0] * 100;
     message.y = p[1] * 100;
     message.z = p[2] * 100;
     // RCLCPP_INFO(this->get_logger(), "Publishing position: px = %.3f, py = %.3f, pz = %.3f  [in cm]", message.x, message.y, message.z);
     publisher_->publish(message);
+    TRACE_FALCON_PUBLISH(read_stamp.nanoseconds());
 
 
 
@@ -149,6 +201,25 @@ private:
 
   }
 
+  // virtual fixture: spring toward the closest point of the reference, damping only across the curve
+  // so moving along it stays free (without depth, x is held at the centering point instead)
+  void render_guidance()
+  {
+    double q[3] = {use_depth ? p[0] : 0.0, p[1], p[2]};
+    double closest[3];
+    double tangent[3];
+    guide_curve->nearest(q, closest, tangent);
+
+    double v_along = v[0] * tangent[0] + v[1] * tangent[1] + v[2] * tangent[2];
+    for (int i=0; i<3; i++) f[i] = - guidance_gain * (q[i] - closest[i]) - C[i] * (v[i] - v_along * tangent[i]);
+    if (!use_depth) f[0] = - K[0] * (p[0] - centering[0]) - C[0] * v[0];
+
+    double norm = std::sqrt(f[0]*f[0] + f[1]*f[1] + f[2]*f[2]);
+    if (norm > max_guidance_force) {
+      for (int i=0; i<3; i++) f[i] *= max_guidance_force / norm;
+    }
+  }
+
   void print_params() {
     for (unsigned int i=0; i<10; i++) std::cout << "\n";
     std::cout << "\n\nThe current parameters [position_publisher] are as follows:\n" << std::endl;
@@ -157,11 +228,13 @@ private:
     std::cout << "Participant ID = " << part_id << "\n" << std::endl;
     std::cout << "Alpha ID = " << alpha_id << "\n" << std::endl;
     std::cout << "Trajectory ID = " << traj_id << "\n" << std::endl;
+    std::cout << "Guidance gain = " << guidance_gain << "\n" << std::endl;
     for (unsigned int i=0; i<10; i++) std::cout << "\n";
   }
 
   rclcpp::TimerBase::SharedPtr timer_;
-  rclcpp::Publisher<tutorial_interfaces::msg::Falconpos>::SharedPtr publisher_;
+  rclcpp::Publisher<tutorial_interfaces::msg::FalconposStamped>::SharedPtr publisher_;
+  std::unique_ptr<FalconShmWriter> falcon_shm_;
 
   const int count_thres1 = 1 * pub_freq;   // 1 second
   const int count_thres2 = 1.5 * pub_freq;   // 1.5 seconds
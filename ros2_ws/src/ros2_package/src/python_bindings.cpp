@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - pybind11 module ros2_package._native, the analysis
+//   kernels (analysis_kernels.hpp) for the Python side
+//
+// - Main functionalities:
+//   1. reference_trajectory(): the controller's reference
+//      curve (-> traj_utils.get_sine_ref_points())
+//   2. tracking_error(): per-point and total errors of a
+//      recorded path (-> DataLogger.calc_error())
+//   3. Kinematics: forward kinematics of joint trajectories
+//      with the Panda chain of the controllers
+//
+// - NumPy arrays are read in place when they already are
+//   C-contiguous float64 (anything else is converted once,
+//   by pybind11's forcecast), and the results are NumPy
+//   arrays the kernels write into directly. The GIL is
+//   released while the kernels run, so they only write
+//   into per-call state
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <stdexcept>
+#include <string>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "ros2_package/analysis_kernels.hpp"
+#include "ros2_package/chain_cache.hpp"
+
+namespace py = pybind11;
+
+using InArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+
+// rows of an (n, cols) array (or a single (cols,) row)
+static std::size_t n_rows(const InArray& a, py::ssize_t cols, const char* name)
+{
+  if (a.ndim() == 1 && a.shape(0) == cols) return 1;
+  if (a.ndim() == 2 && a.shape(1) == cols) return a.shape(0);
+  throw std::invalid_argument(std::string(name) + " must have shape (n, " + std::to_string(cols) + ")");
+}
+
+
+/////////////////// reference trajectory ///////////////////
+static py::array_t<double> py_reference_trajectory(std::size_t n_points, int a, int b, int c, double s, double h,
+                                                   const std::vector<double>& origin, int use_depth)
+{
+  if (origin.size() != 3) throw std::invalid_argument("origin must be [x, y, z]");
+
+  py::array_t<double> out({(py::ssize_t) n_points, (py::ssize_t) 3});
+  double* out_ptr = out.mutable_data();
+  const SineParams sp {a, b, c, s, h};
+  {
+    py::gil_scoped_release release;
+    reference_trajectory(sp, use_depth, origin.data(), n_points, out_ptr);
+  }
+  return out;
+}
+
+
+/////////////////// tracking error ///////////////////
+static py::dict py_tracking_error(const InArray& pos, const InArray& ref, int use_depth)
+{
+  const std::size_t n = n_rows(pos, 3, "pos");
+  if (n_rows(ref, 3, "ref") != n) throw std::invalid_argument("pos and ref must have the same number of points");
+
+  py::array_t<double> dim_err({(py::ssize_t) n, (py::ssize_t) 3});
+  py::array_t<double> err((py::ssize_t) n);
+  const double* pos_ptr = pos.data();
+  const double* ref_ptr = ref.data();
+  double* dim_err_ptr = dim_err.mutable_data();
+  double* err_ptr = err.mutable_data();
+
+  ErrorTotals totals;
+  {
+    py::gil_scoped_release release;
+    totals = tracking_error(pos_ptr, ref_ptr, n, use_depth, dim_err_ptr, err_ptr);
+  }
+
+  py::dict res;
+  res["dim_err"] = dim_err;
+  res["err"] = err;
+  res["dim_total"] = std::vector<double>(totals.dim_total, totals.dim_total + 3);
+  res["total"] = totals.total;
+  res["dim_ave"] = std::vector<double>(totals.dim_ave, totals.dim_ave + 3);
+  res["ave"] = totals.ave;
+  return res;
+}
+
+
+/////////////////// forward kinematics ///////////////////
+class PyKinematics
+{
+public:
+
+  explicit PyKinematics(const std::string& urdf)
+  : kinematics(load_chain(urdf))
+  {
+    if (!kinematics.ok()) throw std::runtime_error("the chain of " + urdf + " has joints other than revolute ones, or too many");
+  }
+
+  // (position (n, 3), orientation (n, 4)) of q (n, n_joints).
+  // compute() writes its results into the kernel, so every call runs on its own copy:
+  // with the GIL released, other threads may be in fk() on the same object at the same time
+  py::tuple fk(const InArray& q) const
+  {
+    const std::size_t n = n_rows(q, kinematics.n_joints(), "q");
+    py::array_t<double> position({(py::ssize_t) n, (py::ssize_t) 3});
+    py::array_t<double> orientation({(py::ssize_t) n, (py::ssize_t) 4});
+    const double* q_ptr = q.data();
+    double* position_ptr = position.mutable_data();
+    double* orientation_ptr = orientation.mutable_data();
+    TcpKinematics call_kinematics = kinematics;
+    {
+      py::gil_scoped_release release;
+      trajectory_fk(call_kinematics, q_ptr, n, position_ptr, orientation_ptr);
+    }
+    return py::make_tuple(position, orientation);
+  }
+
+  TcpKinematics kinematics;
+
+private:
+
+  static KDL::Chain load_chain(const std::string& urdf)
+  {
+    KDL::Chain chain;
+    if (!load_panda_chain(urdf, chain)) throw std::runtime_error("could not load the kinematic chain from " + urdf);
+    return chain;
+  }
+};
+
+
+//////////////////// MODULE ///////////////////
+
+PYBIND11_MODULE(_native, m)
+{
+  m.doc() = "C++ kernels of the shared controller (reference trajectory, tracking error, forward kinematics)";
+
+  // the envelope the controller uses, so the Python side can tell whether its own matches
+  m.attr("TRAJ_DEPTH") = traj_depth;
+  m.attr("TRAJ_WIDTH") = traj_width;
+  m.attr("TRAJ_HEIGHT") = traj_height;
+  m.attr("URDF_PATH") = urdf_path;
+
+  m.def("sine_params", [](int traj_id) {
+      SineParams sp = get_sine_params(traj_id);
+      return py::make_tuple(sp.a, sp.b, sp.c, sp.s, sp.h);
+    }, py::arg("traj_id"), "(a, b, c, s, h) of a traj_id's sine curve");
+
+  m.def("reference_trajectory", &py_reference_trajectory,
+        py::arg("n_points"), py::arg("a"), py::arg("b"), py::arg("c"), py::arg("s"), py::arg("h"),
+        py::arg("origin"), py::arg("use_depth"),
+        "(n_points, 3) reference points over t = [0, 2pi] around origin, as the controller computes them");
+
+  m.def("tracking_error", &py_tracking_error, py::arg("pos"), py::arg("ref"), py::arg("use_depth"),
+        "per-dimension (dim_err) and Euclidean (err) error of pos against ref, both (n, 3), with totals and averages");
+
+  py::class_<PyKinematics>(m, "Kinematics")
+    .def(py::init<const std::string&>(), py::arg("urdf") = std::string(urdf_path))
+    .def("fk", &PyKinematics::fk, py::arg("q"),
+         "(position (n, 3), orientation (n, 4) as x, y, z, w) of the tcp for joint positions q (n, n_joints)")
+    .def_property_readonly("joint_names", [](const PyKinematics& k) {return k.kinematics.joint_names();});
+}
@@ -0,0 +1,345 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Offline tool for choosing the task-space origin:
+//   maps where the Panda can hold the TCP (in the
+//   controller's fixed orientation) and how well, then
+//   ranks the origins each trajectory could be run from
+//
+// - Main functionalities:
+//   1. Samples a box of the workspace on a dense grid and
+//      solves the IK of every cell with the controller's own
+//      solver (SharedControlCore::compute_ik)
+//   2. Per cell: solvable (converged, within the joint limits,
+//      clear of self-collision), manipulability, smallest
+//      singular value and joint-limit margin of the solution
+//   3. Ranks every cell as the origin of each traj_id: all
+//      points of the reference curve must be solvable, the
+//      origins are ordered by the worst smallest singular value
+//      along the curve (then by the worst joint-limit margin)
+//   4. Writes the voxel map and the rankings to two csv files
+//
+// - Speed: the grid is split into rows along y, pulled by a
+//   pool of worker threads with one controller core each.
+//   Along a row each IK starts from the previous cell's
+//   solution (as the controller does from tick to tick) and
+//   only falls back to home if that does not converge, and
+//   cells beyond the reach of the arm are never solved
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tool_args.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/////////////////// map settings (overridable from the command line) ///////////////////
+struct MapSettings
+{
+  std::string urdf {urdf_path};
+  std::string out_file {"reachability_map.csv"};
+  std::string ranking_file {"origin_ranking.csv"};
+  unsigned int threads {std::max(1u, std::thread::hardware_concurrency())};
+
+  std::vector<double> lower {0.2, -0.5, 0.05};   // grid box in panda_link0 [m]
+  std::vector<double> upper {0.85, 0.5, 0.85};
+  double resolution {0.01};                      // [m]
+
+  std::vector<int> traj_ids {0, 1, 2, 3, 4, 5};
+  int use_depth {1};
+  int curve_points {100};    // reference samples checked per origin
+  int top {20};              // ranked origins written per traj_id
+};
+
+//////// KEEP CONSISTENT WITH REAL CONTROLLER (RealBackend::origin) ////////
+const std::vector<double> current_origin {0.5059, 0.0, 0.4346};
+
+// one grid cell
+struct Cell
+{
+  uint8_t solvable = 0;
+  float manipulability = 0.0f;
+  float min_sigma = 0.0f;
+  float joint_margin = 0.0f;
+  float self_distance = 0.0f;
+};
+
+// one origin candidate for a traj_id, its worst values along the curve
+struct Candidate
+{
+  long cell;
+  double min_sigma;
+  double mean_manipulability;
+  double joint_margin;
+};
+
+
+/////////////////// the grid ///////////////////
+struct Grid
+{
+  double lower[3];
+  double resolution;
+  int dims[3];
+
+  long n_cells() const {return (long) dims[0] * dims[1] * dims[2];}
+  long index(int i, int j, int k) const {return ((long) i * dims[1] + j) * dims[2] + k;}
+
+  void center(long idx, std::vector<double>& p) const
+  {
+    int k = idx % dims[2];
+    int j = (idx / dims[2]) % dims[1];
+    int i = idx / ((long) dims[1] * dims[2]);
+    p.at(0) = lower[0] + (i + 0.5) * resolution;
+    p.at(1) = lower[1] + (j + 0.5) * resolution;
+    p.at(2) = lower[2] + (k + 0.5) * resolution;
+  }
+};
+
+// the shoulder (joint 2, which sits on the axis of joint 1) and an upper bound of the distance from it to the TCP
+static void arm_reach(const KDL::Chain & chain, double shoulder[3], double& reach)
+{
+  KDL::Vector p = chain.getSegment(0).pose(0.0).p;
+  for (int j=0; j<3; j++) shoulder[j] = p(j);
+  reach = 0.0;
+  for (unsigned int s=1; s<chain.getNrOfSegments(); s++) reach += chain.getSegment(s).getFrameToTip().p.Norm();
+}
+
+
+/////////////////// solve one row of cells (along y) ///////////////////
+static void solve_row(SharedControlCore & core, const Grid & grid, int i, int k, const double shoulder[3], double reach,
+                      std::vector<Cell>& cells, long& n_solved)
+{
+  std::vector<double> target {0.0, 0.0, 0.0};
+  std::vector<double> seed = home_joint_vals;
+  std::vector<double> q(n_joints, 0.0);
+
+  for (int j=0; j<grid.dims[1]; j++) {
+    long idx = grid.index(i, j, k);
+    grid.center(idx, target);
+    Cell & cell = cells.at(idx);
+
+    double d = 0.0;
+    for (int m=0; m<3; m++) d += pow(target.at(m) - shoulder[m], 2);
+    if (sqrt(d) > reach) continue;
+
+    // from the neighbour's solution, from home if that does not converge
+    core.compute_ik(target, seed, q);
+    if (core.ik_error < 0 || !within_limits(q)) {
+      if (seed == home_joint_vals) continue;
+      core.compute_ik(target, home_joint_vals, q);
+      if (core.ik_error < 0 || !within_limits(q)) continue;
+    }
+    n_solved++;
+
+    cell.self_distance = core.self_distance(q);
+    if (cell.self_distance < core.self_collision_margin) continue;
+
+    core.compute_conditioning(q);
+    cell.solvable = 1;
+    cell.manipulability = core.manipulability;
+    cell.min_sigma = core.min_singular_value;
+    cell.joint_margin = joint_limit_margin(q);
+    seed = q;
+  }
+}
+
+
+/////////////////// rank the origins of one traj_id ///////////////////
+static std::vector<Candidate> rank_origins(const Grid & grid, const std::vector<Cell>& cells, int traj_id, const MapSettings & settings)
+{
+  // the reference curve in cell offsets from the origin cell
+  SineParams sp = get_sine_params(traj_id);
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  std::vector< std::vector<int> > offsets;
+  for (int n=0; n<settings.curve_points; n++) {
+    get_reference_offset(2 * M_PI * n / settings.curve_points, sp, settings.use_depth, ref);
+    std::vector<int> offset(3, 0);
+    for (int m=0; m<3; m++) offset.at(m) = (int) std::lround(ref.at(m) / grid.resolution);
+    if (std::find(offsets.begin(), offsets.end(), offset) == offsets.end()) offsets.push_back(offset);
+  }
+
+  // every cell as the origin, in parallel over slices along x
+  std::vector< std::vector<Candidate> > found(grid.dims[0]);
+  std::atomic<int> next_slice {0};
+  std::vector<std::thread> workers;
+  for (unsigned int w=0; w<settings.threads; w++) {
+    workers.emplace_back([&]() {
+      for (int i = next_slice++; i < grid.dims[0]; i = next_slice++) {
+        for (int j=0; j<grid.dims[1]; j++) {
+          for (int k=0; k<grid.dims[2]; k++) {
+            Candidate c {grid.index(i, j, k), 1e9, 0.0, 1e9};
+            bool valid = true;
+            for (const std::vector<int>& o : offsets) {
+              int a = i + o.at(0), b = j + o.at(1), e = k + o.at(2);
+              if (a < 0 || b < 0 || e < 0 || a >= grid.dims[0] || b >= grid.dims[1] || e >= grid.dims[2]) {valid = false; break;}
+              const Cell & cell = cells[grid.index(a, b, e)];
+              if (!cell.solvable) {valid = false; break;}
+              c.min_sigma = std::min(c.min_sigma, (double) cell.min_sigma);
+              c.joint_margin = std::min(c.joint_margin, (double) cell.joint_margin);
+              c.mean_manipulability += cell.manipulability;
+            }
+            if (!valid) continue;
+            c.mean_manipulability /= offsets.size();
+            found.at(i).push_back(c);
+          }
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  std::vector<Candidate> candidates;
+  for (const auto& slice : found) candidates.insert(candidates.end(), slice.begin(), slice.end());
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+    if (a.min_sigma != b.min_sigma) return a.min_sigma > b.min_sigma;
+    return a.joint_margin > b.joint_margin;
+  });
+  return candidates;
+}
+
+
+/////////////////// command line parsing ///////////////////
+bool parse_args(int argc, char * argv[], MapSettings& settings)
+{
+  bool ok = parse_key_values(argc, argv, [&](const std::string& key, const std::string& value) {
+      if (key == "--urdf") settings.urdf = value;
+      else if (key == "--out") settings.out_file = value;
+      else if (key == "--ranking") settings.ranking_file = value;
+      else if (key == "--threads") settings.threads = std::max(1, std::stoi(value));
+      else if (key == "--lower") settings.lower = parse_list<double>(value);
+      else if (key == "--upper") settings.upper = parse_list<double>(value);
+      else if (key == "--resolution") settings.resolution = std::stod(value);
+      else if (key == "--traj_ids") settings.traj_ids = parse_list<int>(value);
+      else if (key == "--use_depth") settings.use_depth = std::stoi(value);
+      else if (key == "--curve_points") settings.curve_points = std::max(1, std::stoi(value));
+      else if (key == "--top") settings.top = std::max(1, std::stoi(value));
+      else return false;
+      return true;
+    });
+  if (!ok) return false;
+  if (!check_ids("--traj_ids", settings.traj_ids, n_traj_ids)) return false;
+  if (settings.lower.size() != 3 || settings.upper.size() != 3 || settings.resolution <= 0.0) {
+    std::cerr << "The grid needs --lower x,y,z --upper x,y,z and a positive --resolution" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+//////////////////// MAIN FUNCTION ///////////////////
+
+int main(int argc, char * argv[])
+{
+  MapSettings settings;
+  if (!parse_args(argc, argv, settings)) {
+    std::cerr << "usage: reachability_map [--lower x,y,z] [--upper x,y,z] [--resolution M] [--threads N] [--traj_ids 0,1,..]\n"
+              << "                        [--use_depth 0|1] [--curve_points N] [--top N] [--out FILE] [--ranking FILE] [--urdf FILE]" << std::endl;
+    return 1;
+  }
+
+  KDL::Chain panda_chain;
+  if (!load_panda_chain(settings.urdf, panda_chain)) return 1;
+
+  Grid grid;
+  grid.resolution = settings.resolution;
+  for (int m=0; m<3; m++) {
+    grid.lower[m] = settings.lower.at(m);
+    grid.dims[m] = std::max(1, (int) std::ceil((settings.upper.at(m) - settings.lower.at(m)) / settings.resolution - 1e-9));
+  }
+  std::vector<Cell> cells(grid.n_cells());
+
+  double shoulder[3], reach;
+  arm_reach(panda_chain, shoulder, reach);
+
+  std::cout << "Solving " << grid.n_cells() << " cells (" << grid.dims[0] << " x " << grid.dims[1] << " x " << grid.dims[2]
+            << ", " << settings.resolution * 100 << " cm) on " << settings.threads << " threads ..." << std::endl;
+
+  ///////// the map: each worker owns a core and pulls the next row /////////
+  const int n_rows = grid.dims[0] * grid.dims[2];
+  std::atomic<int> next_row {0};
+  std::atomic<long> solved {0};
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned int w=0; w<settings.threads; w++) {
+    workers.emplace_back([&]() {
+      SharedControlCore core(panda_chain);
+      // the first IK from home fixes the controller's TCP orientation
+      std::vector<double> q(n_joints, 0.0);
+      core.compute_ik(current_origin, home_joint_vals, q);
+
+      long n_solved = 0;
+      for (int r = next_row++; r < n_rows; r = next_row++) {
+        solve_row(core, grid, r / grid.dims[2], r % grid.dims[2], shoulder, reach, cells, n_solved);
+      }
+      solved += n_solved;
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  double map_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  long n_solvable = 0;
+  for (const Cell & cell : cells) n_solvable += cell.solvable;
+  std::cout << "Map done in " << map_time << " s (" << grid.n_cells() / map_time << " cells/s): " << solved.load()
+            << " cells solved, " << n_solvable << " solvable and clear of self-collision" << std::endl;
+
+  std::ofstream map_out(settings.out_file);
+  map_out << "x,y,z,solvable,manipulability,min_sigma,joint_margin,self_distance\n";
+  std::vector<double> p {0.0, 0.0, 0.0};
+  for (long idx=0; idx<grid.n_cells(); idx++) {
+    const Cell & cell = cells.at(idx);
+    grid.center(idx, p);
+    map_out << p.at(0) << "," << p.at(1) << "," << p.at(2) << "," << (int) cell.solvable << "," << cell.manipulability << ","
+            << cell.min_sigma << "," << cell.joint_margin << "," << cell.self_distance << "\n";
+  }
+
+  ///////// the origins of each traj_id /////////
+  std::ofstream ranking_out(settings.ranking_file);
+  ranking_out << "traj_id,rank,origin_x,origin_y,origin_z,min_sigma,mean_manipulability,joint_margin\n";
+
+  long current_cell = -1;
+  int ci[3];
+  for (int m=0; m<3; m++) ci[m] = (int) std::floor((current_origin.at(m) - grid.lower[m]) / grid.resolution);
+  if (ci[0] >= 0 && ci[1] >= 0 && ci[2] >= 0 && ci[0] < grid.dims[0] && ci[1] < grid.dims[1] && ci[2] < grid.dims[2]) {
+    current_cell = grid.index(ci[0], ci[1], ci[2]);
+  }
+
+  for (int traj_id : settings.traj_ids) {
+    std::vector<Candidate> candidates = rank_origins(grid, cells, traj_id, settings);
+
+    for (int r=0; r<std::min(settings.top, (int) candidates.size()); r++) {
+      const Candidate & c = candidates.at(r);
+      grid.center(c.cell, p);
+      ranking_out << traj_id << "," << r + 1 << "," << p.at(0) << "," << p.at(1) << "," << p.at(2) << ","
+                  << c.min_sigma << "," << c.mean_manipulability << "," << c.joint_margin << "\n";
+    }
+
+    std::cout << "traj_id " << traj_id << ": " << candidates.size() << " possible origins";
+    if (!candidates.empty()) {
+      grid.center(candidates.front().cell, p);
+      std::cout << ", best [" << p.at(0) << ", " << p.at(1) << ", " << p.at(2) << "] (min sigma " << candidates.front().min_sigma << ")";
+    }
+    auto current = std::find_if(candidates.begin(), candidates.end(), [&](const Candidate& c) {return c.cell == current_cell;});
+    if (current == candidates.end()) std::cout << ", current origin not possible";
+    else std::cout << ", current origin ranked " << current - candidates.begin() + 1 << " (min sigma " << current->min_sigma << ")";
+    std::cout << std::endl;
+  }
+
+  double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Finished in " << duration << " seconds, map written to " << settings.out_file << ", rankings to "
+            << settings.ranking_file << std::endl;
+  return 0;
+}
@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the SelfCollision check (Panda
+//   capsules, pair selection, segment distance loop)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/self_collision.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+// capsules of the franka_description collision model, in the link frames [m]
+struct LinkCapsule
+{
+  const char* link;
+  int order;          // position along the arm
+  double a[3];
+  double b[3];
+  double radius;
+};
+
+static const LinkCapsule panda_capsules[] = {
+  {"panda_link0", 0, {-0.06, 0.0, 0.06}, {-0.09, 0.0, 0.06}, 0.06},
+  {"panda_link1", 1, {0.0, 0.0, -0.333}, {0.0, 0.0, -0.05}, 0.06},
+  {"panda_link2", 2, {0.0, 0.0, -0.06}, {0.0, 0.0, 0.06}, 0.06},
+  {"panda_link3", 3, {0.0, 0.0, -0.22}, {0.0, 0.0, -0.07}, 0.06},
+  {"panda_link4", 4, {0.0, 0.0, 0.06}, {0.0, 0.0, -0.06}, 0.06},
+  {"panda_link5", 5, {0.0, 0.0, -0.31}, {0.0, 0.0, -0.21}, 0.06},
+  {"panda_link5", 5, {0.0, 0.08, -0.06}, {0.0, 0.08, -0.20}, 0.025},
+  {"panda_link6", 6, {0.0, 0.0, 0.01}, {0.0, 0.0, -0.07}, 0.05},
+  {"panda_link7", 7, {0.0, 0.0, 0.08}, {0.0, 0.0, -0.06}, 0.04},
+  {"panda_hand", 8, {0.0, -0.05, 0.04}, {0.0, 0.05, 0.04}, 0.04},
+  {"panda_hand", 8, {0.0, -0.05, 0.10}, {0.0, 0.05, 0.10}, 0.02},
+};
+
+static const int min_order_gap = 3;   // links closer along the arm than this are not checked
+
+// clamp to [0, 1] without a branch
+static inline double clamp01(double x)
+{
+  x = (x > 0.0) ? x : 0.0;
+  return (x < 1.0) ? x : 1.0;
+}
+
+
+SelfCollision::SelfCollision(const KDL::Chain & chain)
+{
+  for (const LinkCapsule & c : panda_capsules) {
+    // the root link has no segment of its own, the other links are the segments' names
+    int segment = -2;
+    if (c.order == 0) segment = -1;
+    for (unsigned int s=0; s<chain.getNrOfSegments(); s++) {
+      if (chain.getSegment(s).getName() == c.link) segment = s;
+    }
+    if (segment < -1) continue;
+    capsules.push_back({c.link, segment, c.order, KDL::Vector(c.a[0], c.a[1], c.a[2]), KDL::Vector(c.b[0], c.b[1], c.b[2]), c.radius});
+  }
+
+  for (std::size_t i=0; i<capsules.size(); i++) {
+    for (std::size_t j=i+1; j<capsules.size(); j++) {
+      if (std::abs(capsules.at(j).link - capsules.at(i).link) < min_order_gap) continue;
+      pair_a.push_back(i);
+      pair_b.push_back(j);
+    }
+  }
+
+  // (the Panda has 32 of them)
+  pair_a.resize(std::min((int) pair_a.size(), max_pairs));
+  pair_b.resize(pair_a.size());
+
+  world_a.resize(capsules.size());
+  world_b.resize(capsules.size());
+  for (int k=0; k<n_pairs(); k++) radius_sum[k] = capsules.at(pair_a.at(k)).radius + capsules.at(pair_b.at(k)).radius;
+}
+
+
+double SelfCollision::min_distance(const std::vector<KDL::Frame>& frames)
+{
+  // capsule ends into the base frame
+  for (std::size_t i=0; i<capsules.size(); i++) {
+    const Capsule & c = capsules[i];
+    if (c.segment < 0) {
+      world_a[i] = c.a;
+      world_b[i] = c.b;
+    } else {
+      world_a[i] = frames[c.segment] * c.a;
+      world_b[i] = frames[c.segment] * c.b;
+    }
+  }
+
+  // gather the pairs: start point and direction of both segments
+  const int n = n_pairs();
+  for (int k=0; k<n; k++) {
+    const KDL::Vector & a1 = world_a[pair_a[k]];
+    const KDL::Vector & a2 = world_a[pair_b[k]];
+    KDL::Vector d1 = world_b[pair_a[k]] - a1;
+    KDL::Vector d2 = world_b[pair_b[k]] - a2;
+    p1x[k] = a1.x(); p1y[k] = a1.y(); p1z[k] = a1.z();
+    d1x[k] = d1.x(); d1y[k] = d1.y(); d1z[k] = d1.z();
+    p2x[k] = a2.x(); p2y[k] = a2.y(); p2z[k] = a2.z();
+    d2x[k] = d2.x(); d2y[k] = d2.y(); d2z[k] = d2.z();
+  }
+
+  // closest points of the two segments: the one on the lines, clamped to the first segment,
+  // the second one's closest to that (clamped), then the first one's closest to that again (clamped).
+  // parallel segments start from any point, the two clamped steps still end up at the closest pair
+  const double eps = 1e-12;
+  for (int k=0; k<n; k++) {
+    double rx = p1x[k] - p2x[k], ry = p1y[k] - p2y[k], rz = p1z[k] - p2z[k];
+    double a = d1x[k] * d1x[k] + d1y[k] * d1y[k] + d1z[k] * d1z[k];
+    double e = d2x[k] * d2x[k] + d2y[k] * d2y[k] + d2z[k] * d2z[k];
+    double b = d1x[k] * d2x[k] + d1y[k] * d2y[k] + d1z[k] * d2z[k];
+    double c = d1x[k] * rx + d1y[k] * ry + d1z[k] * rz;
+    double f = d2x[k] * rx + d2y[k] * ry + d2z[k] * rz;
+    double denom = a * e - b * b;
+    denom = (denom > eps) ? denom : eps;
+
+    double s = clamp01((b * f - c * e) / denom);
+    double t = clamp01((b * s + f) / e);
+    s = clamp01((b * t - c) / a);
+
+    double dx = rx + s * d1x[k] - t * d2x[k];
+    double dy = ry + s * d1y[k] - t * d2y[k];
+    double dz = rz + s * d1z[k] - t * d2z[k];
+    distance[k] = std::sqrt(dx * dx + dy * dy + dz * dz) - radius_sum[k];
+  }
+
+  closest = (n > 0) ? std::min_element(distance, distance + n) - distance : -1;
+  return (n > 0) ? distance[closest] : 1e9;
+}
+
+
+std::string SelfCollision::closest_pair() const
+{
+  if (closest < 0) return "";
+  return std::string(capsules.at(pair_a.at(closest)).name) + " - " + capsules.at(pair_b.at(closest)).name;
+}
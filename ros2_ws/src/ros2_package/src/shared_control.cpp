@@ -0,0 +1,673 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the SharedControlCore class and
+//   the kinematics / noise helper functions shared by
+//   the controller nodes and offline tools
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/occupancy_map.hpp"
+#include "ros2_package/tracing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <Eigen/Eigenvalues>
+#include <kdl_parser/kdl_parser.hpp>
+
+
+/////////////////////////////// sine curve parameters ///////////////////////////////
+
+SineParams get_sine_params(int traj_id)
+{
+  switch (traj_id) {
+    case 1: return {2, 3, 4, 4*M_PI/3, 0.25};
+    case 2: return {1, 3, 4, M_PI,     0.25};
+    case 3: return {2, 2, 5, M_PI,     0.2};
+    case 4: return {2, 3, 5, 8*M_PI/5, 0.2};
+    case 5: return {2, 4, 5, M_PI,     0.2};
+  }
+  return {1, 1, 4, M_PI, 0.25};   // traj_id 0
+}
+
+void get_reference_offset(double t, const SineParams& sp, int use_depth, std::vector<double>& ref)
+{
+  ref.at(0) = 0.0;
+  if (use_depth) ref.at(0) = std::abs(t-M_PI) / M_PI * traj_depth - (traj_depth/2);
+  ref.at(1) = t / (2*M_PI) * traj_width - (traj_width/2);
+  ref.at(2) = (sp.h*traj_height) * (sin(sp.a*(t+sp.s)) + sin(sp.b*(t+sp.s)) + sin(sp.c*(t+sp.s)));
+}
+
+
+/////////////////////////////// SHARED CONTROL CORE ///////////////////////////////
+
+SharedControlCore::SharedControlCore(const KDL::Chain & chain, int a_control_freq)
+: control_freq(a_control_freq),
+  max_prep_count(prep_time * a_control_freq),
+  required_initial_vals(a_control_freq * 3),
+  required_settled_count(a_control_freq / 2),
+  warmup_ticks(warmup_time * a_control_freq),
+  max_smoothing_count(a_control_freq * smoothing_time),
+  max_recording_count(a_control_freq * traj_duration),
+  max_shifting_count(shifting_time * a_control_freq),
+  max_homing_count(homing_time * a_control_freq),
+  max_shutdown_count(shutdown_time * a_control_freq),
+  resume_ticks((int) (resume_time * a_control_freq)),
+  escalation_ticks((int) (escalation_time * a_control_freq)),
+  safety_filter(lower_joint_limits, upper_joint_limits, 1.0 / a_control_freq),
+  panda_chain(chain),
+  jnt_pos_start_(n_joints),
+  jnt_pos_goal_(n_joints),
+  jnt_pos_links_(n_joints),
+  link_frames_(chain.getNrOfSegments()),
+  jacobian_(n_joints)
+{
+  // create the solvers once per instance (they only hold references to this instance's chain)
+  fk_solver_ = std::make_unique<KDL::ChainFkSolverPos_recursive>(panda_chain);
+  vel_ik_solver_ = std::make_unique<CountingIkSolverVel>(panda_chain, 0.0001, 1000);
+  ik_solver_ = std::make_unique<KDL::ChainIkSolverPos_NR>(panda_chain, *fk_solver_, *vel_ik_solver_, 1000);
+  jac_solver_ = std::make_unique<KDL::ChainJntToJacSolver>(panda_chain);
+  self_collision_ = std::make_unique<SelfCollision>(panda_chain);
+
+  start_trial(alpha_id, traj_id, use_depth, mapping_ratio);
+}
+
+void SharedControlCore::start_trial(int a_alpha_id, int a_traj_id, int a_use_depth, double a_mapping_ratio)
+{
+  alpha_id = a_alpha_id;
+  traj_id = a_traj_id;
+  use_depth = a_use_depth;
+  mapping_ratio = a_mapping_ratio;
+
+  // update {ax, ay, az} values using the parameter "alpha_id", and store them as the initial ones
+  ax = iax = alphas_dict.at(alpha_id).at(0);
+  ay = iay = alphas_dict.at(alpha_id).at(1);
+  az = iaz = alphas_dict.at(alpha_id).at(2);
+
+  // write the sine curve parameters
+  sine = get_sine_params(traj_id);
+
+  // reset the phase machine
+  control = false;
+  prep_count = 0;
+  initial_joint_vals_count = 0;
+  settled_count = 0;
+  settle_anchor = curr_joint_vals;   // the settling is counted from the joint states of this trial only
+  count = 0;
+  record_flag = false;
+  t_param = 0.0;
+  trial_done = false;
+
+  // phase lengths go back to their upper bounds until the transitions are planned
+  warmup_start = -1;
+  approach_ticks = max_smoothing_count - control_freq * float_time;
+  recording_start = max_smoothing_count;
+  shifting_ticks = max_shifting_count;
+  homing_ticks = max_homing_count;
+
+  // the tcp orientation is re-captured at the first IK of every trial
+  got_orientation = false;
+
+  // a hold coasts from the command velocity, which starts at rest from wherever the last command was
+  resume_count = 0;
+  std::fill(command_velocity.begin(), command_velocity.end(), 0.0);
+  previous_command = message_joint_vals;
+
+  // the first command of the trial is where the robot is held, so the filter starts from rest there
+  safety_filter.reset();
+  safety_violation_count = 0;
+}
+
+void SharedControlCore::skip_prep()
+{
+  initial_joint_vals = curr_joint_vals;
+  initial_joint_vals_count = required_initial_vals;
+  warmup_start = prep_count;
+  prep_count += warmup_ticks - 1;   // the next tick takes control
+}
+
+void SharedControlCore::set_falcon_position(double x, double y, double z)
+{
+  human_offset.at(0) = x / 100 * mapping_ratio;
+  human_offset.at(1) = y / 100 * mapping_ratio;
+  human_offset.at(2) = z / 100 * mapping_ratio;
+}
+
+void SharedControlCore::set_joint_state(const std::vector<double>& q)
+{
+  for (unsigned int i=0; i<n_joints; i++) {
+    curr_joint_vals.at(i) = q.at(i);
+  }
+  // the joints count as settled once they stay within settle_tolerance for required_settled_count messages
+  double deviation = 0.0;
+  for (unsigned int i=0; i<n_joints; i++) deviation = std::max(deviation, std::abs(q.at(i) - settle_anchor.at(i)));
+  if (deviation < settle_tolerance) {
+    settled_count++;
+  } else {
+    settle_anchor = q;
+    settled_count = 0;
+  }
+
+  // get and store initial joint values if haven't received enough messages
+  if (initial_joint_vals_count < required_initial_vals) {
+    for (unsigned int i=0; i<n_joints; i++) {
+      initial_joint_vals.at(i) = q.at(i);
+    }
+    initial_joint_vals_count++;
+  }
+}
+
+int SharedControlCore::trial_length() const
+{
+  return homing_end() + max_shutdown_count;
+}
+
+
+std::string SharedControlCore::phase() const
+{
+  if (!control) return "prep";
+  if (count < recording_start) return "smoothing";
+  if (count < recording_end()) return "recording";
+  if (count < shifting_end()) return "shifting";
+  if (count < homing_end()) return "homing";
+  return "settling";
+}
+
+double SharedControlCore::progress() const
+{
+  // the prep phase counts towards the trial as well
+  int done = control ? max_prep_count + count : prep_count;
+  return std::min(1.0, (double) done / (max_prep_count + trial_length()));
+}
+
+
+///////////////////////////////////// ONE CONTROLLER TICK /////////////////////////////////////
+TickOutput SharedControlCore::tick()
+{
+  TickOutput out;
+
+  if (!control) {
+
+    prep_count++;
+    out.prep_count = prep_count;
+
+    // start the warm-up as soon as the joints have settled (at the latest warmup_time before the end of prep_time)
+    if (warmup_start < 0 && (settled_count >= required_settled_count || prep_count >= max_prep_count - warmup_ticks)) {
+      warmup_start = prep_count;
+      initial_joint_vals = curr_joint_vals;               // the robot starts from where it is now
+      initial_joint_vals_count = required_initial_vals;
+      out.warmup_started = true;
+    }
+
+    if (warmup_start >= 0) {
+      ///////// warm-up the wait-set 2 seconds before actual control /////////
+      ///////// here we need to publish the initial_joint_vals /////////
+      message_joint_vals = initial_joint_vals;
+      filter_command(out);
+      out.publish_command = true;
+
+      // the robot is held still, so the first controlled tick (or a hold right after it) starts from rest here
+      previous_command = message_joint_vals;
+      std::fill(command_velocity.begin(), command_velocity.end(), 0.0);
+      if (prep_count - warmup_start >= warmup_ticks) {
+        control = true;
+        out.control_started = true;
+      }
+    }
+    return out;
+  }
+
+  // get the robot control offset in Cartesian space (calling the corresponding function of the traj_id)
+  t_param = (double) (count - recording_start) / max_recording_count * 2 * M_PI;   // t_param is in the range [0, 2pi], but can be out of range
+  get_robot_control(t_param);
+  if (record_flag) {
+    out.noise_idx = count - recording_start;
+    out.noise = robot_offset.at(2) - ref_offset.at(2);
+  }
+
+  // plan the control shifting from the distance the tcp has to cover to get to the robot target
+  if (count == recording_end()) {
+    double d = 0.0;
+    d += pow(iax * (human_offset.at(0) - robot_offset.at(0)), 2);
+    d += pow(iay * (human_offset.at(1) - robot_offset.at(1)), 2);
+    d += pow(iaz * (human_offset.at(2) - robot_offset.at(2)), 2);
+    shift_profile = plan_cartesian_profile(sqrt(d), transition_scales);
+    shifting_ticks = (int) ceil(shift_profile.duration() * control_freq);
+  }
+
+  // gradually change control authority to fully robot after 10 second trajectory
+  if (count >= recording_end() && count <= shifting_end()) {
+    double shift_t = (shifting_ticks > 0) ? shift_profile.position((double) (count - recording_end()) / control_freq) : 1.0;
+    ax = (1.0 - shift_t) * iax;
+    ay = (1.0 - shift_t) * iay;
+    az = (1.0 - shift_t) * iaz;
+  }
+  // write the joint values at the final trajectory position, and plan the way home from there
+  if (count == shifting_end()) {
+    for (size_t i=0; i<n_joints; i++) final_joint_vals.at(i) = curr_joint_vals.at(i);
+    homing_profile = plan_joint_profile(final_joint_vals, home_joint_vals, transition_scales);
+    homing_ticks = (int) ceil(homing_profile.duration() * control_freq);
+  }
+
+  // less human authority close to a singularity (judged by the last solution, or where the robot is on the first tick)
+  if (count == 0) compute_conditioning(curr_joint_vals);
+  authority_scale = 1.0;
+  if (singularity_scaling) authority_scale = std::clamp((min_singular_value - sigma_low) / (sigma_high - sigma_low), 0.0, 1.0);
+  const double hx = authority_scale * ax;
+  const double hy = authority_scale * ay;
+  const double hz = authority_scale * az;
+
+  // perform the convex combination of robot and human offsets
+  // also adding the origin and thus representing it as tcp_pos in the robot's base frame
+  tcp_pos.at(0) = origin.at(0) + hx * human_offset.at(0) + (1-hx) * robot_offset.at(0);
+  tcp_pos.at(1) = origin.at(1) + hy * human_offset.at(1) + (1-hy) * robot_offset.at(1);
+  tcp_pos.at(2) = origin.at(2) + hz * human_offset.at(2) + (1-hz) * robot_offset.at(2);
+
+  // keep the target out of the mapped obstacles, along the way from the last (already checked) one,
+  // or from where the robot is on the first control tick
+  if (occupancy) {
+    if (count == 0) compute_fk(curr_joint_vals, previous_tcp);
+    out.tcp_clamped = occupancy->clamp(previous_tcp, tcp_pos);
+    previous_tcp = tcp_pos;
+  }
+
+  ///////// compute IK /////////
+  compute_ik(tcp_pos, curr_joint_vals, ik_joint_vals);
+
+  // never go for a solution that runs the arm into itself, keep the last clear one instead
+  // (on the first control tick that is where the robot is)
+  if (count == 0) clear_ik_joint_vals = curr_joint_vals;
+  out.self_distance = self_distance(ik_joint_vals);
+  if (out.self_distance < self_collision_margin) {
+    out.self_collision = true;
+    ik_joint_vals = clear_ik_joint_vals;
+  } else {
+    clear_ik_joint_vals = ik_joint_vals;
+  }
+
+  // how close that solution is to a singularity (one Jacobian per tick)
+  compute_conditioning(ik_joint_vals);
+  out.manipulability = manipulability;
+  out.min_singular_value = min_singular_value;
+
+  // plan the approach from the initial joint values to the Falcon-mapped position, then float until recording
+  // (at least until smoothing_time, so that the countdown always runs from 1 up to smoothing_time)
+  if (count == 0) {
+    approach_profile = plan_joint_profile(initial_joint_vals, ik_joint_vals, transition_scales);
+    approach_ticks = (int) ceil(approach_profile.duration() * control_freq);
+    recording_start = std::max(approach_ticks + control_freq * float_time, max_smoothing_count);
+  }
+
+  ///////////// a tcp position sample is due /////////////
+  if (record_flag && ((count - recording_start) % (control_freq / tcp_pub_frequency) == 0)) {
+    out.publish_tcp = true;
+    out.last_point = count > recording_end() - tcp_pub_frequency;
+    out.time_from_start = (double) (count - recording_start) / max_recording_count * traj_duration;    // out of total of 10 seconds
+  }
+
+  ///////// initial smooth transitioning from current position to Falcon-mapped position /////////
+  count++;  // increase count
+
+  if (count <= recording_start) {
+    double ratio = 0.0;
+    if (count <= approach_ticks) {
+      // jerk-limited blend, need to get there early and "float"
+      ratio = approach_profile.position((double) count / control_freq);
+    } else {
+      ratio = 1.0;
+    }
+
+    for (unsigned int i=0; i<n_joints; i++) message_joint_vals.at(i) = ratio * ik_joint_vals.at(i) + (1-ratio) * initial_joint_vals.at(i);
+
+  } else {
+    for (unsigned int i=0; i<n_joints; i++) message_joint_vals.at(i) = ik_joint_vals.at(i);
+  }
+
+  // bring it home boys
+  if (count > shifting_end()) {
+    double hr = 0.0;
+    if (count <= homing_end() && homing_ticks > 0) {
+      hr = homing_profile.position((double) (count - shifting_end()) / control_freq);
+    } else {
+      hr = 1.0;
+    }
+    for (size_t i=0; i<n_joints; i++) message_joint_vals.at(i) = hr * home_joint_vals.at(i) + (1-hr) * final_joint_vals.at(i);
+  }
+  // finish as soon as the robot has settled at home (at the latest shutdown_time after homing)
+  if (!trial_done && count >= homing_end()) {
+    double deviation = 0.0;
+    for (size_t i=0; i<n_joints; i++) deviation = std::max(deviation, std::abs(curr_joint_vals.at(i) - home_joint_vals.at(i)));
+    if (deviation < settle_tolerance || count >= trial_length()) {
+      trial_done = true;
+      out.finished = true;
+    }
+  }
+
+  // blend back in from where the last hold stopped (cosine ramp over resume_time)
+  if (resume_count > 0) {
+    double hr = 0.5 - 0.5 * cos(M_PI * resume_count / resume_ticks);
+    for (size_t i=0; i<n_joints; i++) message_joint_vals.at(i) = hr * hold_joint_vals.at(i) + (1-hr) * message_joint_vals.at(i);
+    resume_count--;
+  }
+
+  ///////// safety filter + limits /////////
+  filter_command(out);
+
+  for (size_t i=0; i<n_joints; i++) {
+    command_velocity.at(i) = message_joint_vals.at(i) - previous_command.at(i);
+    previous_command.at(i) = message_joint_vals.at(i);
+  }
+
+  out.publish_command = true;
+
+  // set the record flag as true
+  if ((count == recording_start) && (!record_flag)) {
+    record_flag = true;
+    out.record_started = true;
+  }
+
+  // set the record flag as false
+  if ((count == recording_end()) && (record_flag == true)) {
+    record_flag = false;
+    out.record_stopped = true;
+  }
+
+  ///////////// whole seconds for the countdown message /////////////
+  // (counted so that recording starts at smoothing_time, as the MarkerPublisher expects)
+  if ((count - recording_start) % control_freq == 0) {
+    int countdown = smoothing_time + (count - recording_start) / control_freq;
+    if (countdown > 0) out.countdown = countdown;
+  }
+
+  return out;
+}
+
+
+/////////////////////////////// SAFETY FILTER ///////////////////////////////
+void SharedControlCore::filter_command(TickOutput& out)
+{
+  bool outside = !within_limits(message_joint_vals);
+  out.safety_deviation = safety_filter.apply(message_joint_vals);
+  out.safety_intervened = out.safety_deviation > safety_tolerance;
+
+  // a command outside the limits, or one the filter stays far behind, only counts once it goes on for escalation_time
+  // (the filtered command itself can only end up outside if the robot already was)
+  if (outside || out.safety_deviation > max_safety_deviation) safety_violation_count++;
+  else safety_violation_count = 0;
+  if (safety_violation_count >= escalation_ticks || !within_limits(message_joint_vals)) out.limits_violated = true;
+}
+
+
+/////////////////////////////// SMOOTH HOLD ON STALE INPUTS ///////////////////////////////
+TickOutput SharedControlCore::hold_tick()
+{
+  // before control, the command does not depend on the inputs anyway
+  if (!control) return tick();
+
+  TickOutput out;
+  out.holding = true;
+
+  // coast: the command keeps its velocity, decaying exponentially, so it stops without a velocity step
+  const double decay = exp(-1.0 / (hold_time_constant * control_freq));
+  for (size_t i=0; i<n_joints; i++) {
+    command_velocity.at(i) *= decay;
+    message_joint_vals.at(i) += command_velocity.at(i);
+  }
+  filter_command(out);
+
+  // keep coasting with what the filter let through, not with the unfiltered velocity
+  for (size_t i=0; i<n_joints; i++) {
+    command_velocity.at(i) = message_joint_vals.at(i) - previous_command.at(i);
+    previous_command.at(i) = message_joint_vals.at(i);
+  }
+  hold_joint_vals = message_joint_vals;
+  resume_count = resume_ticks;
+
+  out.publish_command = true;
+  return out;
+}
+
+
+/////////////////////////////// robot control function ///////////////////////////////
+void SharedControlCore::get_robot_control(double t)
+{
+  int within_traj_count = count - recording_start;
+
+  // make sure t = [0, 2pi], wtj = [0, 5000]
+  if (t < 0.0) {t = 0.0; within_traj_count = 0;}
+  if (t > 2*M_PI) {t = 2*M_PI; within_traj_count = max_recording_count;}
+
+  // assign the noise
+  double noise = 0.0;
+  if (!robot_noise_vector.empty()) noise = noise_scale * robot_noise_vector.at(within_traj_count);
+
+  // compute reference position and assign into ref_position vector
+  get_reference_offset(t, sine, use_depth, ref_offset);
+
+  // compute robot target = reference position + noise
+  robot_offset.at(0) = ref_offset.at(0);
+  robot_offset.at(1) = ref_offset.at(1);
+  robot_offset.at(2) = ref_offset.at(2) + noise;
+}
+
+
+/////////////////////////////// my own ik function ///////////////////////////////
+
+void SharedControlCore::compute_ik(const std::vector<double>& desired_tcp_pos, const std::vector<double>& curr_vals, std::vector<double>& res_vals)
+{
+  TRACE_IK_START();
+  auto start = std::chrono::steady_clock::now();
+
+  //Create the KDL array of current joint values
+  for (unsigned int i=0; i<n_joints; i++) {
+    jnt_pos_start_(i) = curr_vals.at(i);
+  }
+
+  //Write in the initial orientation if not already done so
+  if (!got_orientation) {
+    //Compute current tcp position
+    KDL::Frame tcp_pos_start;
+    fk_solver_->JntToCart(jnt_pos_start_, tcp_pos_start);
+    orientation = tcp_pos_start.M;
+    got_orientation = true;
+  }
+
+  //Create the task-space goal object
+  KDL::Vector vec_tcp_pos_goal(desired_tcp_pos.at(0), desired_tcp_pos.at(1), desired_tcp_pos.at(2));
+  KDL::Frame tcp_pos_goal(orientation, vec_tcp_pos_goal);
+
+  //Compute inverse kinematics
+  long calls = vel_ik_solver_->calls;
+  ik_error = ik_solver_->CartToJnt(jnt_pos_start_, tcp_pos_goal, jnt_pos_goal_);
+  ik_iterations = vel_ik_solver_->calls - calls;
+
+  //Change the control joint values and finish the function
+  for (unsigned int i=0; i<n_joints; i++) {
+    res_vals.at(i) = jnt_pos_goal_.data(i);
+  }
+
+  auto finish = std::chrono::steady_clock::now();
+  ik_time_us = std::chrono::duration<double, std::micro>(finish - start).count();
+  TRACE_IK_END(ik_error);
+}
+
+
+/////////////////////////////// forward kinematics (tcp position only) ///////////////////////////////
+
+void SharedControlCore::compute_fk(const std::vector<double>& joint_vals, std::vector<double>& res_tcp_pos)
+{
+  KDL::JntArray jnt_pos(n_joints);
+  for (unsigned int i=0; i<n_joints; i++) {
+    jnt_pos(i) = joint_vals.at(i);
+  }
+
+  KDL::Frame tcp_frame;
+  fk_solver_->JntToCart(jnt_pos, tcp_frame);
+
+  for (unsigned int i=0; i<3; i++) {
+    res_tcp_pos.at(i) = tcp_frame.p(i);
+  }
+}
+
+
+void SharedControlCore::compute_link_positions(const std::vector<double>& joint_vals, std::vector<double>& res_positions)
+{
+  for (unsigned int i=0; i<n_joints; i++) {
+    jnt_pos_links_(i) = joint_vals.at(i);
+  }
+  fk_solver_->JntToCart(jnt_pos_links_, link_frames_);
+
+  res_positions.resize(3 * link_frames_.size());
+  for (size_t s=0; s<link_frames_.size(); s++) {
+    for (unsigned int i=0; i<3; i++) {
+      res_positions.at(3*s + i) = link_frames_.at(s).p(i);
+    }
+  }
+}
+
+void SharedControlCore::compute_conditioning(const std::vector<double>& joint_vals)
+{
+  for (unsigned int i=0; i<n_joints; i++) {
+    jnt_pos_links_(i) = joint_vals.at(i);
+  }
+  jac_solver_->JntToJac(jnt_pos_links_, jacobian_);
+
+  // the singular values of J are the square roots of the eigenvalues of J J^T (6 x 6, fixed size, no allocation)
+  Eigen::Matrix<double, 6, 6> jjt = jacobian_.data.lazyProduct(jacobian_.data.transpose());
+  Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, 6, 6> > eigen(jjt, Eigen::EigenvaluesOnly);
+  const auto & lambda = eigen.eigenvalues();   // ascending
+
+  double det = 1.0;
+  for (int i=0; i<6; i++) det *= std::max(lambda(i), 0.0);
+  manipulability = std::sqrt(det);
+  min_singular_value = std::sqrt(std::max(lambda(0), 0.0));
+}
+
+double SharedControlCore::self_distance(const std::vector<double>& joint_vals)
+{
+  for (unsigned int i=0; i<n_joints; i++) {
+    jnt_pos_links_(i) = joint_vals.at(i);
+  }
+  fk_solver_->JntToCart(jnt_pos_links_, link_frames_);
+  return self_collision_->min_distance(link_frames_);
+}
+
+
+///////////////// kinematic model helper functions /////////////////
+
+bool create_tree(const std::string& path, KDL::Tree& tree) {
+  if (!kdl_parser::treeFromFile(path, tree)){
+    std::cout << "Failed to construct kdl tree" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void get_chain(const KDL::Tree& tree, KDL::Chain& chain) {
+  tree.getChain("panda_link0", "panda_grasptarget", chain);
+}
+
+bool within_limits(const std::vector<double>& vals) {
+  for (unsigned int i=0; i<n_joints; i++) {
+    if (vals.at(i) > upper_joint_limits.at(i) || vals.at(i) < lower_joint_limits.at(i)) return false;
+  }
+  return true;
+}
+
+// smallest distance of any joint to its limits (negative if outside)
+double joint_limit_margin(const std::vector<double>& vals) {
+  double margin = upper_joint_limits.at(0) - lower_joint_limits.at(0);
+  for (unsigned int i=0; i<n_joints; i++) {
+    margin = std::min(margin, upper_joint_limits.at(i) - vals.at(i));
+    margin = std::min(margin, vals.at(i) - lower_joint_limits.at(i));
+  }
+  return margin;
+}
+
+
+///////////////// Noise helper functions /////////////////
+
+// Function to read CSV file and store data in a C++ array
+void readCSV(const std::string& filename, std::vector<double>& dataArray) {
+    std::ifstream file(filename);
+
+    if (file.is_open()) {
+        std::string line;
+        getline(file, line); // Read the entire line from the CSV
+
+        std::stringstream ss(line);
+        std::string value;
+
+        while (getline(ss, value, ',')) {
+            // one double per comma-separated field
+            double dataValue = std::stod(value);
+            dataArray.push_back(dataValue);
+        }
+
+        file.close();
+    } else {
+        std::cerr << "Unable to open the file: " << filename << std::endl;
+    }
+}
+
+// Function to linearly interpolate between two numbers for a given mu
+double linearInterpolate(double y1, double y2, double mu) { return (y2 - y1) * mu + y1; }
+
+// Function to cosine interpolate between two numbers for a given mu
+double cosineInterpolate(double y1, double y2, double mu) {
+    double angle = mu * M_PI;
+    double mu2 = (1.0 - std::cos(angle)) * 0.5;
+    double res = linearInterpolate(y1, y2, mu2);
+    return res;
+}
+
+// Function to linearly interpolate a vector and return a new vector
+std::vector<double> linear_interpolate_vec(std::vector<double> old_vec, int num_interp) {
+    int num_old_points = old_vec.size();
+    std::vector<double> new_vec = {old_vec.at(0)};
+    for (int i=0; i<num_old_points-1; i++) {
+        for (int j=1; j<num_interp+2; j++) {
+            double mu = (double)j / (double)(num_interp+1);
+            double lin_x = linearInterpolate(old_vec.at(i), old_vec.at(i+1), mu);
+            new_vec.push_back(lin_x);
+        }
+    }
+    return new_vec;
+}
+
+// Function to cosine interpolate a vector and return a new vector
+std::vector<double> cosine_interpolate_vec(std::vector<double> old_vec, int num_interp) {
+    int num_old_points = old_vec.size();
+    std::vector<double> new_vec = {old_vec.at(0)};
+    for (int i=0; i<num_old_points-1; i++) {
+        for (int j=1; j<num_interp+2; j++) {
+            double mu = (double)j / (double)(num_interp+1);
+            double lin_x = cosineInterpolate(old_vec.at(i), old_vec.at(i+1), mu);
+            new_vec.push_back(lin_x);
+        }
+    }
+    return new_vec;
+}
+
+std::vector<double> generate_noise_vector(const std::string& filename) {
+
+  std::vector<double> raw_data;
+  const int num_interp = 49;
+
+  // read csv file
+  readCSV(noise_csv_dir + filename, raw_data);
+  std::cout << "Length of raw noise array = " << raw_data.size() << std::endl;
+  if (raw_data.empty()) return raw_data;
+
+  // interpolate (linear / cosine)
+  std::vector<double> noise_vector = linear_interpolate_vec(raw_data, num_interp);
+  std::cout << "Success! Length of new noise vector = " << noise_vector.size() << std::endl;
+  return noise_vector;
+}
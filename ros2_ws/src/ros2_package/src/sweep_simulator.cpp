@@ -0,0 +1,262 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Headless parameter-sweep simulator for choosing
+//   experimental conditions
+//
+// - Main functionalities:
+//   1. Runs the SharedControlCore (convex combination,
+//      IK, phase machine) for every combination of
+//      alpha_id x traj_id x mapping_ratio x noise_scale
+//   2. Drives the human input with the recorded human
+//      trajectories in csv_logs (same traj_id)
+//   3. Spreads the conditions over a pool of worker
+//      threads, each owning its own controller core
+//   4. Writes the expected tracking error, joint-limit
+//      and self-collision margins and IK cost of each
+//      condition to a csv
+//
+// - Human model: the hand-space tracking error of a
+//   recorded trial, (human - ref) / recorded_ratio, is
+//   re-applied on top of the reference and scaled by
+//   the mapping_ratio under test
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tool_args.hpp"
+#include "ros2_package/trial_log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/////////////////// sweep settings (overridable from the command line) ///////////////////
+struct SweepSettings
+{
+  std::string urdf {urdf_path};
+  std::string csv_dir {""};
+  std::string out_file {"sweep_results.csv"};
+  std::string noise_file {"noise1.csv"};
+  unsigned int threads {std::max(1u, std::thread::hardware_concurrency())};
+
+  std::vector<int> alpha_ids {0, 1, 2, 3, 4, 5};
+  std::vector<int> traj_ids {0, 1, 2, 3, 4, 5};
+  std::vector<double> mapping_ratios {2.0, 3.0, 4.0};
+  std::vector<double> noise_scales {0.0, 1.0};
+
+  int use_depth {0};
+  int humans_per_condition {5};    // recorded trials used as human model per condition
+  double recorded_ratio {3.0};     // mapping_ratio the trials in csv_logs were recorded with
+};
+
+struct SweepCondition
+{
+  int alpha_id;
+  int traj_id;
+  double mapping_ratio;
+  double noise_scale;
+};
+
+struct SweepResult
+{
+  int runs = 0;
+  double tracking_err = 0.0;       // mean Euclidean tcp-to-reference error while recording [m]
+  double joint_margin = 1e9;       // smallest distance of any commanded joint to its limits [rad]
+  double ik_mean_us = 0.0;
+  double ik_p99_us = 0.0;
+  double ik_max_us = 0.0;
+  int limit_violations = 0;        // ticks with commanded joints outside the limits
+  int safety_interventions = 0;    // ticks whose command the safety filter changed
+  double self_margin = 1e9;        // closest approach of the link capsules over the IK solutions [m]
+  int self_collisions = 0;         // ticks whose IK solution was rejected as self-colliding
+  double min_sigma = 1e9;          // smallest singular value of the Jacobian over the IK solutions
+};
+
+
+/////////////////// function declarations ///////////////////
+bool parse_args(int argc, char * argv[], SweepSettings& settings);
+SweepResult run_condition(SharedControlCore& core, const SweepCondition& cond, const std::vector<HumanModel>& humans, int use_depth);
+
+
+/////////////////// run all recorded humans through one condition ///////////////////
+SweepResult run_condition(SharedControlCore& core, const SweepCondition& cond, const std::vector<HumanModel>& humans, int use_depth)
+{
+  SweepResult res;
+  std::vector<double> ik_times;
+  ik_times.reserve(humans.size() * core.trial_length());
+
+  std::vector<double> ref {0.0, 0.0, 0.0};
+  std::vector<double> err {0.0, 0.0, 0.0};
+  double err_sum = 0.0;
+  int err_samples = 0;
+
+  // a perfect human (no hand error) if there is no recording of this trajectory
+  const HumanModel perfect_human {{0.0}, {{0.0, 0.0, 0.0}}};
+  const size_t n_runs = std::max<size_t>(humans.size(), 1);
+
+  for (size_t h=0; h<n_runs; h++) {
+    const HumanModel& human = humans.empty() ? perfect_human : humans.at(h);
+
+    // start settled at home, as after the previous trial
+    core.noise_scale = cond.noise_scale;
+    core.curr_joint_vals = home_joint_vals;
+    core.start_trial(cond.alpha_id, cond.traj_id, use_depth, cond.mapping_ratio);
+    core.skip_prep();
+
+    bool finished = false;
+    while (!finished) {
+
+      ///////// human model: reference + scaled hand-space error /////////
+      double t = (double) (core.count - core.recording_start) / core.max_recording_count * 2 * M_PI;
+      get_reference_offset(std::clamp(t, 0.0, 2 * M_PI), core.sine, use_depth, ref);
+      interpolate_log(human.times, human.hand_err, (double) (core.count - core.recording_start) / core.control_freq, err);
+      for (size_t i=0; i<3; i++) core.human_offset.at(i) = ref.at(i) + cond.mapping_ratio * err.at(i);
+
+      ///////// one controller tick /////////
+      TickOutput out = core.tick();
+      finished = out.finished;
+
+      if (core.control && out.prep_count < 0) {
+        ik_times.push_back(core.ik_time_us);
+        res.joint_margin = std::min(res.joint_margin, joint_limit_margin(core.message_joint_vals));
+        if (out.limits_violated) res.limit_violations++;
+        if (out.safety_intervened) res.safety_interventions++;
+        res.self_margin = std::min(res.self_margin, out.self_distance);
+        if (out.self_collision) res.self_collisions++;
+        res.min_sigma = std::min(res.min_sigma, out.min_singular_value);
+      }
+
+      ///////// tracking error at the same 40 Hz samples the TrajRecorder logs /////////
+      if (out.publish_tcp) {
+        double e = 0.0;
+        for (size_t i=(use_depth ? 0 : 1); i<3; i++) e += pow(core.tcp_pos.at(i) - core.origin.at(i) - core.ref_offset.at(i), 2);
+        err_sum += sqrt(e);
+        err_samples++;
+      }
+
+      ///////// ideal plant: the joints reach the command within one tick /////////
+      core.curr_joint_vals = core.message_joint_vals;
+    }
+    res.runs++;
+  }
+
+  if (err_samples > 0) res.tracking_err = err_sum / err_samples;
+
+  if (!ik_times.empty()) {
+    double ik_sum = 0.0;
+    for (double v : ik_times) ik_sum += v;
+    res.ik_mean_us = ik_sum / ik_times.size();
+
+    size_t p99_idx = (size_t) (0.99 * (ik_times.size() - 1));
+    std::nth_element(ik_times.begin(), ik_times.begin() + p99_idx, ik_times.end());
+    res.ik_p99_us = ik_times.at(p99_idx);
+    res.ik_max_us = *std::max_element(ik_times.begin() + p99_idx, ik_times.end());
+  }
+  return res;
+}
+
+
+/////////////////// command line parsing ///////////////////
+bool parse_args(int argc, char * argv[], SweepSettings& settings)
+{
+  bool ok = parse_key_values(argc, argv, [&](const std::string& key, const std::string& value) {
+      if (key == "--urdf") settings.urdf = value;
+      else if (key == "--csv_dir") settings.csv_dir = value;
+      else if (key == "--out") settings.out_file = value;
+      else if (key == "--noise_file") settings.noise_file = value;
+      else if (key == "--threads") settings.threads = std::max(1, std::stoi(value));
+      else if (key == "--alpha_ids") settings.alpha_ids = parse_list<int>(value);
+      else if (key == "--traj_ids") settings.traj_ids = parse_list<int>(value);
+      else if (key == "--mapping_ratios") settings.mapping_ratios = parse_list<double>(value);
+      else if (key == "--noise_scales") settings.noise_scales = parse_list<double>(value);
+      else if (key == "--use_depth") settings.use_depth = std::stoi(value);
+      else if (key == "--humans_per_condition") settings.humans_per_condition = std::stoi(value);
+      else if (key == "--recorded_ratio") settings.recorded_ratio = std::stod(value);
+      else return false;
+      return true;
+    });
+  if (!ok) return false;
+  return check_ids("--alpha_ids", settings.alpha_ids, alphas_dict.size()) && check_ids("--traj_ids", settings.traj_ids, n_traj_ids);
+}
+
+
+//////////////////// MAIN FUNCTION ///////////////////
+
+int main(int argc, char * argv[])
+{
+  SweepSettings settings;
+  if (!parse_args(argc, argv, settings)) {
+    std::cerr << "usage: sweep_simulator [--csv_dir DIR] [--out FILE] [--threads N] [--alpha_ids 0,1,..] [--traj_ids 0,1,..]\n"
+              << "                       [--mapping_ratios 2.0,3.0,..] [--noise_scales 0.0,1.0,..] [--use_depth 0|1]\n"
+              << "                       [--humans_per_condition N] [--recorded_ratio R] [--noise_file FILE] [--urdf FILE]" << std::endl;
+    return 1;
+  }
+
+  // the kinematic chain is loaded once (from the cache if up to date) and copied into every worker's core
+  KDL::Chain panda_chain;
+  if (!load_panda_chain(settings.urdf, panda_chain)) return 1;
+
+  const std::vector<double> noise = generate_noise_vector(settings.noise_file);
+
+  // load the human models once per trajectory
+  std::vector< std::vector<HumanModel> > humans_per_traj(n_traj_ids);
+  for (int traj_id : settings.traj_ids) humans_per_traj.at(traj_id) = load_human_models(settings.csv_dir, traj_id, settings.humans_per_condition, settings.recorded_ratio);
+
+  // all conditions of the sweep
+  std::vector<SweepCondition> conditions;
+  for (int alpha_id : settings.alpha_ids)
+    for (int traj_id : settings.traj_ids)
+      for (double mapping_ratio : settings.mapping_ratios)
+        for (double noise_scale : settings.noise_scales)
+          conditions.push_back({alpha_id, traj_id, mapping_ratio, noise_scale});
+
+  std::cout << "Running " << conditions.size() << " conditions on " << settings.threads << " threads ..." << std::endl;
+
+  // each worker owns a core and pulls the next condition, results are written to their own slot
+  std::vector<SweepResult> results(conditions.size());
+  std::atomic<size_t> next_condition {0};
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned int w=0; w<settings.threads; w++) {
+    workers.emplace_back([&]() {
+      SharedControlCore core(panda_chain);
+      core.robot_noise_vector = noise;
+
+      for (size_t c = next_condition++; c < conditions.size(); c = next_condition++) {
+        const SweepCondition& cond = conditions.at(c);
+        results.at(c) = run_condition(core, cond, humans_per_traj.at(cond.traj_id), settings.use_depth);
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  auto finish = std::chrono::steady_clock::now();
+  double duration = std::chrono::duration<double>(finish - start).count();
+
+  // write the results
+  std::ofstream out(settings.out_file);
+  out << "alpha_id,traj_id,mapping_ratio,noise_scale,use_depth,runs,tracking_err,joint_margin,ik_mean_us,ik_p99_us,ik_max_us,limit_violations,safety_interventions,self_margin,self_collisions,min_sigma\n";
+  for (size_t c=0; c<conditions.size(); c++) {
+    const SweepCondition& cond = conditions.at(c);
+    const SweepResult& res = results.at(c);
+    out << cond.alpha_id << "," << cond.traj_id << "," << cond.mapping_ratio << "," << cond.noise_scale << "," << settings.use_depth << ","
+        << res.runs << "," << res.tracking_err << "," << res.joint_margin << "," << res.ik_mean_us << "," << res.ik_p99_us << ","
+        << res.ik_max_us << "," << res.limit_violations << "," << res.safety_interventions << "," << res.self_margin << "," << res.self_collisions << "," << res.min_sigma << "\n";
+  }
+
+  std::cout << "Finished " << conditions.size() << " conditions in " << duration << " seconds, results written to "
+            << settings.out_file << std::endl;
+  return 0;
+}
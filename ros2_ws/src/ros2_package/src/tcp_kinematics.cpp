@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the TcpKinematics kernel (chain
+//   folding, FK + TCP velocity pass, quaternion)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/tcp_kinematics.hpp"
+
+#include <cmath>
+
+#include <kdl/frames.hpp>
+
+
+static void to_arrays(const KDL::Frame & frame, double rotation[9], double position[3])
+{
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++) rotation[3*i + j] = frame.M(i, j);
+    position[i] = frame.p(i);
+  }
+}
+
+// c = a * b, 3 x 3 row-major
+static inline void mat_mul(const double a[9], const double b[9], double c[9])
+{
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++) c[3*i + j] = a[3*i] * b[j] + a[3*i + 1] * b[3 + j] + a[3*i + 2] * b[6 + j];
+  }
+}
+
+// y = a * x
+static inline void mat_vec(const double a[9], const double x[3], double y[3])
+{
+  for (int i=0; i<3; i++) y[i] = a[3*i] * x[0] + a[3*i + 1] * x[1] + a[3*i + 2] * x[2];
+}
+
+// rotation by angle about the unit axis k (Rodrigues)
+static inline void axis_rotation(const double k[3], double angle, double r[9])
+{
+  const double c = std::cos(angle), s = std::sin(angle), v = 1.0 - c;
+  r[0] = c + k[0] * k[0] * v;         r[1] = k[0] * k[1] * v - k[2] * s;  r[2] = k[0] * k[2] * v + k[1] * s;
+  r[3] = k[1] * k[0] * v + k[2] * s;  r[4] = c + k[1] * k[1] * v;         r[5] = k[1] * k[2] * v - k[0] * s;
+  r[6] = k[2] * k[0] * v - k[1] * s;  r[7] = k[2] * k[1] * v + k[0] * s;  r[8] = c + k[2] * k[2] * v;
+}
+
+
+TcpKinematics::TcpKinematics(const KDL::Chain & chain)
+{
+  // a KDL segment is pose(q) = Trans(origin) * Rot(axis, q) * Trans(-origin) * f_tip, so everything up to
+  // Trans(origin) goes into the joint's constant frame and the rest into the next one (or the tool)
+  KDL::Frame pending = KDL::Frame::Identity();
+  for (unsigned int s=0; s<chain.getNrOfSegments(); s++) {
+    const KDL::Segment & segment = chain.getSegment(s);
+    const KDL::Joint & joint = segment.getJoint();
+
+    if (joint.getType() == KDL::Joint::None) {
+      pending = pending * segment.getFrameToTip();
+      continue;
+    }
+    if (joint.getType() > KDL::Joint::RotZ || n == max_joints) {
+      valid = false;
+      continue;
+    }
+
+    to_arrays(pending * KDL::Frame(joint.JointOrigin()), joint_rotation[n], joint_position[n]);
+    KDL::Vector axis = joint.JointAxis();
+    double norm = axis.Norm();
+    for (int i=0; i<3; i++) joint_axis[n][i] = axis(i) / norm;
+    names.push_back(joint.getName());
+    n++;
+
+    pending = KDL::Frame(KDL::Vector(-joint.JointOrigin().x(), -joint.JointOrigin().y(), -joint.JointOrigin().z())) * segment.getFrameToTip();
+  }
+  to_arrays(pending, tool_rotation, tool_position);
+  if (n == 0) valid = false;
+}
+
+
+void TcpKinematics::compute(const double* q, const double* qdot)
+{
+  double rotation[9] = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  double origin[3] = {0.0, 0.0, 0.0};
+  double tmp[9], step[9], offset[3];
+
+  // joint axes and origins in the root frame, for the velocity
+  double axes[max_joints][3], origins[max_joints][3];
+
+  for (int i=0; i<n; i++) {
+    // into the joint frame
+    mat_vec(rotation, joint_position[i], offset);
+    for (int j=0; j<3; j++) origin[j] += offset[j];
+    mat_mul(rotation, joint_rotation[i], tmp);
+
+    mat_vec(tmp, joint_axis[i], axes[i]);
+    for (int j=0; j<3; j++) origins[i][j] = origin[j];
+
+    // and about its axis
+    axis_rotation(joint_axis[i], q[i], step);
+    mat_mul(tmp, step, rotation);
+  }
+
+  // the tool
+  mat_vec(rotation, tool_position, offset);
+  for (int j=0; j<3; j++) position[j] = origin[j] + offset[j];
+  mat_mul(rotation, tool_rotation, tmp);
+
+  // quaternion from the largest of its components (the other ones follow without cancellation)
+  const double trace = tmp[0] + tmp[4] + tmp[8];
+  if (trace > tmp[0] && trace > tmp[4] && trace > tmp[8]) {
+    double s = 2.0 * std::sqrt(1.0 + trace);
+    orientation[3] = 0.25 * s;
+    orientation[0] = (tmp[7] - tmp[5]) / s;
+    orientation[1] = (tmp[2] - tmp[6]) / s;
+    orientation[2] = (tmp[3] - tmp[1]) / s;
+  } else if (tmp[0] > tmp[4] && tmp[0] > tmp[8]) {
+    double s = 2.0 * std::sqrt(1.0 + tmp[0] - tmp[4] - tmp[8]);
+    orientation[3] = (tmp[7] - tmp[5]) / s;
+    orientation[0] = 0.25 * s;
+    orientation[1] = (tmp[1] + tmp[3]) / s;
+    orientation[2] = (tmp[2] + tmp[6]) / s;
+  } else if (tmp[4] > tmp[8]) {
+    double s = 2.0 * std::sqrt(1.0 + tmp[4] - tmp[0] - tmp[8]);
+    orientation[3] = (tmp[2] - tmp[6]) / s;
+    orientation[0] = (tmp[1] + tmp[3]) / s;
+    orientation[1] = 0.25 * s;
+    orientation[2] = (tmp[5] + tmp[7]) / s;
+  } else {
+    double s = 2.0 * std::sqrt(1.0 + tmp[8] - tmp[0] - tmp[4]);
+    orientation[3] = (tmp[3] - tmp[1]) / s;
+    orientation[0] = (tmp[2] + tmp[6]) / s;
+    orientation[1] = (tmp[5] + tmp[7]) / s;
+    orientation[2] = 0.25 * s;
+  }
+
+  // v = sum of z_i x (p - p_i) qdot_i, w = sum of z_i qdot_i
+  for (int j=0; j<3; j++) velocity[j] = angular_velocity[j] = 0.0;
+  if (!qdot) return;
+  for (int i=0; i<n; i++) {
+    const double* z = axes[i];
+    double r[3] = {position[0] - origins[i][0], position[1] - origins[i][1], position[2] - origins[i][2]};
+    velocity[0] += (z[1] * r[2] - z[2] * r[1]) * qdot[i];
+    velocity[1] += (z[2] * r[0] - z[0] * r[2]) * qdot[i];
+    velocity[2] += (z[0] * r[1] - z[1] * r[0]) * qdot[i];
+    for (int j=0; j<3; j++) angular_velocity[j] += z[j] * qdot[i];
+  }
+}
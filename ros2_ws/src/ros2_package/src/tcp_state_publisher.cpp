@@ -0,0 +1,178 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - C++ class implementation of the TcpStatePublisher node,
+//   which reports where the TCP actually is, while the
+//   controller's tcp_position is where it was commanded to
+//
+// - Main functionalities:
+//   1. Subscribes to the robot joint states ("franka/joint_states",
+//      1 kHz on the FR3), matched to the chain by joint name, or
+//      taken in order (as the controllers do) if the names differ
+//   2. Runs the fixed-size forward kinematics of the TCP on
+//      every message (tcp_kinematics.hpp, well under 1 us)
+//   3. Publishes the measured TCP pose and velocity, stamped with
+//      the joint state time ("tcp_measured", TcpStateStamped)
+//      (-> TrajRecorder, which logs it next to the commanded TCP)
+//
+// - A node of its own, so the controller's command path does
+//   not do any of this work
+//
+// - ros2 run ros2_package tcp_state_publisher [urdf]
+//   (the controllers' URDF, the installed one by default)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/joint_state.hpp"
+#include "tutorial_interfaces/msg/tcp_state_stamped.hpp"
+
+#include "ros2_package/chain_cache.hpp"
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tcp_kinematics.hpp"
+
+
+class TcpStatePublisher : public rclcpp::Node
+{
+public:
+
+  std::string input_topic {"franka/joint_states"};
+  std::string output_topic {"tcp_measured"};
+  std::string frame_id {"panda_link0"};    // root of the chain
+
+  const int report_every = 10000;   // messages between the timing reports (10 s at 1 kHz)
+
+  explicit TcpStatePublisher(const KDL::Chain & chain)
+  : Node("tcp_state_publisher"),
+    kinematics(chain)
+  {
+    input_topic = this->declare_parameter("input_topic", input_topic);
+    output_topic = this->declare_parameter("output_topic", output_topic);
+
+    out_msg.header.frame_id = frame_id;
+    index.assign(kinematics.n_joints(), -1);
+
+    tcp_pub_ = this->create_publisher<tutorial_interfaces::msg::TcpStateStamped>(output_topic, 10);
+    joint_states_sub_ = this->create_subscription<sensor_msgs::msg::JointState>(
+      input_topic, rclcpp::SensorDataQoS(),
+      std::bind(&TcpStatePublisher::joint_states_callback, this, std::placeholders::_1));
+
+    std::cout << "Forward kinematics of " << input_topic << " (" << kinematics.n_joints() << " joints) -> "
+              << output_topic << " in " << frame_id << std::endl;
+  }
+
+private:
+
+  ///////////////////////////////////// JOINT STATE SUBSCRIBER /////////////////////////////////////
+  void joint_states_callback(const sensor_msgs::msg::JointState & msg)
+  {
+    if (!match_joints(msg)) return;
+
+    const int n = kinematics.n_joints();
+    const bool has_velocity = msg.velocity.size() == msg.position.size();
+    for (int i=0; i<n; i++) {
+      q[i] = msg.position[index[i]];
+      qdot[i] = has_velocity ? msg.velocity[index[i]] : 0.0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    kinematics.compute(q, has_velocity ? qdot : nullptr);
+    double fk_time_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    out_msg.header.stamp = msg.header.stamp;
+    for (int j=0; j<3; j++) {
+      out_msg.tcp_position[j] = kinematics.position[j];
+      out_msg.tcp_velocity[j] = kinematics.velocity[j];
+    }
+    for (int j=0; j<4; j++) out_msg.tcp_orientation[j] = kinematics.orientation[j];
+    out_msg.fk_time_us = fk_time_us;
+    tcp_pub_->publish(out_msg);
+
+    ///////// timing report /////////
+    time_sum += fk_time_us;
+    if (++n_messages % report_every == 0) {
+      std::cout << "Last " << report_every << " joint states: " << time_sum / report_every << " us of kinematics each" << std::endl;
+      time_sum = 0.0;
+    }
+  }
+
+  // position of each chain joint in the message: by name if the message has the chain's names, otherwise the
+  // first n positions in order, as the controllers read them (an FR3 driver names its joints fr3_joint*)
+  bool match_joints(const sensor_msgs::msg::JointState & msg)
+  {
+    const int n = kinematics.n_joints();
+    if (msg.name.size() == n_names && index.at(0) >= 0) return true;
+
+    n_names = msg.name.size();
+    bool by_name = !msg.name.empty();
+    for (int i=0; i<n && by_name; i++) {
+      index.at(i) = -1;
+      for (std::size_t k=0; k<msg.name.size(); k++) {
+        if (msg.name.at(k) == kinematics.joint_names().at(i)) index.at(i) = k;
+      }
+      by_name = index.at(i) >= 0;
+    }
+    if (!by_name) {
+      for (int i=0; i<n; i++) index.at(i) = i;
+      if (!msg.name.empty()) std::cout << "Joint names on " << input_topic << " do not match the chain, taking the first " << n << " positions in order" << std::endl;
+    }
+
+    if ((int) msg.position.size() < n || *std::max_element(index.begin(), index.end()) >= (int) msg.position.size()) {
+      if (!warned) std::cout << "Dropping the joint states on " << input_topic << ": fewer than " << n << " positions" << std::endl;
+      warned = true;
+      index.at(0) = -1;
+      return false;
+    }
+    return true;
+  }
+
+  TcpKinematics kinematics;
+  std::vector<int> index;
+  std::size_t n_names = 0;
+  bool warned = false;
+  double q[TcpKinematics::max_joints];
+  double qdot[TcpKinematics::max_joints];
+  tutorial_interfaces::msg::TcpStateStamped out_msg;
+
+  long n_messages = 0;
+  double time_sum = 0.0;
+
+  rclcpp::Publisher<tutorial_interfaces::msg::TcpStateStamped>::SharedPtr tcp_pub_;
+  rclcpp::Subscription<sensor_msgs::msg::JointState>::SharedPtr joint_states_sub_;
+};
+
+
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  std::vector<std::string> args = rclcpp::remove_ros_arguments(argc, argv);
+
+  // same chain as the controllers (panda_link0 -> panda_grasptarget)
+  KDL::Chain panda_chain;
+  if (!load_panda_chain((args.size() > 1) ? args.at(1) : urdf_path, panda_chain)) {
+    rclcpp::shutdown();
+    return 1;
+  }
+  TcpKinematics check(panda_chain);
+  if (!check.ok()) {
+    std::cout << "The kinematic chain has joints other than revolute ones, or more than " << TcpKinematics::max_joints << std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  // initialize node and spin it
+  rclcpp::spin(std::make_shared<TcpStatePublisher>(panda_chain));
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,45 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the offline tools' command line
+//   parsing
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/tool_args.hpp"
+
+#include <iostream>
+
+
+/////////////////// "--key value" pairs ///////////////////
+bool parse_key_values(int argc, char * argv[], const std::function<bool(const std::string&, const std::string&)>& set_arg)
+{
+  for (int i=1; i+1<argc; i+=2) {
+    std::string key = argv[i];
+    std::string value = argv[i+1];
+    if (!set_arg(key, value)) {
+      std::cerr << "Unknown argument: " << key << std::endl;
+      return false;
+    }
+  }
+  if (argc % 2 == 0) {
+    std::cerr << "Missing value for argument: " << argv[argc-1] << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+/////////////////// id lists ///////////////////
+bool check_ids(const std::string& key, const std::vector<int>& ids, int n_ids)
+{
+  for (int id : ids) {
+    if (id < 0 || id >= n_ids) {
+      std::cerr << "Invalid " << key << ": " << id << " is not in [0, " << n_ids - 1 << "]" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
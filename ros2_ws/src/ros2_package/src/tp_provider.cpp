@@ -0,0 +1,15 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Instantiates the probes of the "ros2_package" LTTng
+//   tracepoint provider (tp_provider.h), linked into every
+//   node through the ros2_package_tracing library
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#define TRACEPOINT_CREATE_PROBES
+#define TRACEPOINT_DEFINE
+
+#include "ros2_package/tp_provider.h"
@@ -0,0 +1,144 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the csv_logs reading functions
+//   and of the human models built from them
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/trial_log.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+
+/////////////////// split a csv line on commas outside of quotes ///////////////////
+static std::vector<std::string> split_csv_line(const std::string& line)
+{
+  std::vector<std::string> fields {""};
+  bool quoted = false;
+  for (char c : line) {
+    if (c == '"') quoted = !quoted;
+    else if (c == ',' && !quoted) fields.push_back("");
+    else fields.back() += c;
+  }
+  return fields;
+}
+
+
+/////////////////// read one recorded trial ///////////////////
+bool load_trial_log(const std::string& filename, TrialLog& log)
+{
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    std::cerr << "Unable to open the trial file: " << filename << std::endl;
+    return false;
+  }
+
+  std::string line;
+  while (getline(file, line)) {
+    std::vector<std::string> fields = split_csv_line(line);
+
+    size_t ref_col = 3, human_col = 0, tcp_col = 6, time_col = 17;
+    if (fields.size() == 27 || fields.size() == 30) {ref_col = 0; human_col = 3; tcp_col = 9; time_col = 24;}
+    else if (fields.size() != 20) continue;
+
+    log.ref_pos.push_back({std::stod(fields.at(ref_col)), std::stod(fields.at(ref_col+1)), std::stod(fields.at(ref_col+2))});
+    log.human_pos.push_back({std::stod(fields.at(human_col)), std::stod(fields.at(human_col+1)), std::stod(fields.at(human_col+2))});
+    log.tcp_pos.push_back({std::stod(fields.at(tcp_col)), std::stod(fields.at(tcp_col+1)), std::stod(fields.at(tcp_col+2))});
+    log.times.push_back(std::stod(fields.at(time_col)));
+    if (fields.size() == 30) log.measured_pos.push_back({std::stod(fields.at(27)), std::stod(fields.at(28)), std::stod(fields.at(29))});
+  }
+  return !log.times.empty();
+}
+
+
+/////////////////// find all trials and their conditions ///////////////////
+std::vector<TrialInfo> find_trial_logs(const std::string& csv_dir)
+{
+  namespace fs = std::filesystem;
+  std::vector<TrialInfo> trials;
+
+  if (!fs::is_directory(csv_dir)) {
+    std::cerr << "Not a directory: " << csv_dir << std::endl;
+    return trials;
+  }
+
+  for (const auto& entry : fs::directory_iterator(csv_dir)) {
+    std::string part_name = entry.path().filename().string();
+    if (!entry.is_directory() || part_name.rfind("part", 0) != 0) continue;
+    int part_id = std::stoi(part_name.substr(4));
+
+    // header columns start with trial_number, alpha_id, traj_id
+    std::ifstream header(entry.path() / (part_name + "_header.csv"));
+    std::string line;
+    if (!getline(header, line)) continue;
+
+    while (getline(header, line)) {
+      std::vector<std::string> fields = split_csv_line(line);
+      if (fields.size() < 3) continue;
+
+      TrialInfo info;
+      info.part_id = part_id;
+      info.trial_number = std::stoi(fields.at(0));
+      info.alpha_id = std::stoi(fields.at(1));
+      info.traj_id = std::stoi(fields.at(2));
+      info.file = (entry.path() / ("trial" + std::to_string(info.trial_number) + ".csv")).string();
+      if (fs::exists(info.file)) trials.push_back(info);
+    }
+  }
+
+  // keep a deterministic order regardless of the directory listing
+  std::sort(trials.begin(), trials.end(), [](const TrialInfo& a, const TrialInfo& b) {
+    return (a.part_id != b.part_id) ? a.part_id < b.part_id : a.trial_number < b.trial_number;
+  });
+  return trials;
+}
+
+
+/////////////////// interpolate a logged position ///////////////////
+void interpolate_log(const std::vector<double>& times, const std::vector< std::vector<double> >& pos,
+                     double t, std::vector<double>& res)
+{
+  // first sample after t
+  size_t hi = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+
+  if (hi == 0 || hi == times.size()) {
+    size_t idx = (hi == 0) ? 0 : times.size() - 1;
+    for (size_t i=0; i<3; i++) res.at(i) = pos.at(idx).at(i);
+    return;
+  }
+
+  double mu = (t - times.at(hi-1)) / (times.at(hi) - times.at(hi-1));
+  for (size_t i=0; i<3; i++) res.at(i) = (pos.at(hi).at(i) - pos.at(hi-1).at(i)) * mu + pos.at(hi-1).at(i);
+}
+
+
+/////////////////// hand-space errors of the recorded trials of a trajectory ///////////////////
+std::vector<HumanModel> load_human_models(const std::string& csv_dir, int traj_id, int max_humans, double recorded_ratio)
+{
+  std::vector<HumanModel> humans;
+  if (csv_dir.empty()) return humans;
+
+  for (const TrialInfo& info : find_trial_logs(csv_dir)) {
+    if (info.traj_id != traj_id) continue;
+    if ((int) humans.size() >= max_humans) break;
+
+    TrialLog log;
+    if (!load_trial_log(info.file, log)) continue;
+
+    HumanModel human;
+    human.times = log.times;
+    for (size_t k=0; k<log.times.size(); k++) {
+      std::vector<double> e {0.0, 0.0, 0.0};
+      for (size_t i=0; i<3; i++) e.at(i) = (log.human_pos.at(k).at(i) - log.ref_pos.at(k).at(i)) / recorded_ratio;
+      human.hand_err.push_back(e);
+    }
+    humans.push_back(human);
+  }
+  return humans;
+}
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the TrialReplay (input injection,
+//   kinematic plant, diff against the log)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/trial_replay.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+
+/////////////////// replay files of a namespace ///////////////////
+std::string replace_namespace(std::string path, const std::string & name_space)
+{
+  for (size_t pos = path.find(namespace_placeholder); pos != std::string::npos; pos = path.find(namespace_placeholder, pos)) {
+    path.replace(pos, namespace_placeholder.size(), name_space);
+    pos += name_space.size();
+  }
+  return path;
+}
+
+
+TrialReplay::TrialReplay(const std::string & a_file, const std::string & a_output, double a_plant_time_constant, int a_control_freq)
+: file(a_file),
+  output(a_output),
+  plant_time_constant(a_plant_time_constant),
+  control_freq(a_control_freq),
+  plant_gain((a_plant_time_constant > 0.0) ? std::min(1.0 / (a_control_freq * a_plant_time_constant), 1.0) : 1.0)
+{
+}
+
+bool TrialReplay::load()
+{
+  load_trial_log(file, log);
+  std::cout << "Loaded " << log.times.size() << " samples from replay file " << file << std::endl;
+  return !log.times.empty();
+}
+
+void TrialReplay::inject_input(SharedControlCore & core)
+{
+  double t_rec = (double) (core.count - core.recording_start) / control_freq;
+  interpolate_log(log.times, log.human_pos, t_rec, human_pos);
+  for (size_t i=0; i<3; i++) core.human_offset.at(i) = human_pos.at(i) - core.origin.at(i);
+}
+
+void TrialReplay::step_plant(SharedControlCore & core) const
+{
+  for (unsigned int i=0; i<n_joints; i++) {
+    core.curr_joint_vals.at(i) += plant_gain * (core.message_joint_vals.at(i) - core.curr_joint_vals.at(i));
+  }
+}
+
+void TrialReplay::record_sample(SharedControlCore & core)
+{
+  std::vector<double> measured {0.0, 0.0, 0.0};
+  core.compute_fk(core.curr_joint_vals, measured);
+  tcp_pos.push_back(core.tcp_pos);
+  measured_pos.push_back(measured);
+}
+
+
+/////////////////// diff against the log ///////////////////
+void TrialReplay::write_diff(double sim_time, double wall_time) const
+{
+  const std::vector< std::vector<double> > & log_tcp_pos = log.tcp_pos;
+  size_t n = std::min(log_tcp_pos.size(), tcp_pos.size());
+
+  std::ofstream out;
+  if (!output.empty()) {
+    out.open(output);
+    out << "time_from_start,log_x,log_y,log_z,replay_x,replay_y,replay_z,measured_x,measured_y,measured_z,diff,tracking_lag\n";
+  }
+
+  double diff_sum = 0.0, diff_sq_sum = 0.0, diff_max = 0.0, lag_sum = 0.0;
+  for (size_t k=0; k<n; k++) {
+    double diff = 0.0, lag = 0.0;
+    for (size_t i=0; i<3; i++) {
+      diff += pow(tcp_pos.at(k).at(i) - log_tcp_pos.at(k).at(i), 2);
+      lag += pow(measured_pos.at(k).at(i) - tcp_pos.at(k).at(i), 2);
+    }
+    diff = sqrt(diff);
+    lag = sqrt(lag);
+
+    diff_sum += diff;
+    diff_sq_sum += diff * diff;
+    diff_max = std::max(diff_max, diff);
+    lag_sum += lag;
+
+    if (out.is_open()) {
+      out << log.times.at(k);
+      for (size_t i=0; i<3; i++) out << "," << log_tcp_pos.at(k).at(i);
+      for (size_t i=0; i<3; i++) out << "," << tcp_pos.at(k).at(i);
+      for (size_t i=0; i<3; i++) out << "," << measured_pos.at(k).at(i);
+      out << "," << diff << "," << lag << "\n";
+    }
+  }
+
+  std::cout << "\n======================= REPLAY FINISHED =======================\n" << std::endl;
+  std::cout << "Samples compared = " << n << " (log: " << log_tcp_pos.size() << ", replay: " << tcp_pos.size() << ")" << std::endl;
+  if (n > 0) {
+    std::cout << "TCP diff [m]: mean = " << diff_sum / n << ", rms = " << sqrt(diff_sq_sum / n) << ", max = " << diff_max << std::endl;
+    std::cout << "Plant tracking lag [m]: mean = " << lag_sum / n << std::endl;
+  }
+
+  // the real robot's lag, if the trial was recorded with the measured tcp (to tune plant_time_constant against)
+  const std::vector< std::vector<double> > & log_measured_pos = log.measured_pos;
+  if (!log_measured_pos.empty()) {
+    double log_lag_sum = 0.0;
+    for (size_t k=0; k<log_measured_pos.size(); k++) {
+      double lag = 0.0;
+      for (size_t i=0; i<3; i++) lag += pow(log_measured_pos.at(k).at(i) - log_tcp_pos.at(k).at(i), 2);
+      log_lag_sum += sqrt(lag);
+    }
+    std::cout << "Logged tracking lag [m]: mean = " << log_lag_sum / log_measured_pos.size() << std::endl;
+  }
+  std::cout << "Simulated " << sim_time << " s in " << wall_time << " s (x" << sim_time / wall_time << " real-time)\n" << std::endl;
+}
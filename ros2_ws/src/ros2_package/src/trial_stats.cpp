@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the controllers' per-trial
+//   bookkeeping (trial_stats.hpp)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/trial_stats.hpp"
+#include "ros2_package/async_logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+/////////////////////////////// safety layers of the core ///////////////////////////////
+void TrialStats::update(const TickOutput & out, const SharedControlCore & core)
+{
+  if (out.tcp_clamped && n_clamped++ % control_freq == 0) {
+    ASYNC_LOG_WARN("TCP target stopped short of an obstacle at [%.3f, %.3f, %.3f] (%d ticks this trial)",
+                   core.tcp_pos.at(0), core.tcp_pos.at(1), core.tcp_pos.at(2), n_clamped);
+  }
+
+  // one message per stretch of filtered commands
+  if (out.safety_intervened) {
+    n_filtered++;
+    max_filter_deviation = std::max(max_filter_deviation, out.safety_deviation);
+    if (!filtering) ASYNC_LOG_WARN("Safety filter: limiting the joint commands (%.4f rad off)", out.safety_deviation);
+  }
+  filtering = out.safety_intervened;
+
+  min_self_distance = std::min(min_self_distance, out.self_distance);
+  if (out.self_collision && n_self_collisions++ % control_freq == 0) {
+    ASYNC_LOG_WARN("IK solution %.1f mm from a self-collision (%s), keeping the last clear one (%d ticks this trial)",
+                   out.self_distance * 1e3, core.closest_links().c_str(), n_self_collisions);
+  }
+
+  // conditioning of the IK solution (only once there is one)
+  if (out.min_singular_value <= 0.0) return;
+  min_sigma = std::min(min_sigma, out.min_singular_value);
+  min_manipulability = std::min(min_manipulability, out.manipulability);
+  if (core.authority_scale < 1.0) {
+    if (n_scaled++ % control_freq == 0) {
+      ASYNC_LOG_WARN("Close to a singularity (sigma = %.4f), human authority at %.0f %%", out.min_singular_value, core.authority_scale * 100);
+    }
+  }
+  if (core.ik_time_us > slowest_ik_us) {
+    slowest_ik_us = core.ik_time_us;
+    slowest_ik_sigma = out.min_singular_value;
+  }
+}
+
+void TrialStats::report() const
+{
+  if (n_filtered > 0) ASYNC_LOG_INFO("Safety filter: %d commands limited, at most %.4f rad off", n_filtered, max_filter_deviation);
+  if (min_sigma < 1e9) {
+    ASYNC_LOG_INFO("IK conditioning: min sigma = %.4f, min manipulability = %.4f, %d ticks with reduced authority, "
+                   "slowest IK %.1f us at sigma = %.4f", min_sigma, min_manipulability, n_scaled, slowest_ik_us, slowest_ik_sigma);
+  }
+  if (min_self_distance < 1e9) {
+    ASYNC_LOG_INFO("Self-collision: closest approach = %.1f mm, %d IK solutions rejected", min_self_distance * 1e3, n_self_collisions);
+  }
+}
+
+void TrialStats::reset()
+{
+  n_clamped = 0;
+  n_filtered = 0;
+  max_filter_deviation = 0.0;
+  filtering = false;
+  min_self_distance = 1e9;
+  n_self_collisions = 0;
+  min_sigma = min_manipulability = 1e9;
+  n_scaled = 0;
+  slowest_ik_us = slowest_ik_sigma = 0.0;
+}
+
+
+/////////////////////////////// tracking errors ///////////////////////////////
+double position_error(const std::vector<double>& pos, const std::vector<double>& ref, int use_depth)
+{
+  double err = pow(pos.at(1) - ref.at(1), 2) + pow(pos.at(2) - ref.at(2), 2);
+  if (use_depth) err += pow(pos.at(0) - ref.at(0), 2);
+  return sqrt(err);
+}
+
+void TrialErrors::add(const std::vector<double>& human, const std::vector<double>& robot, const std::vector<double>& tcp,
+                      const std::vector<double>& ref, int use_depth)
+{
+  double overall_err = position_error(tcp, ref, use_depth);
+  n_samples++;
+  human_sum += position_error(human, ref, use_depth);
+  robot_sum += position_error(robot, ref, use_depth);
+  overall_sum += overall_err;
+  overall_max = std::max(overall_max, overall_err);
+}
+
+void TrialErrors::reset()
+{
+  n_samples = 0;
+  human_sum = robot_sum = overall_sum = overall_max = 0.0;
+}
+
+
+/////////////////////////////// conditions of a trial ///////////////////////////////
+bool valid_trial_conditions(int alpha_id, int traj_id, double mapping_ratio)
+{
+  return alpha_id >= 0 && alpha_id < (int) alphas_dict.size() && traj_id >= 0 && traj_id < n_traj_ids && mapping_ratio > 0.0;
+}
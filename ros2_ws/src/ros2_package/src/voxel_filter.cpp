@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Implementation of the VoxelFilter (transform, crop
+//   and voxel downsampling of the camera cloud)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include "ros2_package/voxel_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+
+static const int block = 16;   // points transformed together
+
+
+VoxelFilter::VoxelFilter(const double a_lower[3], const double a_upper[3], double a_voxel_size, int a_n_threads)
+: voxel_size(a_voxel_size)
+{
+  threads = (a_n_threads > 0) ? a_n_threads : std::max(1u, std::thread::hardware_concurrency());
+  inv_voxel = 1.0 / voxel_size;
+  for (int j=0; j<3; j++) {
+    lower[j] = a_lower[j];
+    dims[j] = std::max(1, (int) std::ceil((a_upper[j] - a_lower[j]) / voxel_size));
+  }
+
+  const double identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+  const double zero[3] = {0, 0, 0};
+  set_transform(identity, zero);
+
+  cell_sums.assign(4 * (std::size_t) dims[0] * dims[1] * dims[2], 0.0f);
+  buckets.resize(threads * threads);
+  touched.resize(threads);
+  outputs.resize(threads);
+}
+
+void VoxelFilter::set_transform(const double rotation[9], const double translation[3])
+{
+  for (int i=0; i<9; i++) R[i] = rotation[i];
+  for (int j=0; j<3; j++) T[j] = translation[j];
+}
+
+
+/////////////////////////////// the whole cloud ///////////////////////////////
+std::size_t VoxelFilter::filter(const uint8_t* data, std::size_t n_points, std::size_t point_step, std::size_t xyz_offset, std::vector<float>& out)
+{
+  // round 1: contiguous shares of the cloud
+  std::vector<std::thread> workers;
+  std::size_t share = (n_points + threads - 1) / threads;
+  for (int t=1; t<threads; t++) {
+    std::size_t begin = std::min(n_points, t * share);
+    std::size_t end = std::min(n_points, begin + share);
+    workers.emplace_back(&VoxelFilter::transform_and_crop, this, t, data, begin, end, point_step, xyz_offset);
+  }
+  transform_and_crop(0, data, 0, std::min(n_points, share), point_step, xyz_offset);
+  for (auto & worker : workers) worker.join();
+  workers.clear();
+
+  cropped = 0;
+  for (auto & bucket : buckets) cropped += bucket.size();
+
+  // round 2: every thread its own voxels
+  for (int t=1; t<threads; t++) workers.emplace_back(&VoxelFilter::average, this, t);
+  average(0);
+  for (auto & worker : workers) worker.join();
+
+  out.clear();
+  for (auto & output : outputs) out.insert(out.end(), output.begin(), output.end());
+  return out.size() / 3;
+}
+
+
+/////////////////////////////// round 1 ///////////////////////////////
+void VoxelFilter::transform_and_crop(int t, const uint8_t* data, std::size_t begin, std::size_t end, std::size_t point_step, std::size_t xyz_offset)
+{
+  for (int owner=0; owner<threads; owner++) buckets.at(t * threads + owner).clear();
+
+  float px[block], py[block], pz[block];
+  float qx[block], qy[block], qz[block];
+  int32_t key[block];
+
+  for (std::size_t first=begin; first<end; first+=block) {
+    const int n = std::min<std::size_t>(block, end - first);
+
+    // gather (the points are interleaved with the other fields)
+    for (int i=0; i<n; i++) {
+      float xyz[3];
+      std::memcpy(xyz, data + (first + i) * point_step + xyz_offset, sizeof(xyz));
+      px[i] = xyz[0];
+      py[i] = xyz[1];
+      pz[i] = xyz[2];
+    }
+    for (int i=n; i<block; i++) px[i] = py[i] = pz[i] = NAN;
+
+    // transform, crop and voxel index of the whole block (no branches, vectorizes)
+    for (int i=0; i<block; i++) {
+      qx[i] = R[0] * px[i] + R[1] * py[i] + R[2] * pz[i] + T[0];
+      qy[i] = R[3] * px[i] + R[4] * py[i] + R[5] * pz[i] + T[1];
+      qz[i] = R[6] * px[i] + R[7] * py[i] + R[8] * pz[i] + T[2];
+
+      float fx = (qx[i] - lower[0]) * inv_voxel;
+      float fy = (qy[i] - lower[1]) * inv_voxel;
+      float fz = (qz[i] - lower[2]) * inv_voxel;
+      bool inside = (fx >= 0.0f) & (fx < dims[0]) & (fy >= 0.0f) & (fy < dims[1]) & (fz >= 0.0f) & (fz < dims[2]);   // false for NaN
+      fx = inside ? fx : 0.0f;    // only cast what is in range
+      fy = inside ? fy : 0.0f;
+      fz = inside ? fz : 0.0f;
+      int32_t k = ((int32_t) fx * (int32_t) dims[1] + (int32_t) fy) * (int32_t) dims[2] + (int32_t) fz;
+      key[i] = inside ? k : -1;
+    }
+
+    // hand the kept ones to the owners of their voxels
+    for (int i=0; i<block; i++) {
+      if (key[i] < 0) continue;
+      buckets[t * threads + key[i] % threads].push_back({(uint32_t) key[i], qx[i], qy[i], qz[i]});
+    }
+  }
+}
+
+
+/////////////////////////////// round 2 ///////////////////////////////
+void VoxelFilter::average(int t)
+{
+  std::vector<uint32_t> & cells = touched.at(t);
+  cells.clear();
+
+  for (int source=0; source<threads; source++) {
+    for (const Entry & e : buckets.at(source * threads + t)) {
+      float* cell = &cell_sums[4 * (std::size_t) e.key];
+      if (cell[3] == 0.0f) cells.push_back(e.key);
+      cell[0] += e.x;
+      cell[1] += e.y;
+      cell[2] += e.z;
+      cell[3] += 1.0f;
+    }
+  }
+
+  std::vector<float> & output = outputs.at(t);
+  output.clear();
+  for (uint32_t c : cells) {
+    float* cell = &cell_sums[4 * (std::size_t) c];
+    output.push_back(cell[0] / cell[3]);
+    output.push_back(cell[1] / cell[3]);
+    output.push_back(cell[2] / cell[3]);
+    cell[0] = cell[1] = cell[2] = cell[3] = 0.0f;
+  }
+}
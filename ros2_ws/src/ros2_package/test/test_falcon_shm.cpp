@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Unit tests of the Falcon shared-memory channel:
+//   1. newest sample and history round trip
+//   2. a reader never sees a torn sample while the
+//      writer is busy in another thread
+//   3. a talker restarted after dying in the middle of
+//      a write keeps the seqlock working
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros2_package/falcon_shm.hpp"
+
+
+class FalconShmTest : public ::testing::Test
+{
+protected:
+
+  void SetUp() override {shm_unlink(name.c_str());}
+  void TearDown() override {shm_unlink(name.c_str());}
+
+  const std::string name = "/ros2_package_falcon_test_" + std::to_string(getpid());
+};
+
+
+TEST_F(FalconShmTest, RoundTrip)
+{
+  FalconShmWriter writer(name);
+  FalconShmReader reader(name);
+  ASSERT_TRUE(reader.open());
+
+  FalconShmSample sample;
+  EXPECT_FALSE(reader.read_newest(sample));   // nothing written yet
+
+  for (int k=1; k<=100; k++) writer.write(k, 0.1 * k, 0.2 * k, 0.3 * k);
+
+  ASSERT_TRUE(reader.read_newest(sample));
+  EXPECT_EQ(sample.index, 100u);
+  EXPECT_EQ(sample.stamp_ns, 100);
+  EXPECT_DOUBLE_EQ(sample.x, 10.0);
+  EXPECT_DOUBLE_EQ(sample.z, 30.0);
+
+  // the last falcon_shm_history samples, oldest first
+  std::vector<FalconShmSample> samples;
+  ASSERT_EQ(reader.read_history(falcon_shm_history + 10, samples), falcon_shm_history);
+  for (int k=0; k<falcon_shm_history; k++) EXPECT_EQ(samples.at(k).index, (uint64_t) (100 - falcon_shm_history + 1 + k));
+}
+
+
+TEST_F(FalconShmTest, NoTornReads)
+{
+  FalconShmWriter writer(name);
+  FalconShmReader reader(name);
+  ASSERT_TRUE(reader.open());
+
+  // every field of a sample is its index, so a torn one has fields that disagree
+  // (with a short pause between the writes, a writer flat out would only starve the reader, which gives up by design)
+  std::atomic<bool> done {false};
+  std::thread writing([&]() {
+    for (int k=1; k<=20000; k++) {
+      writer.write(k, k, k, k);
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    done = true;
+  });
+
+  long n_read = 0;
+  FalconShmSample sample;
+  while (!done) {
+    if (!reader.read_newest(sample)) continue;
+    n_read++;
+    bool consistent = sample.stamp_ns == (int64_t) sample.index && sample.x == (double) sample.index &&
+                      sample.y == (double) sample.index && sample.z == (double) sample.index;
+    EXPECT_TRUE(consistent) << "torn sample " << sample.index;
+    if (!consistent) break;
+  }
+  writing.join();
+  EXPECT_GT(n_read, 0);
+}
+
+
+TEST_F(FalconShmTest, RestartAfterInterruptedWrite)
+{
+  {
+    FalconShmWriter writer(name);
+    writer.write(1, 1.0, 2.0, 3.0);
+  }
+
+  // a talker that died between the two sequence stores leaves the slots odd
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  void* addr = mmap(nullptr, sizeof(FalconShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(addr, MAP_FAILED);
+  FalconShmSegment* segment = static_cast<FalconShmSegment*>(addr);
+  segment->newest.seq.fetch_add(1);
+  segment->history[1].seq.fetch_add(1);
+
+  FalconShmWriter writer(name);
+  FalconShmReader reader(name);
+  ASSERT_TRUE(reader.open());
+
+  FalconShmSample sample;
+  EXPECT_FALSE(reader.read_newest(sample));   // the interrupted sample is gone, not half read
+
+  writer.write(2, 4.0, 5.0, 6.0);
+  ASSERT_TRUE(reader.read_newest(sample));
+  EXPECT_EQ(sample.index, 2u);
+  EXPECT_DOUBLE_EQ(sample.x, 4.0);
+  EXPECT_EQ(segment->newest.seq.load() % 2, 0u);
+
+  std::vector<FalconShmSample> samples;
+  EXPECT_EQ(reader.read_history(2, samples), 2);
+  munmap(addr, sizeof(FalconShmSegment));
+}
@@ -0,0 +1,57 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Unit tests of the InputMonitor staleness:
+//   1. no talker at all: only stale while the stream
+//      is required
+//   2. a talker that goes silent for longer than the
+//      timeout is stale, required or not
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "ros2_package/input_monitor.hpp"
+
+
+TEST(InputMonitor, NoTalker)
+{
+  InputMonitor monitor("falcon_position", {1, false, 20, 500, 20});
+  EXPECT_TRUE(monitor.stale());
+  EXPECT_EQ(monitor.age_ms(), -1.0);
+
+  // e.g. Gazebo without a PositionTalker, or a trial without human authority
+  monitor.required = false;
+  EXPECT_FALSE(monitor.stale());
+}
+
+
+TEST(InputMonitor, SilentTalker)
+{
+  InputMonitor monitor("falcon_position", {1, false, 20, 500, 20});
+  monitor.required = false;
+  monitor.received();
+  EXPECT_FALSE(monitor.stale());
+  EXPECT_GE(monitor.age_ms(), 0.0);
+
+  // once a talker has been there, it going silent holds the robot
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  EXPECT_TRUE(monitor.stale());
+
+  monitor.received();
+  EXPECT_FALSE(monitor.stale());
+}
+
+
+TEST(InputMonitor, NoTimeout)
+{
+  InputMonitor monitor("joint_states", {1, false, 0, 0, 0});
+  monitor.received();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_FALSE(monitor.stale());
+}
@@ -0,0 +1,140 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Unit tests of the JointSafetyFilter:
+//   1. a command the FR3 can follow comes out unchanged
+//   2. a step is caught up with inside the velocity,
+//      acceleration and jerk limits, without overshoot
+//   3. a command past a joint limit is braked for before
+//      the soft limit, also when running into it at speed
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "ros2_package/jerk_limited_profile.hpp"
+#include "ros2_package/joint_safety_filter.hpp"
+#include "ros2_package/shared_control.hpp"
+
+
+static const double dt = 0.002;   // 500 Hz, as in the controllers
+static const double eps = 1e-9;
+
+// filtered commands, and the velocity / acceleration / jerk between them
+struct FilterTrace
+{
+  std::vector< std::vector<double> > q;
+
+  double max_abs(unsigned int order, unsigned int joint) const
+  {
+    double m = 0.0;
+    for (size_t k=order; k<q.size(); k++) {
+      double d = q.at(k).at(joint);
+      if (order >= 1) d = (q.at(k).at(joint) - q.at(k-1).at(joint)) / dt;
+      if (order >= 2) d = (d - (q.at(k-1).at(joint) - q.at(k-2).at(joint)) / dt) / dt;
+      if (order >= 3) {
+        double a_prev = ((q.at(k-1).at(joint) - q.at(k-2).at(joint)) - (q.at(k-2).at(joint) - q.at(k-3).at(joint))) / (dt * dt);
+        d = (d - a_prev) / dt;
+      }
+      m = std::max(m, std::abs(d));
+    }
+    return m;
+  }
+};
+
+
+TEST(JointSafetyFilter, FeasibleCommandPassesUnchanged)
+{
+  JointSafetyFilter filter(lower_joint_limits, upper_joint_limits, dt);
+
+  // a slow cosine away from home on every joint, starting from rest
+  for (int k=0; k<2000; k++) {
+    std::vector<double> q = home_joint_vals;
+    for (unsigned int i=0; i<n_joints; i++) q.at(i) += 0.2 * (1 - std::cos(M_PI * k * dt));
+    std::vector<double> command = q;
+
+    double deviation = filter.apply(q);
+    EXPECT_LT(deviation, 1e-12) << "tick " << k;
+    for (unsigned int i=0; i<n_joints; i++) EXPECT_NEAR(q.at(i), command.at(i), 1e-12);
+  }
+}
+
+
+TEST(JointSafetyFilter, StepStaysWithinLimits)
+{
+  JointSafetyFilter filter(lower_joint_limits, upper_joint_limits, dt);
+  FilterTrace trace;
+
+  std::vector<double> q = home_joint_vals;
+  filter.apply(q);
+  trace.q.push_back(q);
+
+  // jump every joint by 0.5 rad (away from its nearer limit) and hold the command there for 3 seconds
+  std::vector<double> target = home_joint_vals;
+  for (unsigned int i=0; i<n_joints; i++) {
+    double mid = 0.5 * (lower_joint_limits.at(i) + upper_joint_limits.at(i));
+    target.at(i) += (home_joint_vals.at(i) < mid) ? 0.5 : -0.5;
+  }
+  for (int k=0; k<1500; k++) {
+    q = target;
+    filter.apply(q);
+    trace.q.push_back(q);
+  }
+
+  for (unsigned int i=0; i<n_joints; i++) {
+    EXPECT_LE(trace.max_abs(1, i), filter.limit_scale * fr3_velocity_limits.at(i) + eps) << "joint " << i;
+    EXPECT_LE(trace.max_abs(2, i), filter.limit_scale * fr3_acceleration_limits.at(i) + 1e-6) << "joint " << i;
+    EXPECT_LE(trace.max_abs(3, i), filter.limit_scale * fr3_jerk_limits.at(i) + 1e-3) << "joint " << i;
+
+    // it gets there, and does not go past it on the way
+    EXPECT_NEAR(trace.q.back().at(i), target.at(i), 1e-6) << "joint " << i;
+    for (const std::vector<double> & qk : trace.q) {
+      double travelled = (qk.at(i) - home_joint_vals.at(i)) / (target.at(i) - home_joint_vals.at(i));
+      EXPECT_LE(travelled, 1.0 + 1e-9) << "joint " << i;
+    }
+  }
+}
+
+
+TEST(JointSafetyFilter, BrakesBeforeTheSoftLimits)
+{
+  JointSafetyFilter filter(lower_joint_limits, upper_joint_limits, dt);
+
+  // a command running through the upper limit of every joint at half its velocity limit, and on past it
+  std::vector<double> q = home_joint_vals;
+  filter.apply(q);
+  std::vector<double> command = home_joint_vals;
+  for (int k=0; k<5000; k++) {
+    for (unsigned int i=0; i<n_joints; i++) command.at(i) += 0.5 * filter.limit_scale * fr3_velocity_limits.at(i) * dt;
+    q = command;
+    filter.apply(q);
+    for (unsigned int i=0; i<n_joints; i++) {
+      ASSERT_LE(q.at(i), upper_joint_limits.at(i) - filter.position_margin + 1e-6) << "joint " << i << ", tick " << k;
+    }
+  }
+
+  // it ends up at rest at the soft limit
+  for (unsigned int i=0; i<n_joints; i++) EXPECT_NEAR(q.at(i), upper_joint_limits.at(i) - filter.position_margin, 1e-3) << "joint " << i;
+}
+
+
+TEST(JointSafetyFilter, ResetStartsFromRest)
+{
+  JointSafetyFilter filter(lower_joint_limits, upper_joint_limits, dt);
+
+  std::vector<double> q = home_joint_vals;
+  filter.apply(q);
+
+  // anything is taken as it is right after a reset
+  filter.reset();
+  std::vector<double> far = lower_joint_limits;
+  for (unsigned int i=0; i<n_joints; i++) far.at(i) += 0.1;
+  q = far;
+  EXPECT_EQ(filter.apply(q), 0.0);
+  EXPECT_EQ(q, far);
+}
@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Unit tests of the SelfCollision capsule check:
+//   1. the Panda chain gets all its capsule pairs, and
+//      home is free of self-collision
+//   2. capsule distances against hand-computed ones, for
+//      parallel, crossing and end-to-end segments
+//      (two links of a made-up chain, placed by hand)
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/jntarray.hpp>
+
+#include "ros2_package/self_collision.hpp"
+#include "ros2_package/shared_control.hpp"
+
+
+TEST(SelfCollision, PandaAtHome)
+{
+  KDL::Tree tree;
+  ASSERT_TRUE(create_tree(PANDA_URDF, tree));
+  KDL::Chain chain;
+  get_chain(tree, chain);
+
+  SelfCollision check(chain);
+  EXPECT_EQ(check.n_pairs(), 32);
+
+  KDL::ChainFkSolverPos_recursive fk_solver(chain);
+  KDL::JntArray q(n_joints);
+  for (unsigned int i=0; i<n_joints; i++) q(i) = home_joint_vals.at(i);
+  std::vector<KDL::Frame> frames(chain.getNrOfSegments());
+  ASSERT_GE(fk_solver.JntToCart(q, frames), 0);
+  EXPECT_GT(check.min_distance(frames), 0.0) << check.closest_pair();
+}
+
+
+// panda_link1 and panda_link4 only (the root link0 is always there), link1 left in the base frame:
+// link1 is the segment z = [-0.333, -0.05] on the z axis, link4 is z = [-0.06, 0.06] in its frame, both 0.06 thick
+class SelfCollisionPairTest : public ::testing::Test
+{
+protected:
+
+  void SetUp() override
+  {
+    chain.addSegment(KDL::Segment("panda_link1", KDL::Joint("fixed", KDL::Joint::None)));
+    chain.addSegment(KDL::Segment("panda_link4", KDL::Joint("fixed", KDL::Joint::None)));
+  }
+
+  double distance(const KDL::Frame & link4)
+  {
+    SelfCollision check(chain);
+    std::vector<KDL::Frame> frames {KDL::Frame::Identity(), link4};
+    double d = check.min_distance(frames);
+    pair = check.closest_pair();
+    return d;
+  }
+
+  KDL::Chain chain;
+  std::string pair;
+};
+
+
+TEST_F(SelfCollisionPairTest, OnlyFarEnoughLinksArePaired)
+{
+  // link1 - link4 and link0 - link4, link0 - link1 are too close along the arm
+  SelfCollision check(chain);
+  EXPECT_EQ(check.n_pairs(), 2);
+}
+
+
+TEST_F(SelfCollisionPairTest, ParallelSegments)
+{
+  // link4 upright 0.5 m beside link1, overlapping it in z
+  double d = distance(KDL::Frame(KDL::Vector(0.5, 0.0, -0.2)));
+  EXPECT_NEAR(d, 0.5 - 0.12, 1e-9);
+  EXPECT_EQ(pair, "panda_link1 - panda_link4");
+}
+
+
+TEST_F(SelfCollisionPairTest, CrossingSegmentsOverlap)
+{
+  // link4 lying along x, through the z axis
+  double d = distance(KDL::Frame(KDL::Rotation::RotY(M_PI / 2), KDL::Vector(0.03, 0.0, -0.2)));
+  EXPECT_NEAR(d, -0.12, 1e-9);
+  EXPECT_EQ(pair, "panda_link1 - panda_link4");
+}
+
+
+TEST_F(SelfCollisionPairTest, ClosestAtTheEnds)
+{
+  // link4 lying along x, above and beside the top of link1: end point to end point
+  double d = distance(KDL::Frame(KDL::Rotation::RotY(M_PI / 2), KDL::Vector(0.3, 0.0, 0.1)));
+  EXPECT_NEAR(d, std::sqrt(0.24 * 0.24 + 0.15 * 0.15) - 0.12, 1e-9);
+  EXPECT_EQ(pair, "panda_link1 - panda_link4");
+}
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+// FILE SUMMARY:
+//
+// - Unit tests of TcpKinematics against KDL, on the Panda
+//   chain parsed from the package's URDF (as the nodes do,
+//   but without writing a chain cache next to it):
+//   1. position and orientation vs ChainFkSolverPos_recursive
+//   2. TCP velocity vs the KDL Jacobian times the joint velocities
+//
+//////////////////////////////////////////////////////
+//////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+
+#include "ros2_package/shared_control.hpp"
+#include "ros2_package/tcp_kinematics.hpp"
+
+
+class TcpKinematicsTest : public ::testing::Test
+{
+protected:
+
+  void SetUp() override
+  {
+    KDL::Tree tree;
+    ASSERT_TRUE(create_tree(PANDA_URDF, tree));
+    get_chain(tree, chain);
+    ASSERT_EQ(chain.getNrOfJoints(), n_joints);
+  }
+
+  // random joint positions inside the limits
+  void random_joints(std::mt19937 & gen, double q[n_joints])
+  {
+    for (unsigned int i=0; i<n_joints; i++) {
+      std::uniform_real_distribution<double> dist(lower_joint_limits.at(i), upper_joint_limits.at(i));
+      q[i] = dist(gen);
+    }
+  }
+
+  KDL::Chain chain;
+};
+
+
+TEST_F(TcpKinematicsTest, FoldsThePandaChain)
+{
+  TcpKinematics kinematics(chain);
+  ASSERT_TRUE(kinematics.ok());
+  ASSERT_EQ(kinematics.n_joints(), (int) n_joints);
+  for (unsigned int i=0; i<n_joints; i++) EXPECT_EQ(kinematics.joint_names().at(i), "panda_joint" + std::to_string(i+1));
+}
+
+
+TEST_F(TcpKinematicsTest, PoseMatchesKdl)
+{
+  TcpKinematics kinematics(chain);
+  KDL::ChainFkSolverPos_recursive fk_solver(chain);
+  KDL::JntArray q_kdl(n_joints);
+  KDL::Frame frame;
+  std::mt19937 gen(1);
+
+  double q[n_joints];
+  for (int k=0; k<1000; k++) {
+    random_joints(gen, q);
+    for (unsigned int i=0; i<n_joints; i++) q_kdl(i) = q[i];
+    ASSERT_GE(fk_solver.JntToCart(q_kdl, frame), 0);
+    kinematics.compute(q, nullptr);
+
+    for (int j=0; j<3; j++) EXPECT_NEAR(kinematics.position[j], frame.p(j), 1e-12);
+
+    // the same rotation up to the sign of the quaternion
+    double x, y, z, w;
+    frame.M.GetQuaternion(x, y, z, w);
+    const double* o = kinematics.orientation;
+    EXPECT_NEAR(std::abs(o[0] * x + o[1] * y + o[2] * z + o[3] * w), 1.0, 1e-12);
+
+    // no velocity given = at rest
+    for (int j=0; j<3; j++) {
+      EXPECT_EQ(kinematics.velocity[j], 0.0);
+      EXPECT_EQ(kinematics.angular_velocity[j], 0.0);
+    }
+  }
+}
+
+
+TEST_F(TcpKinematicsTest, VelocityMatchesKdlJacobian)
+{
+  TcpKinematics kinematics(chain);
+  KDL::ChainJntToJacSolver jac_solver(chain);
+  KDL::JntArray q_kdl(n_joints);
+  KDL::Jacobian jacobian(n_joints);
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<double> speed(-2.0, 2.0);
+
+  double q[n_joints], qdot[n_joints];
+  for (int k=0; k<1000; k++) {
+    random_joints(gen, q);
+    for (unsigned int i=0; i<n_joints; i++) {
+      qdot[i] = speed(gen);
+      q_kdl(i) = q[i];
+    }
+    ASSERT_GE(jac_solver.JntToJac(q_kdl, jacobian), 0);
+    kinematics.compute(q, qdot);
+
+    // the KDL Jacobian is the tcp's twist per joint velocity, in the base frame
+    for (int j=0; j<3; j++) {
+      double v = 0.0, w = 0.0;
+      for (unsigned int i=0; i<n_joints; i++) {
+        v += jacobian(j, i) * qdot[i];
+        w += jacobian(j + 3, i) * qdot[i];
+      }
+      EXPECT_NEAR(kinematics.velocity[j], v, 1e-12);
+      EXPECT_NEAR(kinematics.angular_velocity[j], w, 1e-12);
+    }
+  }
+}